@@ -0,0 +1,619 @@
+// Microbenchmarks for the core library on synthetic calendars.
+//
+//   core_bench [--sizes 1000,10000,100000] [--distribution workday]
+//              [--seed 42] [--filter json.] [--format json|csv]
+//              [--min-time-ms 200]
+//
+// One result per line: JSON lines by default, or CSV with a header row.
+// Each benchmark runs an untimed prepare step before every iteration and
+// repeats until both the minimum time and three iterations are reached;
+// the reported time is the median iteration.
+
+#include "core/synthetic.h"
+#include "core/calendar.h"
+#include "core/chrono_index.h"
+#include "core/event.h"
+#include "core/ical.h"
+#include "core/memory_tracker.h"
+#include "core/profiler.h"
+#include "core/reminder_scheduler.h"
+#include "core/storage.h"
+#include "core/sync_server.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace calendar;
+
+namespace {
+
+struct Options {
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    Distribution distribution = DIST_WORKDAY;
+    uint64_t seed = 42;
+    const char* filter = "";
+    bool csv = false;
+    double minTimeMs = 200.0;
+};
+
+struct Result {
+    const char* name;
+    size_t size;
+    size_t ops;
+    int iterations;
+    double medianMs;
+    double allocsPerIter;
+};
+
+Options g_options;
+
+// Keeps results observable so the optimiser cannot drop the work
+volatile uint64_t g_sink;
+
+void printHeader() {
+    if (g_options.csv) printf("name,size,distribution,ops,iterations,median_ms,ns_per_op,allocs_per_iter,bytes_per_event\n");
+}
+
+void printResult(const Result& r) {
+    double nsPerOp = r.ops > 0 ? r.medianMs * 1e6 / (double)r.ops : 0.0;
+    if (g_options.csv) {
+        printf("%s,%zu,%s,%zu,%d,%.4f,%.2f,%.1f,\n", r.name, r.size,
+               distributionName(g_options.distribution), r.ops, r.iterations,
+               r.medianMs, nsPerOp, r.allocsPerIter);
+    } else {
+        printf("{\"name\":\"%s\",\"size\":%zu,\"distribution\":\"%s\",\"ops\":%zu,\"iterations\":%d,"
+               "\"medianMs\":%.4f,\"nsPerOp\":%.2f,\"allocsPerIter\":%.1f}\n",
+               r.name, r.size, distributionName(g_options.distribution), r.ops, r.iterations,
+               r.medianMs, nsPerOp, r.allocsPerIter);
+    }
+    fflush(stdout);
+}
+
+bool selected(const char* name) {
+    return strstr(name, g_options.filter) != nullptr;
+}
+
+// Runs body until the time budget is spent; ops is how many operations one
+// call of body performs, for the ns/op column. Returns the median in ms, 0
+// if the filter skipped it.
+double run(const char* name, size_t size, size_t ops,
+           const std::function<void()>& prepare, const std::function<void()>& body) {
+    if (!selected(name)) return 0.0;
+
+    prepare();
+    body();     // warm-up
+
+    std::vector<double> samples;
+    uint64_t allocs = 0;
+    double totalMs = 0.0;
+    while (samples.size() < 3 || totalMs < g_options.minTimeMs) {
+        prepare();
+        uint64_t startAllocs = MemoryTracker::totalAllocations();
+        double start = Profiler::nowMs();
+        body();
+        double elapsed = Profiler::nowMs() - start;
+        allocs += MemoryTracker::totalAllocations() - startAllocs;
+        samples.push_back(elapsed);
+        totalMs += elapsed;
+    }
+
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    Result result;
+    result.name = name;
+    result.size = size;
+    result.ops = ops;
+    result.iterations = (int)samples.size();
+    result.medianMs = samples[samples.size() / 2];
+    result.allocsPerIter = (double)allocs / (double)samples.size();
+    printResult(result);
+    return result.medianMs;
+}
+
+void noPrepare() {}
+
+void benchDates() {
+    const size_t kOps = 100000;
+    const int base = CalendarLogic::toDayNumber(1, 0, 2024);
+
+    run("date.toDayNumber", 0, kOps, noPrepare, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kOps; i++) {
+            sum += CalendarLogic::toDayNumber(1 + (int)(i % 28), (int)(i % 12), 1990 + (int)(i % 60));
+        }
+        g_sink = sum;
+    });
+    run("date.fromDayNumber", 0, kOps, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kOps; i++) {
+            CalendarLogic::fromDayNumber(base + (int)(i % 20000), day, month, year);
+            sum += day + month + year;
+        }
+        g_sink = sum;
+    });
+    run("date.dayOfWeek", 0, kOps, noPrepare, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kOps; i++) {
+            sum += CalendarLogic::getDayOfWeek(1 + (int)(i % 28), (int)(i % 12), 1990 + (int)(i % 60));
+        }
+        g_sink = sum;
+    });
+}
+
+void benchEvents(size_t size, const std::vector<Event>& dataset) {
+    const size_t kMutations = 1000;
+    EventManager manager;
+    std::vector<Event> batch;
+
+    run("events.addBatch", size, size,
+        [&]() { manager.clear(); batch = dataset; },
+        [&]() { manager.addEvents(batch); });
+
+    // Single-event mutations against a fully loaded manager
+    run("events.addSingle", size, kMutations,
+        [&]() { manager.clear(); batch = dataset; manager.addEvents(batch); },
+        [&]() {
+            for (size_t i = 0; i < kMutations; i++) manager.addEvent(dataset[(i * 7919) % dataset.size()]);
+        });
+    run("events.remove", size, kMutations,
+        [&]() { manager.clear(); batch = dataset; manager.addEvents(batch); },
+        [&]() {
+            for (size_t i = 0; i < kMutations && manager.getEventCount() > 0; i++) {
+                manager.removeEvent(manager.getChronological((i * 7919) % manager.getEventCount()));
+            }
+        });
+
+    manager.clear();
+    batch = dataset;
+    manager.addEvents(batch);
+    SyntheticRng rng(g_options.seed);
+    run("events.update", size, kMutations, noPrepare, [&]() {
+        for (size_t i = 0; i < kMutations; i++) {
+            Event* event = manager.getChronological((size_t)rng.range(0, (int)manager.getEventCount() - 1));
+            Event updated = *event;
+            if (!updated.isAllDay) {
+                updated.hourStart = rng.range(0, 22);
+                updated.hourEnd = updated.hourStart + 1;
+            }
+            manager.updateEvent(event, updated);
+        }
+    });
+}
+
+// An edit and the reads of the frame after it, at three calendar sizes:
+// an event dragged to another day, that day drawn again and the agenda
+// row it lands on looked up. The index work of an edit depends on the
+// dates involved rather than on the number of events, so the cost should
+// grow far less than the 100x between the smallest and largest calendar,
+// which is about what shifting every row would cost. Returns false if it
+// grows more than kMaxGrowth.
+bool benchEditScaling() {
+    const size_t kSizes[] = {1000, 10000, 100000};
+    const size_t kEdits = 1000;
+    const double kMaxGrowth = 10.0;
+    double nsPerEdit[3] = {};
+    for (int s = 0; s < 3; s++) {
+        if (!selected("scaling.editAndRead")) return true;
+        DatasetOptions options;
+        options.count = kSizes[s];
+        options.distribution = g_options.distribution;
+        options.seed = g_options.seed;
+        std::vector<Event> batch;
+        generateEvents(options, batch);
+        EventManager manager;
+        manager.addEvents(batch);
+
+        std::vector<uint64_t> uids;
+        SyntheticRng rng(g_options.seed + 2);
+        for (size_t i = 0; i < kEdits; i++) {
+            uids.push_back(manager.getAllEvents()[(size_t)rng.range(0, (int)kSizes[s] - 1)].uid);
+        }
+        // Back and forth on alternate runs, so the calendar keeps its shape
+        int shift = 3;
+        double ms = run("scaling.editAndRead", kSizes[s], kEdits, noPrepare, [&]() {
+            shift = -shift;
+            uint64_t sum = 0;
+            for (uint64_t uid : uids) {
+                Event* event = manager.findByUid(uid);
+                Event moved = *event;
+                CalendarLogic::fromDayNumber(CalendarLogic::toDayNumber(event->day, event->month, event->year) + shift,
+                                             moved.day, moved.month, moved.year);
+                manager.updateEvent(event, moved);
+                for (Event* shown : manager.getEventsForDate(moved.day, moved.month, moved.year)) {
+                    sum += shown->hourStart;
+                }
+                size_t row = manager.findFirstRowOnOrAfter(moved.day, moved.month, moved.year);
+                sum += manager.getChronological(row)->minuteStart;
+            }
+            g_sink = sum;
+        });
+        nsPerEdit[s] = ms * 1e6 / (double)kEdits;
+    }
+
+    double growth = nsPerEdit[2] / nsPerEdit[0];
+    if (g_options.csv) {
+        printf("scaling.edit,%zu,%s,,,,%.2f,,\n", kSizes[2], distributionName(g_options.distribution), growth);
+    } else {
+        printf("{\"name\":\"scaling.edit\",\"size\":%zu,\"distribution\":\"%s\",\"growth\":%.2f,"
+               "\"maxGrowth\":%.1f}\n",
+               kSizes[2], distributionName(g_options.distribution), growth, kMaxGrowth);
+    }
+    fflush(stdout);
+    return growth <= kMaxGrowth;
+}
+
+void benchQueries(size_t size, const std::vector<Event>& dataset) {
+    const size_t kQueries = 10000;
+    EventManager manager;
+    std::vector<Event> batch = dataset;
+    manager.addEvents(batch);
+
+    // Query dates are drawn from the dataset so they hit populated days
+    std::vector<int> dates;
+    SyntheticRng rng(g_options.seed + 1);
+    for (size_t i = 0; i < kQueries; i++) {
+        const Event& event = dataset[(size_t)rng.range(0, (int)dataset.size() - 1)];
+        dates.push_back(CalendarLogic::toDayNumber(event.day, event.month, event.year));
+    }
+
+    // Reads every event, as a caller drawing the day would
+    run("query.forDate", size, kQueries, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            for (Event* event : manager.getEventsForDate(day, month, year)) sum += event->hourStart;
+        }
+        g_sink = sum;
+    });
+    // The same with a filter passing one tag of the synthetic six
+    manager.setTagFilter(1);
+    run("query.forDate.filtered", size, kQueries, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            for (Event* event : manager.getEventsForDate(day, month, year)) sum += event->hourStart;
+        }
+        g_sink = sum;
+    });
+    run("query.tagsForDate", size, kQueries, noPrepare, [&]() {
+        uint64_t bits = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            bits ^= manager.getTagsForDate(day, month, year);
+        }
+        g_sink = bits;
+    });
+    // Toggling a filter chip: the agenda's row list is rebuilt on next use
+    uint64_t mask = 1;
+    run("filter.rebuild", size, size, noPrepare, [&]() {
+        mask = mask == 1 ? 3 : 1;
+        manager.setTagFilter(mask);
+        g_sink = manager.getFilteredCount();
+    });
+    manager.setTagFilter(0);
+    run("query.dayCount", size, kQueries, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            sum += manager.getDayIndex().countForDate(day, month, year);
+        }
+        g_sink = sum;
+    });
+    run("query.timedRows", size, kQueries, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            EventManager::RowRange rows = manager.getTimedRows(day, month, year, 9 * 60, 17 * 60);
+            sum += rows.last - rows.first;
+        }
+        g_sink = sum;
+    });
+    run("query.firstOnOrAfter", size, kQueries, noPrepare, [&]() {
+        uint64_t sum = 0;
+        int day, month, year;
+        for (size_t i = 0; i < kQueries; i++) {
+            CalendarLogic::fromDayNumber(dates[i], day, month, year);
+            sum += manager.findFirstRowOnOrAfter(day, month, year);
+        }
+        g_sink = sum;
+    });
+}
+
+void benchSorting(size_t size, const std::vector<Event>& dataset) {
+    ChronoIndex index;
+    run("index.build", size, size,
+        [&]() { index.clear(); },
+        [&]() { index.insertBatch(dataset.data(), 0, dataset.size()); });
+
+    // Baseline: what a full re-sort of event pointers would cost instead
+    std::vector<const Event*> pointers;
+    run("sort.byTime", size, size,
+        [&]() {
+            pointers.clear();
+            for (const Event& event : dataset) pointers.push_back(&event);
+        },
+        [&]() {
+            std::sort(pointers.begin(), pointers.end(), [](const Event* a, const Event* b) {
+                return ChronoIndex::sortKey(*a) < ChronoIndex::sortKey(*b);
+            });
+        });
+}
+
+void benchJson(size_t size, const std::vector<Event>& dataset) {
+    std::string json;
+    run("json.serialize", size, size, noPrepare, [&]() {
+        json = StorageManager::serializeToJSON(dataset);
+    });
+
+    std::vector<Event> parsed;
+    const std::string v5 = StorageManager::serializeToJSON(dataset);
+    const std::string v4 = writeLegacyV4(dataset);
+    const std::string v3 = writeLegacyV3(dataset);
+    const std::string v2 = writeLegacyV2(dataset);
+    const std::string v1 = writeLegacyV1(dataset);
+    const std::string v0 = writeLegacyV0(dataset);
+    run("json.parse.v5", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v5, parsed); });
+    run("json.parse.v4", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v4, parsed); });
+    run("json.parse.v3", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v3, parsed); });
+    run("json.parse.v2", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v2, parsed); });
+    run("json.parse.v1", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v1, parsed); });
+    run("json.parse.v0", size, size, noPrepare, [&]() { StorageManager::parseFromJSON(v0, parsed); });
+}
+
+// Every event as an upsert, the way a first push or a full pull carries them
+void buildDeltas(const EventManager& events, std::vector<EventDelta>& deltas) {
+    deltas.resize(events.getEventCount());
+    for (size_t i = 0; i < deltas.size(); i++) {
+        deltas[i].kind = EventDelta::UPSERT;
+        deltas[i].event = events.getAllEvents()[i];
+        deltas[i].uid = deltas[i].event.uid;
+        deltas[i].stamp = deltas[i].event.stamp;
+    }
+}
+
+void benchSync(size_t size, const std::vector<Event>& dataset) {
+    EventManager events;
+    std::vector<Event> batch = dataset;
+    events.addEvents(batch);
+    SyncMessage upload;
+    buildDeltas(events, upload.deltas);
+
+    std::string wire;
+    run("sync.encode", size, size, noPrepare, [&]() { encodeSyncMessage(upload, wire); });
+    SyncMessage decoded;
+    run("sync.decode", size, size, noPrepare, [&]() { decodeSyncMessage(wire, decoded); });
+
+    // A server holding the whole calendar and a client that is caught up:
+    // one edit costs the same exchange whatever the calendar size
+    SyncServer server;
+    std::string response;
+    server.handle(wire, response);
+    SyncMessage push;
+    push.cursor = server.head();
+    push.deltas.resize(1);
+    SyncMessage answer;
+    DeltaMerger merger;
+    std::string request;
+    run("sync.exchange.oneEdit", size, 1, noPrepare, [&]() {
+        EventDelta& delta = push.deltas[0];
+        delta = upload.deltas[(size_t)g_sink % upload.deltas.size()];
+        delta.event.text += '.';
+        delta.stamp = delta.event.stamp = events.nextStamp();
+        encodeSyncMessage(push, request);
+        server.handle(request, response);
+        decodeSyncMessage(response, answer);
+        push.cursor = answer.cursor;
+        merger.apply(events, delta, CHANGE_LOCAL);
+        g_sink += response.size();
+    });
+
+    // A fresh device pulling the server's calendar, page by page
+    run("sync.pull.full", size, size,
+        [&]() { events.clear(); },
+        [&]() {
+            SyncMessage pull;
+            do {
+                encodeSyncMessage(pull, request);
+                server.handle(request, response);
+                decodeSyncMessage(response, answer);
+                merger.applyAll(events, answer.deltas, CHANGE_SERVER);
+                pull.cursor = answer.cursor;
+            } while (answer.more);
+        });
+}
+
+void benchUsage(size_t size, const std::vector<Event>& dataset) {
+    const size_t kQueries = 1000;
+    EventManager manager;
+    std::vector<Event> batch = dataset;
+    manager.addEvents(batch);
+    const UsageIndex& usage = manager.getUsageIndex();
+
+    // Ranges of one year and of the whole calendar, from random start days
+    int firstDay = INT_MAX, lastDay = INT_MIN;
+    for (const Event& event : dataset) {
+        int dayNumber = CalendarLogic::toDayNumber(event.day, event.month, event.year);
+        firstDay = std::min(firstDay, dayNumber);
+        lastDay = std::max(lastDay, dayNumber);
+    }
+    std::vector<int> starts;
+    SyntheticRng rng(g_options.seed + 2);
+    for (size_t i = 0; i < kQueries; i++) starts.push_back(rng.range(firstDay, lastDay));
+
+    UsageIndex::Totals totals;
+    run("usage.totals.year", size, kQueries, noPrepare, [&]() {
+        for (int start : starts) {
+            usage.totals(start, start + 365, totals);
+            g_sink += totals.bookedMinutes;
+        }
+    });
+    run("usage.totals.all", size, kQueries, noPrepare, [&]() {
+        for (size_t i = 0; i < kQueries; i++) {
+            usage.totals(firstDay, lastDay, totals);
+            g_sink += totals.bookedMinutes;
+        }
+    });
+    UsageIndex::DayValue busiest[5];
+    run("usage.busiest.year", size, kQueries, noPrepare, [&]() {
+        for (int start : starts) g_sink += usage.busiestDays(start, start + 365, busiest, 5);
+    });
+    run("usage.freeBlock.year", size, kQueries, noPrepare, [&]() {
+        for (int start : starts) g_sink += usage.longestFreeBlock(start, start + 365).minutes;
+    });
+}
+
+void benchReminders(size_t size, const std::vector<Event>& dataset) {
+    EventManager events;
+    std::vector<Event> batch = dataset;
+    events.addEvents(batch);
+    // Halfway through the calendar, so about half the reminders are ahead
+    const Event& middle = dataset[dataset.size() / 2];
+    int64_t nowMs = (int64_t)CalendarLogic::toDayNumber(middle.day, middle.month, middle.year) * 86400000;
+    ReminderScheduler scheduler(events);
+    run("reminders.rebuild", size, size, noPrepare, [&]() { scheduler.start(nowMs); });
+
+    // Nothing due: each poll only looks at the top of the heap
+    std::vector<Reminder> due;
+    int64_t idleMs = scheduler.nextDueMs() - 1;
+    run("reminders.poll.idle", size, 1000, noPrepare, [&]() {
+        for (int i = 0; i < 1000; i++) g_sink += scheduler.poll(idleMs, due);
+    });
+
+    run("reminders.poll.day", size, size, [&]() { scheduler.start(nowMs); }, [&]() {
+        due.clear();
+        scheduler.poll(nowMs + 86400000, due);
+        g_sink += due.size();
+    });
+}
+
+void benchICal(size_t size, const std::vector<Event>& dataset) {
+    std::string ics;
+    run("ical.write", size, size, noPrepare, [&]() {
+        ics.clear();
+        ICalWriter writer;
+        writer.writeHeader(ics);
+        for (const Event& event : dataset) writer.writeEvent(event, ics);
+        writer.writeFooter(ics);
+    });
+
+    // Fed in the same chunk size the import transfer uses
+    const size_t kChunk = 16 * 1024;
+    std::vector<Event> parsed;
+    run("ical.read", size, size,
+        [&]() { parsed.clear(); },
+        [&]() {
+            ICalReader reader;
+            for (size_t offset = 0; offset < ics.size(); offset += kChunk) {
+                size_t len = std::min(kChunk, ics.size() - offset);
+                reader.feed(ics.data() + offset, len, parsed);
+            }
+            reader.finish(parsed);
+        });
+}
+
+void reportMemory(size_t size, const std::vector<Event>& dataset) {
+    if (!selected("memory.perEvent")) return;
+    int64_t before = MemoryTracker::liveBytes();
+    {
+        EventManager manager;
+        std::vector<Event> batch = dataset;
+        manager.addEvents(batch);
+        int64_t bytes = MemoryTracker::liveBytes() - before;
+        double perEvent = (double)bytes / (double)size;
+        if (g_options.csv) {
+            printf("memory.perEvent,%zu,%s,,,,,,%.1f\n", size, distributionName(g_options.distribution), perEvent);
+        } else {
+            printf("{\"name\":\"memory.perEvent\",\"size\":%zu,\"distribution\":\"%s\",\"bytes\":%lld,"
+                   "\"bytesPerEvent\":%.1f}\n",
+                   size, distributionName(g_options.distribution), (long long)bytes, perEvent);
+        }
+        fflush(stdout);
+    }
+}
+
+bool parseSizes(const char* text, std::vector<size_t>& out) {
+    out.clear();
+    while (*text) {
+        char* end;
+        unsigned long long value = strtoull(text, &end, 10);
+        if (end == text || value == 0) return false;
+        out.push_back((size_t)value);
+        text = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (strcmp(arg, "--sizes") == 0) {
+            if (!parseSizes(value, g_options.sizes)) return false;
+        } else if (strcmp(arg, "--distribution") == 0) {
+            if (!parseDistribution(value, g_options.distribution)) return false;
+        } else if (strcmp(arg, "--seed") == 0) {
+            g_options.seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(arg, "--filter") == 0) {
+            g_options.filter = value;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcmp(value, "csv") == 0) g_options.csv = true;
+            else if (strcmp(value, "json") == 0) g_options.csv = false;
+            else return false;
+        } else if (strcmp(arg, "--min-time-ms") == 0) {
+            g_options.minTimeMs = atof(value);
+        } else {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        fprintf(stderr,
+                "usage: core_bench [--sizes N,N,...] [--distribution uniform|workday|bursty]\n"
+                "                  [--seed N] [--filter SUBSTRING] [--format json|csv] [--min-time-ms MS]\n");
+        return 1;
+    }
+
+    printHeader();
+    benchDates();
+    if (!benchEditScaling()) {
+        fprintf(stderr, "scaling.edit: an edit grows with the calendar size\n");
+        return 1;
+    }
+    for (size_t size : g_options.sizes) {
+        DatasetOptions dataset;
+        dataset.count = size;
+        dataset.distribution = g_options.distribution;
+        dataset.seed = g_options.seed;
+        std::vector<Event> events;
+        generateEvents(dataset, events);
+
+        benchEvents(size, events);
+        benchQueries(size, events);
+        benchUsage(size, events);
+        benchSorting(size, events);
+        benchJson(size, events);
+        benchSync(size, events);
+        benchReminders(size, events);
+        benchICal(size, events);
+        reportMemory(size, events);
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Writes the canonical input traces replayed by ui_bench --trace and by F7
+// in the browser:
+//
+//   trace_gen <output directory>
+//
+// The traces are scripted rather than recorded so they can be regenerated
+// after layout changes. Coordinates assume the default 1400x900 display and
+// the current layout: the view buttons on the first row, PREV/NEXT on the
+// second and the time grid filling the rest. Each trace pins the clock and
+// names a synthetic calendar, so every replay sees the same data.
+
+#include "core/input_trace.h"
+#include "core/synthetic.h"
+#include <cstdio>
+#include <string>
+
+using namespace calendar;
+
+namespace {
+
+const float kDisplayWidth = 1400.0f;
+const float kDisplayHeight = 900.0f;
+const float kFrameMs = 1000.0f / 60.0f;
+
+// Button centres
+const float kRowViews = 22.5f;
+const float kWeekButtonX = 75.0f;
+const float kMonthButtonX = 130.0f;
+const float kYearButtonX = 186.0f;
+const float kTimelineButtonX = 318.0f;
+const float kRowNavigation = 70.5f;
+const float kPrevButtonX = 40.0f;
+const float kNextButtonX = 711.0f;
+// Empty space right of the action buttons; clicking it closes popups
+const float kEmptyX = 1300.0f;
+const float kEmptyY = 113.0f;
+
+// Week view time grid: seven columns after the hour labels. With the clock
+// at 10:00 the grid opens scrolled so 09:00-17:30 is on screen.
+const float kGridLeft = 77.2f;
+const float kGridColumnWidth = 185.8f;
+const float kGridTop = 450.0f;
+const float kGridBottom = 800.0f;
+const float kHourHeight = 48.0f;
+
+class Script {
+public:
+    Script() : mouseX_(kDisplayWidth * 0.5f), mouseY_(kDisplayHeight * 0.5f) {}
+
+    InputTrace& trace() { return trace_; }
+
+    void frame() { trace_.addFrame(kFrameMs, kDisplayWidth, kDisplayHeight); }
+
+    void idle(int frames) {
+        for (int i = 0; i < frames; i++) frame();
+    }
+
+    // Moves in a straight line, one mouse event per frame
+    void moveTo(float x, float y, int frames) {
+        float fromX = mouseX_, fromY = mouseY_;
+        for (int i = 1; i <= frames; i++) {
+            float t = (float)i / (float)frames;
+            mouseX_ = fromX + (x - fromX) * t;
+            mouseY_ = fromY + (y - fromY) * t;
+            frame();
+            input(TraceInput::MOUSE_POS, 0, false, mouseX_, mouseY_);
+        }
+    }
+
+    void button(int button, bool down) {
+        frame();
+        input(TraceInput::MOUSE_BUTTON, button, down, 0.0f, 0.0f);
+    }
+
+    void click(float x, float y, int button = 0) {
+        moveTo(x, y, 4);
+        this->button(button, true);
+        this->button(button, false);
+        idle(2);
+    }
+
+    void drag(float fromX, float fromY, float toX, float toY) {
+        moveTo(fromX, fromY, 4);
+        button(0, true);
+        moveTo(toX, toY, 10);
+        button(0, false);
+        idle(3);
+    }
+
+private:
+    void input(TraceInput::Type type, int code, bool down, float x, float y) {
+        TraceInput event;
+        event.type = type;
+        event.code = code;
+        event.down = down;
+        event.x = x;
+        event.y = y;
+        trace_.addInput(event);
+    }
+
+    InputTrace trace_;
+    float mouseX_, mouseY_;
+};
+
+void setup(Script& script) {
+    // Wednesday, so the opening week has days on both sides of today
+    script.trace().setClock(2025, 2, 12, 10, 0);
+    DatasetOptions dataset;
+    dataset.count = 10000;
+    dataset.distribution = DIST_WORKDAY;
+    dataset.seed = 42;
+    script.trace().setDataset(dataset);
+    script.idle(3);
+}
+
+float columnCentre(int column) {
+    return kGridLeft + (column + 0.5f) * kGridColumnWidth;
+}
+
+// Drags across every day of one week: blocks are moved down an hour within
+// their day and over to the next day, interleaved with right-clicks that
+// open and dismiss the add-event popup
+void weekDrag(Script& script) {
+    setup(script);
+    script.click(kWeekButtonX, kRowViews);
+    script.idle(5);
+    for (int column = 0; column < 7; column++) {
+        float x = columnCentre(column);
+        int step = 0;
+        for (float y = kGridTop; y + kHourHeight < kGridBottom; y += kHourHeight * 1.25f, step++) {
+            if (step % 2 == 0 || column == 6) {
+                script.drag(x, y, x, y + kHourHeight);
+            } else {
+                script.drag(x, y, x + kGridColumnWidth, y);
+            }
+        }
+        script.click(x - kGridColumnWidth * 0.3f, kGridBottom - 20.0f, 1);
+        script.idle(6);
+        script.click(kEmptyX, kEmptyY);
+    }
+    script.idle(10);
+}
+
+// A year forwards a week at a time, then through the months, the year view
+// and the timeline
+void yearNavigation(Script& script) {
+    setup(script);
+    script.click(kWeekButtonX, kRowViews);
+    for (int week = 0; week < 52; week++) script.click(kNextButtonX, kRowNavigation);
+    script.click(kMonthButtonX, kRowViews);
+    for (int month = 0; month < 12; month++) script.click(kNextButtonX, kRowNavigation);
+    script.click(kYearButtonX, kRowViews);
+    script.click(kPrevButtonX, kRowNavigation);
+    script.click(kNextButtonX, kRowNavigation);
+    script.click(kTimelineButtonX, kRowViews);
+    for (int span = 0; span < 12; span++) script.click(kNextButtonX, kRowNavigation);
+    script.idle(10);
+}
+
+bool write(const std::string& path, const InputTrace& trace) {
+    std::string text = "# generated by trace_gen; regenerate rather than edit\n";
+    trace.serialize(text);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+    printf("%s: %zu frames\n", path.c_str(), trace.frameCount());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: trace_gen <output directory>\n");
+        return 1;
+    }
+    std::string dir = argv[1];
+
+    Script drag;
+    weekDrag(drag);
+    Script navigation;
+    yearNavigation(navigation);
+
+    bool ok = write(dir + "/week_drag.trace", drag.trace());
+    ok = write(dir + "/year_navigation.trace", navigation.trace()) && ok;
+    return ok ? 0 : 1;
+}
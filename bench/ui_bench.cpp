@@ -0,0 +1,488 @@
+// Headless UI frame benchmark. Creates an ImGui context with a fixed display
+// size and no platform backend, then drives CalendarUI::render for a number
+// of frames in each view mode against synthetic calendars.
+//
+//   ui_bench [--sizes 1000,10000,100000] [--frames 300]
+//            [--views day,week,month,year,agenda,timeline]
+//            [--display 1400x900] [--distribution workday] [--seed 42]
+//            [--renderer none|imgui|gpu] [--format json|csv]
+//   ui_bench --trace bench/traces/week_drag.trace [--replay-out timings.json]
+//
+// Per view and size it reports CPU time per frame (NewFrame to Render,
+// p50/p99/max), draw-list vertex and index counts, and heap allocations per
+// frame, one result per line. With --trace it replays recorded input traces
+// instead and reports the same figures per trace.
+//
+// --renderer imgui and gpu draw every frame into an offscreen GLES 3
+// context through ImGui's OpenGL backend, and the frame time then runs to
+// the end of RenderDrawData; gpu also turns on the instanced block pass.
+// They need a build with EGL and GLES (CALENDAR_GL) and run without a
+// display on Mesa's software rasteriser:
+//
+//   EGL_PLATFORM=surfaceless LIBGL_ALWAYS_SOFTWARE=1 ui_bench --renderer gpu
+
+#include "core/synthetic.h"
+#include "imgui.h"
+#include "core/calendar.h"
+#include "core/event.h"
+#include "core/frame_arena.h"
+#include "core/input_trace.h"
+#include "core/memory_tracker.h"
+#include "core/profiler.h"
+#include "ui/trace_session.h"
+#include "ui/ui.h"
+#include "ui/block_renderer.h"
+#ifdef CALENDAR_GL
+#include "imgui_impl_opengl3.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace calendar;
+
+namespace {
+
+struct ViewInfo {
+    const char* name;
+    ViewMode mode;
+};
+
+const ViewInfo kViews[] = {
+    {"day", VIEW_DAY},
+    {"week", VIEW_WEEK},
+    {"month", VIEW_MONTH},
+    {"year", VIEW_YEAR},
+    {"agenda", VIEW_AGENDA},
+    {"timeline", VIEW_TIMELINE}
+};
+const int kViewCount = sizeof(kViews) / sizeof(kViews[0]);
+
+// Frames rendered before measuring, so caches and the font atlas are warm
+const int kWarmupFrames = 10;
+
+enum Renderer {
+    RENDERER_NONE,      // draw lists are built but never drawn
+    RENDERER_IMGUI,     // drawn by ImGui's OpenGL backend
+    RENDERER_GPU        // the same, with time grid blocks from BlockRenderer
+};
+const char* const kRendererNames[] = {"none", "imgui", "gpu"};
+
+struct Options {
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    int frames = 300;
+    std::vector<int> views;     // indexes into kViews; empty means all
+    float width = 1400.0f;
+    float height = 900.0f;
+    Distribution distribution = DIST_WORKDAY;
+    uint64_t seed = 42;
+    bool csv = false;
+    Renderer renderer = RENDERER_NONE;
+    std::vector<const char*> traces;    // replayed instead of the view sweep
+    const char* replayOut = nullptr;    // per-frame timings of the last trace
+};
+
+Options g_options;
+BlockRenderer g_blocks;
+
+void* imguiAlloc(size_t size, void*) {
+    return MemoryTracker::allocate(size, MEM_IMGUI);
+}
+
+void imguiFree(void* ptr, void*) {
+    MemoryTracker::release(ptr);
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    size_t index = (size_t)(p * (double)(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+#ifdef CALENDAR_GL
+// Offscreen GLES 3 context: surfaceless where EGL offers it, drawing into
+// a framebuffer object the size of the display
+struct HeadlessGL {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+};
+
+HeadlessGL g_gl;
+
+bool startGL(int width, int height) {
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay) {
+        g_gl.display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    } else {
+        g_gl.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (g_gl.display == EGL_NO_DISPLAY || !eglInitialize(g_gl.display, nullptr, nullptr)) return false;
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    // Surfaceless displays have pbuffer configs only, and the default asks
+    // for window ones
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+                                    EGL_NONE};
+    const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_NONE};
+    EGLConfig config;
+    EGLint configs = 0;
+    if (!eglChooseConfig(g_gl.display, configAttribs, &config, 1, &configs) || configs == 0) return false;
+    g_gl.context = eglCreateContext(g_gl.display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (g_gl.context == EGL_NO_CONTEXT) return false;
+    if (!eglMakeCurrent(g_gl.display, EGL_NO_SURFACE, EGL_NO_SURFACE, g_gl.context)) return false;
+
+    glGenRenderbuffers(1, &g_gl.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_gl.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &g_gl.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_gl.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_gl.colorBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) return false;
+    glViewport(0, 0, width, height);
+    return ImGui_ImplOpenGL3_Init("#version 300 es");
+}
+
+void stopGL() {
+    if (g_gl.context == EGL_NO_CONTEXT) return;
+    g_blocks.shutdown();
+    ImGui_ImplOpenGL3_Shutdown();
+    glDeleteFramebuffers(1, &g_gl.framebuffer);
+    glDeleteRenderbuffers(1, &g_gl.colorBuffer);
+    eglMakeCurrent(g_gl.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(g_gl.display, g_gl.context);
+    eglTerminate(g_gl.display);
+}
+
+void beginGLFrame() {
+    if (g_options.renderer != RENDERER_NONE) ImGui_ImplOpenGL3_NewFrame();
+}
+
+void drawGLFrame() {
+    if (g_options.renderer == RENDERER_NONE) return;
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
+// Outside the timed part of a frame: lets the rasteriser catch up so its
+// threads do not run into the next frame's measurement
+void finishGLFrame() {
+    if (g_options.renderer != RENDERER_NONE) glFinish();
+}
+#else
+bool startGL(int, int) { return false; }
+void stopGL() {}
+void beginGLFrame() {}
+void drawGLFrame() {}
+void finishGLFrame() {}
+#endif
+
+void report(const char* name, size_t size, const char* distribution, std::vector<double>& frameMs,
+            uint64_t vertices, uint64_t indices, uint64_t allocs, uint64_t maxAllocs) {
+    int frameCount = (int)frameMs.size();
+    double frames = frameCount > 0 ? (double)frameCount : 1.0;
+    double maxMs = frameMs.empty() ? 0.0 : *std::max_element(frameMs.begin(), frameMs.end());
+    double p50 = frameMs.empty() ? 0.0 : percentile(frameMs, 0.50);
+    double p99 = frameMs.empty() ? 0.0 : percentile(frameMs, 0.99);
+    const char* renderer = kRendererNames[g_options.renderer];
+    if (g_options.csv) {
+        printf("%s,%zu,%s,%s,%d,%.4f,%.4f,%.4f,%.0f,%.0f,%.2f,%llu\n", name, size, distribution, renderer,
+               frameCount, p50, p99, maxMs, (double)vertices / frames, (double)indices / frames,
+               (double)allocs / frames, (unsigned long long)maxAllocs);
+    } else {
+        printf("{\"view\":\"%s\",\"size\":%zu,\"distribution\":\"%s\",\"renderer\":\"%s\",\"frames\":%d,"
+               "\"p50Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,\"vertices\":%.0f,\"indices\":%.0f,"
+               "\"allocsPerFrame\":%.2f,\"maxAllocsPerFrame\":%llu}\n",
+               name, size, distribution, renderer, frameCount, p50, p99, maxMs, (double)vertices / frames,
+               (double)indices / frames, (double)allocs / frames, (unsigned long long)maxAllocs);
+    }
+    fflush(stdout);
+}
+
+// One frame the way main_loop runs it, minus SDL (and GL unless a renderer
+// was asked for). The mouse sweeps the display so hover paths are exercised
+// too.
+void renderFrame(CalendarUI& ui, int frame) {
+    FrameArena::frame().reset();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DeltaTime = 1.0f / 60.0f;
+    float t = (float)(frame % 240) / 240.0f;
+    io.AddMousePosEvent(io.DisplaySize.x * t, io.DisplaySize.y * (0.5f + 0.4f * sinf(t * 6.2831853f)));
+
+    beginGLFrame();
+    ImGui::NewFrame();
+    ui.render();
+    ImGui::Render();
+    drawGLFrame();
+}
+
+void runView(const ViewInfo& view, size_t size, const std::vector<Event>& dataset) {
+    CalendarState state;
+    EventManager manager;
+    std::vector<Event> batch = dataset;
+    manager.addEvents(batch);
+    CalendarUI ui(state, manager);
+    ui.setupTerminalStyle();
+    ui.setBlockRenderer(&g_blocks);
+    state.viewMode = view.mode;
+
+    for (int i = 0; i < kWarmupFrames; i++) {
+        renderFrame(ui, i);
+        finishGLFrame();
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(g_options.frames);
+    uint64_t allocs = 0;
+    uint64_t maxAllocs = 0;
+    uint64_t vertices = 0;
+    uint64_t indices = 0;
+    for (int i = 0; i < g_options.frames; i++) {
+        uint64_t startAllocs = MemoryTracker::totalAllocations();
+        double start = Profiler::nowMs();
+        renderFrame(ui, kWarmupFrames + i);
+        frameMs.push_back(Profiler::nowMs() - start);
+        finishGLFrame();
+
+        uint64_t frameAllocs = MemoryTracker::totalAllocations() - startAllocs;
+        allocs += frameAllocs;
+        maxAllocs = std::max(maxAllocs, frameAllocs);
+        const ImDrawData* drawData = ImGui::GetDrawData();
+        vertices += drawData->TotalVtxCount;
+        indices += drawData->TotalIdxCount;
+    }
+
+    report(view.name, size, distributionName(g_options.distribution), frameMs, vertices, indices, allocs,
+           maxAllocs);
+}
+
+// Replays a recorded trace through the same TraceSession hooks main_loop
+// uses, rebuilding the UI whenever the session asks for a reset
+bool replayTrace(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    std::string text;
+    char buffer[64 * 1024];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, read);
+    fclose(file);
+
+    InputTrace trace;
+    if (!trace.parse(text)) {
+        fprintf(stderr, "%s is not a calendar input trace\n", path);
+        return false;
+    }
+
+    EventManager manager;
+    TraceSession session(manager);
+    session.startReplay(trace);
+    std::unique_ptr<CalendarState> state;
+    std::unique_ptr<CalendarUI> ui;
+    while (!session.replayDone()) {
+        FrameArena::frame().reset();
+        if (session.takeResetRequest() || !ui) {
+            ui.reset();
+            state.reset(new CalendarState());
+            ui.reset(new CalendarUI(*state, manager));
+            ui->setupTerminalStyle();
+            ui->setBlockRenderer(&g_blocks);
+        }
+        beginGLFrame();
+        session.beforeNewFrame();
+        ImGui::NewFrame();
+        session.afterNewFrame();
+        ui->render();
+        ImGui::Render();
+        // Timed up to here, like the app, which draws after endFrame too
+        session.endFrame();
+        drawGLFrame();
+        finishGLFrame();
+    }
+
+    std::vector<double> frameMs;
+    uint64_t vertices = 0, indices = 0, allocs = 0, maxAllocs = 0;
+    for (const TraceSession::FrameTiming& timing : session.timings()) {
+        frameMs.push_back(timing.cpuMs);
+        vertices += timing.vertices;
+        indices += timing.indices;
+        allocs += timing.allocations;
+        maxAllocs = std::max(maxAllocs, (uint64_t)timing.allocations);
+    }
+    const char* name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    report(name, manager.getEventCount(),
+           trace.hasDataset() ? distributionName(trace.dataset().distribution) : "none",
+           frameMs, vertices, indices, allocs, maxAllocs);
+
+    if (g_options.replayOut) {
+        std::string json;
+        session.writeResultsJSON(json);
+        FILE* out = fopen(g_options.replayOut, "wb");
+        if (out) {
+            fwrite(json.data(), 1, json.size(), out);
+            fclose(out);
+        }
+    }
+    session.finishReplay();
+    return true;
+}
+
+bool parseSizes(const char* text, std::vector<size_t>& out) {
+    out.clear();
+    while (*text) {
+        char* end;
+        unsigned long long value = strtoull(text, &end, 10);
+        if (end == text || value == 0) return false;
+        if (*end != ',' && *end != '\0') return false;
+        out.push_back((size_t)value);
+        text = *end == ',' ? end + 1 : end;
+    }
+    return !out.empty();
+}
+
+bool parseViews(const char* text, std::vector<int>& out) {
+    out.clear();
+    while (*text) {
+        size_t len = strcspn(text, ",");
+        int found = -1;
+        for (int i = 0; i < kViewCount; i++) {
+            if (strlen(kViews[i].name) == len && strncmp(kViews[i].name, text, len) == 0) found = i;
+        }
+        if (found < 0) return false;
+        out.push_back(found);
+        text += len;
+        if (*text == ',') text++;
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (strcmp(arg, "--sizes") == 0) {
+            if (!parseSizes(value, g_options.sizes)) return false;
+        } else if (strcmp(arg, "--frames") == 0) {
+            g_options.frames = atoi(value);
+            if (g_options.frames <= 0) return false;
+        } else if (strcmp(arg, "--views") == 0) {
+            if (!parseViews(value, g_options.views)) return false;
+        } else if (strcmp(arg, "--display") == 0) {
+            int width, height;
+            if (sscanf(value, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) return false;
+            g_options.width = (float)width;
+            g_options.height = (float)height;
+        } else if (strcmp(arg, "--distribution") == 0) {
+            if (!parseDistribution(value, g_options.distribution)) return false;
+        } else if (strcmp(arg, "--seed") == 0) {
+            g_options.seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(arg, "--trace") == 0) {
+            g_options.traces.push_back(value);
+        } else if (strcmp(arg, "--replay-out") == 0) {
+            g_options.replayOut = value;
+        } else if (strcmp(arg, "--renderer") == 0) {
+            int found = -1;
+            for (int r = 0; r <= RENDERER_GPU; r++) {
+                if (strcmp(value, kRendererNames[r]) == 0) found = r;
+            }
+            if (found < 0) return false;
+            g_options.renderer = (Renderer)found;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcmp(value, "csv") == 0) g_options.csv = true;
+            else if (strcmp(value, "json") == 0) g_options.csv = false;
+            else return false;
+        } else {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        fprintf(stderr,
+                "usage: ui_bench [--sizes N,N,...] [--frames N] [--views day,week,month,year,agenda,timeline]\n"
+                "                [--display WxH] [--distribution uniform|workday|bursty] [--seed N]\n"
+                "                [--renderer none|imgui|gpu] [--format json|csv] [--trace FILE]...\n"
+                "                [--replay-out FILE]\n");
+        return 1;
+    }
+    if (g_options.views.empty()) {
+        for (int i = 0; i < kViewCount; i++) g_options.views.push_back(i);
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree);
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(g_options.width, g_options.height);
+    if (g_options.renderer == RENDERER_NONE) {
+        // No renderer: the atlas only has to exist for NewFrame
+        unsigned char* pixels;
+        int atlasWidth, atlasHeight;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+    } else if (!startGL((int)g_options.width, (int)g_options.height)) {
+        fprintf(stderr, "no GLES 3 context for --renderer %s\n", kRendererNames[g_options.renderer]);
+        ImGui::DestroyContext();
+        return 1;
+    } else if (g_options.renderer == RENDERER_GPU) {
+        if (!g_blocks.init()) {
+            fprintf(stderr, "the instanced block pass does not run on this context\n");
+            stopGL();
+            ImGui::DestroyContext();
+            return 1;
+        }
+        g_blocks.setEnabled(true);
+    }
+
+    if (g_options.csv) {
+        printf("view,size,distribution,renderer,frames,p50_ms,p99_ms,max_ms,vertices,indices,allocs_per_frame,"
+               "max_allocs_per_frame\n");
+    }
+
+    if (!g_options.traces.empty()) {
+        bool ok = true;
+        for (const char* path : g_options.traces) ok = replayTrace(path) && ok;
+        stopGL();
+        ImGui::DestroyContext();
+        return ok ? 0 : 1;
+    }
+
+    // Events start this year so the views open on populated dates
+    CalendarState today;
+    for (size_t size : g_options.sizes) {
+        DatasetOptions dataset;
+        dataset.count = size;
+        dataset.distribution = g_options.distribution;
+        dataset.seed = g_options.seed;
+        dataset.startYear = today.currentYear;
+        dataset.years = 1;
+        std::vector<Event> events;
+        generateEvents(dataset, events);
+
+        for (int view : g_options.views) runView(kViews[view], size, events);
+    }
+
+    stopGL();
+    ImGui::DestroyContext();
+    return 0;
+}
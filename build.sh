@@ -1,6 +1,10 @@
 #!/bin/bash
 set -e
 
+# THREADS=0 skips the pthreads variant; the page then always loads the
+# single-threaded build
+THREADS=${THREADS:-1}
+
 echo "============================================"
 echo "  WASM Calendar - Build Script"
 echo "============================================"
@@ -8,45 +12,73 @@ echo "============================================"
 # Create output directory
 mkdir -p /app/dist
 
+IMGUI_MODULES="imgui imgui_demo imgui_draw imgui_tables imgui_widgets"
+CORE_MODULES="event calendar storage storage_web ical file_io day_index usage_index tags chrono_index frame_pacer profiler \
+    memory_tracker frame_arena clock synthetic input_trace persistence_worker task_scheduler \
+    event_delta tab_sync tab_channel_web sync_engine sync_server sync_transport sync_http_web \
+    recurrence reminder_scheduler notifier_web"
+UI_MODULES="ui_core ui_views ui_events ui_timegrid ui_transfer ui_stats ui_tags grid_cache label_cache hit_index profiler_hud \
+    trace_session block_renderer block_renderer_gl"
+
+# build_variant <object dir> <output .js> <flags for every compile and the link>
+build_variant() {
+    local objdir=$1
+    local output=$2
+    shift 2
+    local flags="$*"
+    mkdir -p "$objdir"
+
+    echo "[1/4] Compiling Dear ImGui library..."
+    for name in $IMGUI_MODULES; do
+        emcc -c imgui/$name.cpp -o $objdir/$name.o -Iimgui $flags
+    done
+    emcc -c imgui/backends/imgui_impl_sdl2.cpp -o $objdir/imgui_impl_sdl2.o -Iimgui -s USE_SDL=2 $flags
+    emcc -c imgui/backends/imgui_impl_opengl3.cpp -o $objdir/imgui_impl_opengl3.o -Iimgui -s USE_SDL=2 $flags
+
+    echo "[2/4] Compiling core domain modules..."
+    for name in $CORE_MODULES; do
+        emcc -c src/core/$name.cpp -o $objdir/$name.o -Isrc -Iimgui -s USE_SDL=2 $flags
+    done
+
+    echo "[3/4] Compiling UI modules..."
+    for name in $UI_MODULES; do
+        emcc -c src/ui/$name.cpp -o $objdir/$name.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2 $flags
+    done
+
+    echo "      Compiling main entry point..."
+    emcc -c src/main.cpp -o $objdir/main.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2 $flags
+
+    echo "[4/4] Linking WASM application..."
+    emcc -o "$output" $objdir/*.o \
+        -s USE_SDL=2 \
+        -s USE_WEBGL2=1 \
+        -s FULL_ES3=1 \
+        -s WASM=1 \
+        -s ALLOW_MEMORY_GROWTH=1 \
+        -s NO_EXIT_RUNTIME=1 \
+        -s ASSERTIONS=1 \
+        $flags \
+        -O2
+}
+
+# WebAssembly SIMD (every current browser) vectorises the tag filter scans
+SIMD_FLAGS="-msimd128"
+
 echo ""
-echo "[1/4] Compiling Dear ImGui library..."
-emcc -c imgui/imgui.cpp -o imgui.o -Iimgui
-emcc -c imgui/imgui_demo.cpp -o imgui_demo.o -Iimgui
-emcc -c imgui/imgui_draw.cpp -o imgui_draw.o -Iimgui
-emcc -c imgui/imgui_tables.cpp -o imgui_tables.o -Iimgui
-emcc -c imgui/imgui_widgets.cpp -o imgui_widgets.o -Iimgui
-emcc -c imgui/backends/imgui_impl_sdl2.cpp -o imgui_impl_sdl2.o -Iimgui -s USE_SDL=2
-emcc -c imgui/backends/imgui_impl_opengl3.cpp -o imgui_impl_opengl3.o -Iimgui -s USE_SDL=2
-
-echo "[2/4] Compiling core domain modules..."
-emcc -c src/core/event.cpp -o event.o -Isrc -Iimgui -s USE_SDL=2
-emcc -c src/core/calendar.cpp -o calendar.o -Isrc -Iimgui -s USE_SDL=2
-emcc -c src/core/storage.cpp -o storage.o -Isrc -Iimgui -s USE_SDL=2
-
-echo "[3/4] Compiling UI modules..."
-emcc -c src/ui/ui_core.cpp -o ui_core.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2
-emcc -c src/ui/ui_views.cpp -o ui_views.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2
-emcc -c src/ui/ui_events.cpp -o ui_events.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2
-emcc -c src/ui/ui_timegrid.cpp -o ui_timegrid.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2
-
-echo "      Compiling main entry point..."
-emcc -c src/main.cpp -o main.o -Isrc -Iimgui -Iimgui/backends -s USE_SDL=2
-
-echo "[4/4] Linking WASM application..."
-emcc -o /app/dist/index.html \
-    main.o event.o calendar.o storage.o \
-    ui_core.o ui_views.o ui_events.o ui_timegrid.o \
-    imgui.o imgui_demo.o imgui_draw.o imgui_tables.o imgui_widgets.o \
-    imgui_impl_sdl2.o imgui_impl_opengl3.o \
-    -s USE_SDL=2 \
-    -s USE_WEBGL2=1 \
-    -s FULL_ES3=1 \
-    -s WASM=1 \
-    -s ALLOW_MEMORY_GROWTH=1 \
-    -s NO_EXIT_RUNTIME=1 \
-    -s ASSERTIONS=1 \
-    --shell-file /app/shell.html \
-    -O2
+echo "Single-threaded build (index.js)"
+build_variant obj-st /app/dist/index.js $SIMD_FLAGS
+
+if [ "$THREADS" = "1" ]; then
+    # Loaded instead of index.js when the page is cross-origin isolated;
+    # the pool holds the persistence worker's thread from startup
+    echo ""
+    echo "Threaded build (index-mt.js)"
+    build_variant obj-mt /app/dist/index-mt.js $SIMD_FLAGS -pthread -DCALENDAR_THREADS -s PTHREAD_POOL_SIZE=1
+fi
+
+# The shell picks a variant at load time, so it is copied rather than
+# passed to emcc as --shell-file
+cp /app/shell.html /app/dist/index.html
 
 echo ""
 echo "============================================"
@@ -54,4 +86,3 @@ echo "  Build Complete!"
 echo "============================================"
 ls -lh /app/dist/
 echo ""
-
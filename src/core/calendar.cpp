@@ -1,5 +1,4 @@
 #include "calendar.h"
-#include <ctime>
 
 namespace calendar {
 
@@ -21,23 +20,41 @@ int CalendarLogic::getDaysInMonth(int month, int year) {
 }
 
 int CalendarLogic::getFirstDayOfMonth(int month, int year) {
-    tm timeinfo = {};
-    timeinfo.tm_year = year - 1900;
-    timeinfo.tm_mon = month;
-    timeinfo.tm_mday = 1;
-    mktime(&timeinfo);
-    // Convert Sunday=0 to Monday=0 system
-    return (timeinfo.tm_wday + 6) % 7;
+    return getDayOfWeek(1, month, year);
 }
 
 int CalendarLogic::getDayOfWeek(int day, int month, int year) {
-    tm timeinfo = {};
-    timeinfo.tm_year = year - 1900;
-    timeinfo.tm_mon = month;
-    timeinfo.tm_mday = day;
-    mktime(&timeinfo);
-    // Convert Sunday=0 to Monday=0 system
-    return (timeinfo.tm_wday + 6) % 7;
+    // 1970-01-01 was a Thursday (3 in the Monday=0 system)
+    int weekday = (toDayNumber(day, month, year) + 3) % 7;
+    return weekday < 0 ? weekday + 7 : weekday;
+}
+
+int CalendarLogic::toDayNumber(int day, int month, int year) {
+    // Howard Hinnant's days_from_civil, with March as the first month
+    int m = month + 1;
+    int y = year - (m <= 2 ? 1 : 0);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void CalendarLogic::fromDayNumber(int dayNumber, int& day, int& month, int& year) {
+    int z = dayNumber + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    int m = mp < 10 ? mp + 3 : mp - 9;
+    month = m - 1;
+    year = yoe + era * 400 + (m <= 2 ? 1 : 0);
+}
+
+int CalendarLogic::getDayOfYear(int day, int month, int year) {
+    return toDayNumber(day, month, year) - toDayNumber(1, 0, year);
 }
 
 void CalendarLogic::getMondayOfWeek(int day, int month, int year, int& mondayDay, int& mondayMonth, int& mondayYear) {
@@ -12,6 +12,11 @@ public:
     static void getMondayOfWeek(int day, int month, int year, int& mondayDay, int& mondayMonth, int& mondayYear);
     static int getDayOfWeek(int day, int month, int year);
     
+    // Days since 1970-01-01 (proleptic Gregorian), month is 0-based
+    static int toDayNumber(int day, int month, int year);
+    static void fromDayNumber(int dayNumber, int& day, int& month, int& year);
+    static int getDayOfYear(int day, int month, int year);
+    
     static const char* getMonthName(int month);
     static const char* getDayName(int day);
 
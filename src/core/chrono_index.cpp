@@ -0,0 +1,217 @@
+#include "chrono_index.h"
+#include "calendar.h"
+#include "event.h"
+#include "memory_tracker.h"
+#include <algorithm>
+#include <cassert>
+
+namespace calendar {
+
+int64_t ChronoIndex::sortKey(const Event& event) {
+    int64_t key = dateKey(CalendarLogic::toDayNumber(event.day, event.month, event.year));
+    if (event.isAllDay || event.hourStart == -1) {
+        return key;
+    }
+    return key + 1 + event.hourStart * 60 + event.minuteStart;
+}
+
+int ChronoIndex::dayOf(int64_t key) {
+    // Rounds down for dates before day 0 as well
+    int64_t day = key / 2048;
+    if (key % 2048 < 0) day--;
+    return (int)day;
+}
+
+void ChronoIndex::insert(uint32_t index, const Event& event) {
+    insertEntry({sortKey(event), index}, event.tags);
+}
+
+void ChronoIndex::insertBatch(const Event* events, uint32_t first, size_t count) {
+    if (count == 0) return;
+    MEMORY_SCOPE(MEM_INDEXES);
+    std::vector<std::pair<Entry, uint64_t>> added(count);
+    for (size_t i = 0; i < count; i++) {
+        const Event& event = events[first + i];
+        added[i] = {{sortKey(event), first + (uint32_t)i}, event.tags};
+    }
+    // Sort only the batch, then merge it in date by date: O(D + k log k)
+    // plus the rows of the dates it touches, instead of a full sort
+    std::sort(added.begin(), added.end(),
+              [](const std::pair<Entry, uint64_t>& a, const std::pair<Entry, uint64_t>& b) {
+                  return a.first < b.first;
+              });
+
+    size_t newDates = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (dayOf(added[i].first.key) != dayOf(added[i - 1].first.key)) newDates++;
+    }
+    std::vector<Day> merged;
+    merged.reserve(days_.size() + newDates);
+    size_t d = 0;
+    size_t i = 0;
+    while (i < count) {
+        int dayNumber = dayOf(added[i].first.key);
+        size_t end = i + 1;
+        while (end < count && dayOf(added[end].first.key) == dayNumber) end++;
+        while (d < days_.size() && days_[d].dayNumber < dayNumber) merged.push_back(std::move(days_[d++]));
+
+        merged.emplace_back();
+        Day& day = merged.back();
+        day.dayNumber = dayNumber;
+        std::vector<Entry> entries;
+        std::vector<uint64_t> tags;
+        if (d < days_.size() && days_[d].dayNumber == dayNumber) {
+            entries = std::move(days_[d].entries);
+            tags = std::move(days_[d].tags);
+            d++;
+        }
+        day.entries.reserve(entries.size() + (end - i));
+        day.tags.reserve(entries.size() + (end - i));
+        size_t row = 0;
+        while (row < entries.size() || i < end) {
+            if (i == end || (row < entries.size() && entries[row] < added[i].first)) {
+                day.entries.push_back(entries[row]);
+                day.tags.push_back(tags[row]);
+                row++;
+            } else {
+                day.entries.push_back(added[i].first);
+                day.tags.push_back(added[i].second);
+                i++;
+            }
+        }
+    }
+    while (d < days_.size()) merged.push_back(std::move(days_[d++]));
+    days_.swap(merged);
+    size_ += count;
+    rowsValid_ = false;
+}
+
+void ChronoIndex::erase(uint32_t index, const Event& event) {
+    removeEntry(index, sortKey(event));
+}
+
+void ChronoIndex::relocate(uint32_t from, uint32_t to, const Event& event) {
+    // Entries with equal keys are ordered by position, so the entry moves
+    int64_t key = sortKey(event);
+    moveEntry({key, from}, {key, to}, event.tags);
+}
+
+void ChronoIndex::update(uint32_t index, const Event& before, const Event& after) {
+    moveEntry({sortKey(before), index}, {sortKey(after), index}, after.tags);
+}
+
+void ChronoIndex::clear() {
+    days_.clear();
+    firstRows_.clear();
+    size_ = 0;
+    rowsValid_ = true;
+}
+
+uint32_t ChronoIndex::at(size_t row) const {
+    assert(row < size_);
+    refreshRows();
+    size_t pos = std::upper_bound(firstRows_.begin(), firstRows_.end(), row) - firstRows_.begin() - 1;
+    return days_[pos].entries[row - firstRows_[pos]].index;
+}
+
+size_t ChronoIndex::lowerBound(int64_t key) const {
+    refreshRows();
+    int dayNumber = dayOf(key);
+    size_t pos = findDay(dayNumber);
+    if (pos == days_.size()) return size_;
+    const Day& day = days_[pos];
+    if (day.dayNumber != dayNumber) return firstRows_[pos];
+    Entry probe = {key, 0};
+    return firstRows_[pos] + (std::lower_bound(day.entries.begin(), day.entries.end(), probe) - day.entries.begin());
+}
+
+ChronoIndex::Run ChronoIndex::run(int dayNumber, int64_t fromKey, int64_t toKey) const {
+    size_t pos = findDay(dayNumber);
+    if (pos == days_.size() || days_[pos].dayNumber != dayNumber) return {nullptr, nullptr, 0};
+    const Day& day = days_[pos];
+    Entry from = {fromKey, 0};
+    Entry to = {toKey, 0};
+    size_t first = std::lower_bound(day.entries.begin(), day.entries.end(), from) - day.entries.begin();
+    size_t last = std::lower_bound(day.entries.begin() + first, day.entries.end(), to) - day.entries.begin();
+    return {day.entries.data() + first, day.tags.data() + first, last - first};
+}
+
+void ChronoIndex::insertEntry(const Entry& entry, uint64_t tags) {
+    MEMORY_SCOPE(MEM_INDEXES);
+    int dayNumber = dayOf(entry.key);
+    size_t pos = findDay(dayNumber);
+    if (pos == days_.size() || days_[pos].dayNumber != dayNumber) {
+        days_.emplace(days_.begin() + pos);
+        days_[pos].dayNumber = dayNumber;
+    }
+    Day& day = days_[pos];
+    size_t row = std::upper_bound(day.entries.begin(), day.entries.end(), entry) - day.entries.begin();
+    day.entries.insert(day.entries.begin() + row, entry);
+    day.tags.insert(day.tags.begin() + row, tags);
+    size_++;
+    rowsValid_ = false;
+}
+
+void ChronoIndex::removeEntry(uint32_t index, int64_t key) {
+    int dayNumber = dayOf(key);
+    size_t pos = findDay(dayNumber);
+    if (pos == days_.size() || days_[pos].dayNumber != dayNumber) return;
+    Day& day = days_[pos];
+    Entry probe = {key, index};
+    auto it = std::lower_bound(day.entries.begin(), day.entries.end(), probe);
+    if (it == day.entries.end() || it->index != index || it->key != key) return;
+    size_t row = it - day.entries.begin();
+    day.entries.erase(it);
+    day.tags.erase(day.tags.begin() + row);
+    if (day.entries.empty()) days_.erase(days_.begin() + pos);
+    size_--;
+    rowsValid_ = false;
+}
+
+void ChronoIndex::moveEntry(const Entry& from, const Entry& to, uint64_t tags) {
+    int dayNumber = dayOf(from.key);
+    if (dayNumber != dayOf(to.key)) {
+        removeEntry(from.index, from.key);
+        insertEntry(to, tags);
+        return;
+    }
+
+    // Within one date the row only moves inside its bucket, which stays
+    size_t pos = findDay(dayNumber);
+    if (pos == days_.size() || days_[pos].dayNumber != dayNumber) return;
+    Day& day = days_[pos];
+    auto it = std::lower_bound(day.entries.begin(), day.entries.end(), from);
+    if (it == day.entries.end() || it->index != from.index || it->key != from.key) return;
+    size_t oldRow = it - day.entries.begin();
+    size_t row = std::upper_bound(day.entries.begin(), day.entries.end(), to) - day.entries.begin();
+    if (row > oldRow) {
+        // Past its own old slot, which shifts out of the way
+        row--;
+        std::rotate(day.entries.begin() + oldRow, day.entries.begin() + oldRow + 1, day.entries.begin() + row + 1);
+        std::rotate(day.tags.begin() + oldRow, day.tags.begin() + oldRow + 1, day.tags.begin() + row + 1);
+    } else if (row < oldRow) {
+        std::rotate(day.entries.begin() + row, day.entries.begin() + oldRow, day.entries.begin() + oldRow + 1);
+        std::rotate(day.tags.begin() + row, day.tags.begin() + oldRow, day.tags.begin() + oldRow + 1);
+    }
+    day.entries[row] = to;
+    day.tags[row] = tags;
+}
+
+size_t ChronoIndex::findDay(int dayNumber) const {
+    return std::lower_bound(days_.begin(), days_.end(), dayNumber,
+                            [](const Day& day, int n) { return day.dayNumber < n; }) - days_.begin();
+}
+
+void ChronoIndex::refreshRows() const {
+    if (rowsValid_) return;
+    MEMORY_SCOPE(MEM_INDEXES);
+    firstRows_.resize(days_.size());
+    size_t row = 0;
+    for (size_t i = 0; i < days_.size(); i++) {
+        firstRows_[i] = row;
+        row += days_[i].entries.size();
+    }
+    rowsValid_ = true;
+}
+
+} // namespace calendar
@@ -0,0 +1,91 @@
+#ifndef CHRONO_INDEX_H
+#define CHRONO_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace calendar {
+
+struct Event;
+
+// Event positions ordered by date, then all-day before timed, then start
+// time. EventManager keeps it in step with its event vector so the Nth
+// event in time, or the first event on a date, is a lookup or a binary
+// search instead of a scan.
+//
+// Rows are kept in one bucket per date that has events, each with its
+// rows' tags in a packed column alongside, so tag filters scan 8 bytes a
+// row. An edit only shifts rows within its date, whatever the size of the
+// calendar; the row number where each date starts is worked out again on
+// the first read by row after an edit, one pass over the dates.
+class ChronoIndex {
+public:
+    struct Entry {
+        int64_t key;
+        uint32_t index;
+        bool operator<(const Entry& other) const {
+            return key != other.key ? key < other.key : index < other.index;
+        }
+    };
+
+    // Consecutive rows of one date, straight out of its bucket
+    struct Run {
+        const Entry* entries;
+        const uint64_t* tags;   // Event::tags of each row
+        size_t count;
+    };
+
+    static int64_t sortKey(const Event& event);
+    static int64_t dateKey(int dayNumber) { return (int64_t)dayNumber * 2048; }
+
+    void insert(uint32_t index, const Event& event);
+    // Adds the batch of consecutive positions [first, first + count) of the
+    // event vector that starts at events
+    void insertBatch(const Event* events, uint32_t first, size_t count);
+    void erase(uint32_t index, const Event& event);
+    // The event at position from now lives at position to
+    void relocate(uint32_t from, uint32_t to, const Event& event);
+    void update(uint32_t index, const Event& before, const Event& after);
+    void clear();
+
+    size_t size() const { return size_; }
+    uint32_t at(size_t row) const;
+    // First row whose key is >= key
+    size_t lowerBound(int64_t key) const;
+    // The rows of dayNumber with keys in [fromKey, toKey)
+    Run run(int dayNumber, int64_t fromKey, int64_t toKey) const;
+    Run day(int dayNumber) const { return run(dayNumber, dateKey(dayNumber), dateKey(dayNumber + 1)); }
+
+    // Every date with events, in order, for scans of the whole index
+    size_t dateCount() const { return days_.size(); }
+    Run date(size_t i) const {
+        const Day& d = days_[i];
+        return {d.entries.data(), d.tags.data(), d.entries.size()};
+    }
+
+private:
+    struct Day {
+        int dayNumber;
+        std::vector<Entry> entries;
+        std::vector<uint64_t> tags;
+    };
+
+    static int dayOf(int64_t key);
+    void insertEntry(const Entry& entry, uint64_t tags);
+    void removeEntry(uint32_t index, int64_t key);
+    // Replaces from with to, which may sort elsewhere
+    void moveEntry(const Entry& from, const Entry& to, uint64_t tags);
+    // Position in days_ of the first date >= dayNumber
+    size_t findDay(int dayNumber) const;
+    void refreshRows() const;
+
+    std::vector<Day> days_;     // sorted by dayNumber, none empty
+    size_t size_ = 0;
+    mutable std::vector<size_t> firstRows_;    // row of each date's first entry
+    mutable bool rowsValid_ = true;
+};
+
+} // namespace calendar
+
+#endif // CHRONO_INDEX_H
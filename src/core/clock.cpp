@@ -0,0 +1,58 @@
+#include "clock.h"
+#include "calendar.h"
+#include <chrono>
+
+namespace calendar {
+
+namespace {
+
+bool g_pinned = false;
+tm g_pinnedTime;
+
+} // namespace
+
+void Clock::localNow(tm& out) {
+    if (g_pinned) {
+        out = g_pinnedTime;
+        return;
+    }
+    time_t now = time(nullptr);
+    localtime_r(&now, &out);
+}
+
+void Clock::pin(int year, int month, int day, int hour, int minute) {
+    tm local = {};
+    local.tm_year = year - 1900;
+    local.tm_mon = month;
+    local.tm_mday = day;
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_isdst = -1;
+    // Normalises the fields and fills in the weekday
+    mktime(&local);
+    g_pinnedTime = local;
+    g_pinned = true;
+}
+
+void Clock::unpin() {
+    g_pinned = false;
+}
+
+bool Clock::pinned() {
+    return g_pinned;
+}
+
+int64_t Clock::epochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t Clock::localMs() {
+    tm local;
+    localNow(local);
+    int64_t minutes = (int64_t)CalendarLogic::toDayNumber(local.tm_mday, local.tm_mon, local.tm_year + 1900) * 1440 +
+                      local.tm_hour * 60 + local.tm_min;
+    return minutes * 60000 + local.tm_sec * 1000;
+}
+
+} // namespace calendar
@@ -0,0 +1,30 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+#include <ctime>
+
+namespace calendar {
+
+// Local wall-clock time the UI takes "today" and "now" from. Input traces
+// pin it while recording and replaying, so a replay sees the same dates and
+// scroll positions as the recording did.
+class Clock {
+public:
+    static void localNow(tm& out);
+
+    // month is 0-based, as everywhere else in the calendar
+    static void pin(int year, int month, int day, int hour, int minute);
+    static void unpin();
+    static bool pinned();
+
+    // Milliseconds since the Unix epoch, for change stamps; never pinned
+    static int64_t epochMs();
+    // localNow() as milliseconds on the CalendarLogic::toDayNumber axis
+    // (day * 86400000 + time of day), to the second; pinned like localNow()
+    static int64_t localMs();
+};
+
+} // namespace calendar
+
+#endif // CLOCK_H
@@ -0,0 +1,69 @@
+#include "day_index.h"
+#include "calendar.h"
+#include "event.h"
+#include "memory_tracker.h"
+
+namespace calendar {
+
+namespace {
+
+// Day-of-year slot, or -1 for dates outside the year (e.g. corrupt records)
+int daySlot(int day, int month, int year) {
+    if (month < 0 || month > 11 || day < 1 || day > CalendarLogic::getDaysInMonth(month, year)) {
+        return -1;
+    }
+    return CalendarLogic::getDayOfYear(day, month, year);
+}
+
+} // namespace
+
+void DayIndex::add(const Event& event) {
+    apply(event, 1);
+}
+
+void DayIndex::remove(const Event& event) {
+    apply(event, -1);
+}
+
+void DayIndex::apply(const Event& event, int delta) {
+    MEMORY_SCOPE(MEM_INDEXES);
+    int slot = daySlot(event.day, event.month, event.year);
+    if (slot < 0) return;
+    YearSlots& slots = years_[event.year];
+    if (slots.days.empty()) {
+        slots.days.assign(366, 0);
+        slots.hours.assign(366 * 24, 0);
+    }
+    if (delta < 0 && slots.days[slot] == 0) return;
+    slots.days[slot] += delta;
+
+    if (event.isAllDay || event.hourStart < 0 || event.hourStart > 23) return;
+    int startMinutes = event.hourStart * 60 + event.minuteStart;
+    int endMinutes = event.hourEnd != -1 ? event.hourEnd * 60 + event.minuteEnd : startMinutes + 60;
+    int lastHour = (endMinutes - 1) / 60;
+    if (lastHour > 23) lastHour = 23;
+    int* hours = &slots.hours[slot * 24];
+    for (int hour = event.hourStart; hour <= lastHour; hour++) {
+        hours[hour] += delta;
+    }
+}
+
+int DayIndex::countForDate(int day, int month, int year) const {
+    int slot = daySlot(day, month, year);
+    const int* counts = yearCounts(year);
+    return (counts && slot >= 0) ? counts[slot] : 0;
+}
+
+const int* DayIndex::yearCounts(int year) const {
+    auto it = years_.find(year);
+    return it != years_.end() ? it->second.days.data() : nullptr;
+}
+
+const int* DayIndex::hourCounts(int day, int month, int year) const {
+    int slot = daySlot(day, month, year);
+    auto it = years_.find(year);
+    if (slot < 0 || it == years_.end()) return nullptr;
+    return &it->second.hours[slot * 24];
+}
+
+} // namespace calendar
@@ -0,0 +1,38 @@
+#ifndef DAY_INDEX_H
+#define DAY_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+namespace calendar {
+
+struct Event;
+
+// Per-day event counts and per-hour occupancy, kept up to date by
+// EventManager on every mutation so views can shade whole years or draw
+// density bars without touching the event list.
+class DayIndex {
+public:
+    void add(const Event& event);
+    void remove(const Event& event);
+    void clear() { years_.clear(); }
+
+    int countForDate(int day, int month, int year) const;
+    // 366 counts indexed by day of year, or nullptr if the year has no events
+    const int* yearCounts(int year) const;
+    // 24 counts of timed events overlapping each hour of the date, or nullptr
+    const int* hourCounts(int day, int month, int year) const;
+
+private:
+    struct YearSlots {
+        std::vector<int> days;    // 366 per year
+        std::vector<int> hours;   // 366 * 24, day-major
+    };
+    void apply(const Event& event, int delta);
+
+    std::unordered_map<int, YearSlots> years_;
+};
+
+} // namespace calendar
+
+#endif // DAY_INDEX_H
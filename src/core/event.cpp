@@ -1,60 +1,410 @@
 #include "event.h"
+#include "calendar.h"
+#include "clock.h"
+#include "memory_tracker.h"
+#include "profiler.h"
 #include <algorithm>
 #include <cstdio>
+#include <iterator>
+#include <random>
+#include <utility>
 
 namespace calendar {
 
+namespace {
+
+// Per thread, since the persistence worker builds managers on its own
+uint64_t randomBits() {
+    static thread_local std::mt19937_64 engine(((uint64_t)std::random_device()() << 32) ^ std::random_device()());
+    return engine();
+}
+
+uint64_t newUid() {
+    uint64_t uid;
+    do {
+        uid = randomBits();
+    } while (uid == 0);
+    return uid;
+}
+
+} // namespace
+
+EventManager::EventManager() : site_((uint16_t)randomBits()) {}
+
+Event& EventManager::insertOne(const Event& event) {
+    MEMORY_SCOPE(MEM_EVENTS);
+    events_.emplace_back();
+    {
+        MEMORY_SCOPE(MEM_TEXT);
+        events_.back() = event;
+    }
+    Event& added = events_.back();
+    added.id = nextId_++;
+    added.version = 0;
+    uint32_t index = (uint32_t)(events_.size() - 1);
+    if (added.uid == 0) added.uid = newUid();
+    {
+        MEMORY_SCOPE(MEM_INDEXES);
+        uidIndex_[added.uid] = index;
+    }
+    dayIndex_.add(added);
+    addShown(added);
+    usageIndex_.add(added);
+    noteDuration(added);
+    chronoIndex_.insert(index, added);
+    revision_++;
+    return added;
+}
+
+void EventManager::replaceOne(Event* event, const Event& updated) {
+    dayIndex_.remove(*event);
+    removeShown(*event);
+    usageIndex_.remove(*event);
+    chronoIndex_.update((uint32_t)(event - events_.data()), *event, updated);
+    uint32_t id = event->id;
+    uint32_t version = event->version;
+    uint64_t uid = event->uid;
+    {
+        MEMORY_SCOPE(MEM_TEXT);
+        *event = updated;
+    }
+    event->id = id;
+    event->version = version + 1;
+    event->uid = uid;
+    noteDuration(*event);
+    dayIndex_.add(*event);
+    addShown(*event);
+    usageIndex_.add(*event);
+    revision_++;
+}
+
+void EventManager::removeAt(uint32_t index) {
+    Event& removed = events_[index];
+    dayIndex_.remove(removed);
+    removeShown(removed);
+    usageIndex_.remove(removed);
+    chronoIndex_.erase(index, removed);
+    uidIndex_.erase(removed.uid);
+    uint32_t last = (uint32_t)(events_.size() - 1);
+    if (index != last) {
+        chronoIndex_.relocate(last, index, events_[last]);
+        removed = std::move(events_[last]);
+        uidIndex_[removed.uid] = index;
+    }
+    events_.pop_back();
+    revision_++;
+}
+
 void EventManager::addEvent(const Event& event) {
-    events_.push_back(event);
+    uint64_t stamp = event.stamp != 0 ? event.stamp : nextStamp();
+    noteStamp(stamp);
+    Event* existing = event.uid != 0 ? findByUid(event.uid) : nullptr;
+    if (existing) {
+        if (existing->stamp > stamp) return;
+        replaceOne(existing, event);
+        existing->stamp = stamp;
+        notifyChanged(*existing, CHANGE_LOCAL);
+        return;
+    }
+    Event& added = insertOne(event);
+    added.stamp = stamp;
+    notifyChanged(added, CHANGE_LOCAL);
+}
+
+void EventManager::addEvents(std::vector<Event>& batch) {
+    insertBatch(batch, CHANGE_LOCAL);
+}
+
+void EventManager::applyInserts(std::vector<Event>& batch, ChangeOrigin origin) {
+    insertBatch(batch, origin);
+}
+
+void EventManager::insertBatch(std::vector<Event>& batch, ChangeOrigin origin) {
+    MEMORY_SCOPE(MEM_EVENTS);
+    uint64_t stamp = 0;
+    size_t first = events_.size();
+    {
+        MEMORY_SCOPE(MEM_INDEXES);
+        uidIndex_.reserve(first + batch.size());
+    }
+    // Identities first: a uid already stored, or seen earlier in the batch,
+    // keeps whichever copy has the newer stamp instead of being indexed twice
+    size_t kept = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        Event& evt = batch[i];
+        if (evt.uid == 0) evt.uid = newUid();
+        if (evt.stamp == 0) {
+            if (stamp == 0) stamp = nextStamp();
+            evt.stamp = stamp;
+        } else {
+            noteStamp(evt.stamp);
+        }
+        bool added;
+        uint32_t stored;
+        {
+            MEMORY_SCOPE(MEM_INDEXES);
+            auto slot = uidIndex_.emplace(evt.uid, (uint32_t)(first + kept));
+            added = slot.second;
+            stored = slot.first->second;
+        }
+        if (!added) {
+            if (stored < first) {
+                Event* existing = &events_[stored];
+                if (existing->stamp <= evt.stamp) {
+                    replaceOne(existing, evt);
+                    existing->stamp = evt.stamp;
+                    notifyChanged(*existing, origin);
+                }
+            } else {
+                Event& earlier = batch[stored - first];
+                if (earlier.stamp <= evt.stamp) earlier = std::move(evt);
+            }
+            continue;
+        }
+        if (kept != i) batch[kept] = std::move(evt);
+        kept++;
+    }
+    batch.resize(kept);
+
+    for (auto& evt : batch) {
+        evt.id = nextId_++;
+        evt.version = 0;
+        dayIndex_.add(evt);
+        addShown(evt);
+        usageIndex_.add(evt);
+        noteDuration(evt);
+    }
+    events_.insert(events_.end(), std::make_move_iterator(batch.begin()),
+                   std::make_move_iterator(batch.end()));
+    chronoIndex_.insertBatch(events_.data(), (uint32_t)first, batch.size());
+    batch.clear();
+    revision_++;
+    if (!listeners_.empty()) {
+        for (size_t i = first; i < events_.size(); i++) notifyChanged(events_[i], origin);
+    }
 }
 
 void EventManager::removeEvent(Event* event) {
-    for (auto it = events_.begin(); it != events_.end(); ++it) {
-        if (&(*it) == event) {
-            events_.erase(it);
-            break;
+    assert(owns(event) && "removeEvent() given a stale or foreign pointer");
+    if (!owns(event)) return;
+    uint64_t uid = event->uid;
+    removeAt((uint32_t)(event - events_.data()));
+    if (!listeners_.empty()) notifyRemoved(uid, nextStamp(), CHANGE_LOCAL);
+}
+
+void EventManager::updateEvent(Event* event, const Event& updated) {
+    assert(owns(event) && "updateEvent() given a stale or foreign pointer");
+    if (!owns(event)) return;
+    replaceOne(event, updated);
+    event->stamp = nextStamp();
+    notifyChanged(*event, CHANGE_LOCAL);
+}
+
+Event* EventManager::findByUid(uint64_t uid) {
+    auto it = uidIndex_.find(uid);
+    return it != uidIndex_.end() ? &events_[it->second] : nullptr;
+}
+
+void EventManager::applyUpsert(const Event& event, ChangeOrigin origin) {
+    noteStamp(event.stamp);
+    Event* existing = findByUid(event.uid);
+    if (existing) {
+        replaceOne(existing, event);
+        notifyChanged(*existing, origin);
+    } else {
+        notifyChanged(insertOne(event), origin);
+    }
+}
+
+void EventManager::applyRemove(uint64_t uid, uint64_t stamp, ChangeOrigin origin) {
+    noteStamp(stamp);
+    auto it = uidIndex_.find(uid);
+    if (it == uidIndex_.end()) return;
+    removeAt(it->second);
+    notifyRemoved(uid, stamp, origin);
+}
+
+void EventManager::addListener(EventListener* listener) {
+    listeners_.push_back(listener);
+}
+
+void EventManager::removeListener(EventListener* listener) {
+    for (size_t i = 0; i < listeners_.size(); i++) {
+        if (listeners_[i] == listener) {
+            listeners_.erase(listeners_.begin() + i);
+            return;
         }
     }
 }
 
-std::vector<Event*> EventManager::getEventsForDate(int day, int month, int year) {
-    std::vector<Event*> result;
-    for (auto& evt : events_) {
-        if (evt.day == day && evt.month == month && evt.year == year) {
-            result.push_back(&evt);
+void EventManager::notifyChanged(const Event& event, ChangeOrigin origin) {
+    for (EventListener* listener : listeners_) listener->eventChanged(event, origin);
+}
+
+void EventManager::notifyRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) {
+    for (EventListener* listener : listeners_) listener->eventRemoved(uid, stamp, origin);
+}
+
+uint64_t EventManager::nextStamp() {
+    uint64_t stamp = ((uint64_t)Clock::epochMs() << 16) | site_;
+    if (stamp <= lastStamp_) stamp = (((lastStamp_ >> 16) + 1) << 16) | site_;
+    lastStamp_ = stamp;
+    return stamp;
+}
+
+void EventManager::noteStamp(uint64_t stamp) {
+    if (stamp > lastStamp_) lastStamp_ = stamp;
+}
+
+void EventManager::clear() {
+    events_.clear();
+    dayIndex_.clear();
+    shownDayIndex_.clear();
+    usageIndex_.clear();
+    chronoIndex_.clear();
+    uidIndex_.clear();
+    revision_++;
+    for (EventListener* listener : listeners_) listener->eventsReplaced();
+}
+
+void EventManager::replaceWith(EventManager& other) {
+    events_.swap(other.events_);
+    std::swap(dayIndex_, other.dayIndex_);
+    rebuildShown();
+    std::swap(usageIndex_, other.usageIndex_);
+    std::swap(chronoIndex_, other.chronoIndex_);
+    uidIndex_.swap(other.uidIndex_);
+    longestEventMinutes_ = other.longestEventMinutes_;
+    noteStamp(other.lastStamp_);
+    // Ids stay unique per session; the indexes hold positions, not ids
+    for (Event& evt : events_) evt.id = nextId_++;
+    other.clear();
+    revision_++;
+    for (EventListener* listener : listeners_) listener->eventsReplaced();
+}
+
+size_t EventManager::findFirstRowOnOrAfter(int day, int month, int year) const {
+    return chronoIndex_.lowerBound(ChronoIndex::dateKey(CalendarLogic::toDayNumber(day, month, year)));
+}
+
+EventManager::RowRange EventManager::getAllDayRows(int day, int month, int year) const {
+    int64_t key = ChronoIndex::dateKey(CalendarLogic::toDayNumber(day, month, year));
+    return {chronoIndex_.lowerBound(key), chronoIndex_.lowerBound(key + 1)};
+}
+
+EventManager::RowRange EventManager::getTimedRows(int day, int month, int year, int fromMinute, int toMinute) const {
+    int64_t fromKey, toKey;
+    timedKeys(CalendarLogic::toDayNumber(day, month, year), fromMinute, toMinute, fromKey, toKey);
+    return {chronoIndex_.lowerBound(fromKey), chronoIndex_.lowerBound(toKey)};
+}
+
+void EventManager::timedKeys(int dayNumber, int fromMinute, int toMinute, int64_t& fromKey, int64_t& toKey) const {
+    int64_t key = ChronoIndex::dateKey(dayNumber);
+    int from = fromMinute - longestEventMinutes_;
+    if (from < 0) from = 0;
+    if (toMinute > 24 * 60) toMinute = 24 * 60;
+    fromKey = key + 1 + from;
+    toKey = key + 1 + toMinute;
+}
+
+void EventManager::noteDuration(const Event& event) {
+    if (event.isAllDay || event.hourStart == -1 || event.hourEnd == -1) return;
+    int duration = (event.hourEnd * 60 + event.minuteEnd) - (event.hourStart * 60 + event.minuteStart);
+    if (duration > longestEventMinutes_) longestEventMinutes_ = duration;
+}
+
+EventManager::EventRange EventManager::getEventsForDate(int day, int month, int year) {
+    PROFILE_SCOPE("events.forDate");
+    // A date's events are its bucket of the chronological order
+    return EventRange(*this, chronoIndex_.day(CalendarLogic::toDayNumber(day, month, year)));
+}
+
+EventManager::EventRange EventManager::getAllDayEvents(int day, int month, int year) {
+    int dayNumber = CalendarLogic::toDayNumber(day, month, year);
+    int64_t key = ChronoIndex::dateKey(dayNumber);
+    return EventRange(*this, chronoIndex_.run(dayNumber, key, key + 1));
+}
+
+EventManager::EventRange EventManager::getTimedEvents(int day, int month, int year, int fromMinute, int toMinute) {
+    int dayNumber = CalendarLogic::toDayNumber(day, month, year);
+    int64_t fromKey, toKey;
+    timedKeys(dayNumber, fromMinute, toMinute, fromKey, toKey);
+    return EventRange(*this, chronoIndex_.run(dayNumber, fromKey, toKey));
+}
+
+uint64_t EventManager::getTagsForDate(int day, int month, int year) const {
+    ChronoIndex::Run run = chronoIndex_.day(CalendarLogic::toDayNumber(day, month, year));
+    // Rows the filter hides contribute none of its bits
+    uint64_t tags = unionOfTags(run.tags, run.count);
+    return tagFilter_ ? tags & tagFilter_ : tags;
+}
+
+void EventManager::setTagFilter(uint64_t mask) {
+    if (mask == tagFilter_) return;
+    tagFilter_ = mask;
+    rebuildShown();
+}
+
+void EventManager::rebuildShown() {
+    shownDayIndex_.clear();
+    if (!tagFilter_) return;
+    PROFILE_SCOPE("events.filter");
+    for (const Event& evt : events_) addShown(evt);
+}
+
+void EventManager::refreshFiltered() {
+    if (filteredRevision_ == revision_ && filteredMask_ == tagFilter_) return;
+    PROFILE_SCOPE("events.filter");
+    MEMORY_SCOPE(MEM_INDEXES);
+    filteredRevision_ = revision_;
+    filteredMask_ = tagFilter_;
+    filteredRows_.clear();
+    uint32_t row = 0;
+    for (size_t i = 0; i < chronoIndex_.dateCount(); i++) {
+        ChronoIndex::Run run = chronoIndex_.date(i);
+        for (size_t j = 0; j < run.count; j++, row++) {
+            if (run.tags[j] & tagFilter_) filteredRows_.push_back(row);
         }
     }
-    sortEventsByTime(result);
-    return result;
 }
 
-void EventManager::sortEventsByTime(std::vector<Event*>& events) {
-    std::sort(events.begin(), events.end(), [](Event* a, Event* b) {
-        // All-day events first
-        if (a->isAllDay && !b->isAllDay) return true;
-        if (!a->isAllDay && b->isAllDay) return false;
-        if (a->isAllDay && b->isAllDay) return false;
-        
-        // Then by start time
-        if (a->hourStart != b->hourStart) return a->hourStart < b->hourStart;
-        return a->minuteStart < b->minuteStart;
-    });
+size_t EventManager::getFilteredCount() {
+    if (!tagFilter_) return events_.size();
+    refreshFiltered();
+    return filteredRows_.size();
+}
+
+Event* EventManager::getFiltered(size_t i) {
+    if (!tagFilter_) return getChronological(i);
+    refreshFiltered();
+    assert(i < filteredRows_.size());
+    return &events_[chronoIndex_.at(filteredRows_[i])];
+}
+
+size_t EventManager::findFirstFilteredOnOrAfter(int day, int month, int year) {
+    size_t row = findFirstRowOnOrAfter(day, month, year);
+    if (!tagFilter_) return row;
+    refreshFiltered();
+    return std::lower_bound(filteredRows_.begin(), filteredRows_.end(), (uint32_t)row) - filteredRows_.begin();
 }
 
 std::string EventManager::formatEventTime(const Event* event) {
+    char buffer[32];
+    formatEventTime(event, buffer, sizeof(buffer));
+    return std::string(buffer);
+}
+
+int EventManager::formatEventTime(const Event* event, char* buffer, size_t size) {
     if (event->isAllDay || event->hourStart == -1) {
-        return "All day";
+        return snprintf(buffer, size, "All day");
     }
-    char buffer[32];
     if (event->hourEnd != -1) {
-        snprintf(buffer, sizeof(buffer), "%02d:%02d - %02d:%02d", 
+        return snprintf(buffer, size, "%02d:%02d - %02d:%02d", 
                 event->hourStart, event->minuteStart,
                 event->hourEnd, event->minuteEnd);
-    } else {
-        snprintf(buffer, sizeof(buffer), "%02d:%02d", 
-                event->hourStart, event->minuteStart);
     }
-    return std::string(buffer);
+    return snprintf(buffer, size, "%02d:%02d", 
+            event->hourStart, event->minuteStart);
 }
 
 } // namespace calendar
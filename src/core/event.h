@@ -1,7 +1,15 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include "chrono_index.h"
+#include "day_index.h"
+#include "tags.h"
+#include "usage_index.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace calendar {
@@ -16,28 +24,241 @@ struct Event {
     int hourEnd;        // 0-23, -1 for all-day event
     int minuteEnd;      // 0-59
     bool isAllDay;
+    std::string recurrence;  // RFC 5545 RRULE value, empty if not recurring
+    int reminderMinutes;     // remind this long before the start, -1 for none
+    uint64_t tags;           // bit i set for tag i of EventManager::getTags()
+    uint32_t id;             // assigned by EventManager, unique per session
+    uint32_t version;        // bumped by EventManager on every update
+    uint64_t uid;            // random, persisted; the same event in every tab
+    uint64_t stamp;          // last change, see EventManager::nextStamp
     
     // Constructor for backward compatibility
     Event() : day(0), month(0), year(0), hourStart(-1), minuteStart(0), 
-              hourEnd(-1), minuteEnd(0), isAllDay(false) {}
+              hourEnd(-1), minuteEnd(0), isAllDay(false), reminderMinutes(-1), tags(0), id(0), version(0), uid(0), stamp(0) {}
 };
 
+// Where a reported change came from, so a sync layer does not send a
+// change back to where it came from
+enum ChangeOrigin {
+    CHANGE_LOCAL,   // this tab: edits, drags, imports
+    CHANGE_TAB,     // another open tab, through TabSync
+    CHANGE_SERVER   // the sync server, through SyncEngine
+};
+
+// Told about every mutation once the indexes are up to date. Whole-calendar
+// swaps (loads through replaceWith(), clear()) are not reported event by
+// event, only through eventsReplaced().
+class EventListener {
+public:
+    virtual ~EventListener() = default;
+    virtual void eventChanged(const Event& event, ChangeOrigin origin) = 0;  // added or updated
+    virtual void eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) = 0;
+    virtual void eventsReplaced() {}
+};
+
+// Pointers to stored events (from findByUid(), getChronological() or an
+// EventRange) point into the manager's event vector: any mutation may move
+// or reuse the slot, so they are only good until the next one. Keep the
+// uid to find an event again later. Debug builds check ranges and the
+// pointers handed back to updateEvent() and removeEvent().
 class EventManager {
 public:
-    EventManager() = default;
+    EventManager();
     
+    // Events without a uid get one; every added event is stamped now unless
+    // it already carries a stamp (loaded from storage). An event whose uid
+    // is already stored, or appears twice in a batch, replaces the other
+    // copy if its stamp is not older and is dropped otherwise.
     void addEvent(const Event& event);
+    void addEvents(std::vector<Event>& batch);  // moves out of batch and clears it
+    // Moves the last event into the freed slot, so pointers to it go stale
     void removeEvent(Event* event);
-    std::vector<Event*> getEventsForDate(int day, int month, int year);
-    std::vector<Event>& getAllEvents() { return events_; }
+    // Replaces the fields of a stored event; all edits must go through here
+    // so the indexes stay in step
+    void updateEvent(Event* event, const Event& updated);
     const std::vector<Event>& getAllEvents() const { return events_; }
-    void clear() { events_.clear(); }
+    const DayIndex& getDayIndex() const { return dayIndex_; }
+    // The same summary over the events the tag filter shows; the full one
+    // while there is no filter
+    const DayIndex& getShownDayIndex() const { return tagFilter_ ? shownDayIndex_ : dayIndex_; }
+    const UsageIndex& getUsageIndex() const { return usageIndex_; }
+    Event* findByUid(uint64_t uid);
+    // Names for the bits of Event::tags
+    TagTable& getTags() { return tags_; }
+    const TagTable& getTags() const { return tags_; }
+    
+    // Chronological access: row 0 is the earliest event. Rows are stable
+    // until the next mutation.
+    size_t getEventCount() const { return events_.size(); }
+    Event* getChronological(size_t row) {
+        assert(row < chronoIndex_.size());
+        return &events_[chronoIndex_.at(row)];
+    }
+    size_t findFirstRowOnOrAfter(int day, int month, int year) const;
+    
+    // Half-open row ranges into the chronological order
+    struct RowRange {
+        size_t first;
+        size_t last;
+    };
+    RowRange getAllDayRows(int day, int month, int year) const;
+    // Timed events on a date that may overlap [fromMinute, toMinute). Rows
+    // starting up to the longest event duration earlier are included, so
+    // callers still test each event's end against fromMinute.
+    RowRange getTimedRows(int day, int month, int year, int fromMinute, int toMinute) const;
+
+    // Events to show carry any tag of the filter; 0 shows every event. It
+    // applies to EventRanges and the filtered rows below, taken after it is
+    // set. Changing it is not a mutation, so ranges and pointers stay good;
+    // the shown day summary is rebuilt in one pass over the events.
+    void setTagFilter(uint64_t mask);
+    uint64_t getTagFilter() const { return tagFilter_; }
+    bool passesFilter(const Event& event) const { return !tagFilter_ || (event.tags & tagFilter_); }
+
+    // Rows of one date iterated as pointers straight into the event
+    // storage, skipping rows the tag filter hides: nothing is copied, so
+    // taking one costs the binary searches that find it and, while a
+    // filter is set, one scan of the range's tag column for its size. It goes stale
+    // with the first mutation, like the pointers it yields; debug builds
+    // assert when a stale range is read.
+    class EventRange {
+    public:
+        class iterator {
+        public:
+            Event* operator*() const { return range_->at(row_); }
+            iterator& operator++() {
+                row_ = range_->skipHidden(row_ + 1);
+                return *this;
+            }
+            bool operator==(const iterator& other) const { return row_ == other.row_; }
+            bool operator!=(const iterator& other) const { return row_ != other.row_; }
+
+        private:
+            friend class EventRange;
+            iterator(const EventRange* range, size_t row) : range_(range), row_(row) {}
+            const EventRange* range_;
+            size_t row_;
+        };
+
+        iterator begin() const { return iterator(this, skipHidden(0)); }
+        iterator end() const { return iterator(this, run_.count); }
+        // Events shown, not rows spanned
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+    private:
+        friend class EventManager;
+        EventRange(EventManager& manager, ChronoIndex::Run run)
+            : manager_(&manager), run_(run), filter_(manager.tagFilter_), size_(run.count)
+#ifndef NDEBUG
+              , revision_(manager.revision_)
+#endif
+        {
+            if (filter_) size_ = countTagged(run.tags, size_, filter_);
+        }
+        Event* at(size_t row) const {
+            assert(manager_->revision_ == revision_ && "EventRange read after the calendar changed");
+            assert(row < run_.count);
+            return &manager_->events_[run_.entries[row].index];
+        }
+        size_t skipHidden(size_t row) const {
+            if (!filter_) return row;
+            while (row < run_.count && !(run_.tags[row] & filter_)) row++;
+            return row;
+        }
+
+        EventManager* manager_;
+        ChronoIndex::Run run_;
+        uint64_t filter_;
+        size_t size_;
+#ifndef NDEBUG
+        uint64_t revision_;
+#endif
+    };
+
+    // A date's events: all-day ones first, then timed ones by start time.
+    // The two parts are also available on their own.
+    EventRange getEventsForDate(int day, int month, int year);
+    EventRange getAllDayEvents(int day, int month, int year);
+    EventRange getTimedEvents(int day, int month, int year, int fromMinute, int toMinute);
+    // The tags of a date's shown events, limited to the filter's
+    uint64_t getTagsForDate(int day, int month, int year) const;
+
+    // The chronological order with the filter applied, for lists of every
+    // event; the same rows as getChronological() while there is none. The
+    // row list is rebuilt on first use after a mutation or filter change.
+    size_t getFilteredCount();
+    Event* getFiltered(size_t i);
+    size_t findFirstFilteredOnOrAfter(int day, int month, int year);
+
+    void clear();
+    // Takes over other's events and indexes as a single mutation, e.g. a
+    // calendar loaded on the persistence worker; other is left empty
+    void replaceWith(EventManager& other);
+
+    // Changes from elsewhere (other tabs, the sync server): keep the
+    // event's uid and stamp and are reported with the given origin. Upsert
+    // adds or replaces by uid.
+    void applyUpsert(const Event& event, ChangeOrigin origin);
+    // Events with uids not stored yet, sorted into the indexes together
+    // like addEvents(); moves out of batch and clears it
+    void applyInserts(std::vector<Event>& batch, ChangeOrigin origin);
+    void applyRemove(uint64_t uid, uint64_t stamp, ChangeOrigin origin);
+
+    void addListener(EventListener* listener);
+    void removeListener(EventListener* listener);
+    // Change stamps order edits across tabs: milliseconds since the epoch in
+    // the high 48 bits and this session's random site id in the low 16, so
+    // no two sessions produce the same stamp. Never lower than any stamp
+    // seen so far, which keeps an edit ahead of the change it was based on.
+    uint64_t nextStamp();
+    
+    // Bumped on every mutation so caches and the render loop can detect changes
+    uint64_t getRevision() const { return revision_; }
     
     static std::string formatEventTime(const Event* event);
+    // Allocation-free variant; returns the formatted length
+    static int formatEventTime(const Event* event, char* buffer, size_t size);
 
 private:
     std::vector<Event> events_;
-    void sortEventsByTime(std::vector<Event*>& events);
+    DayIndex dayIndex_;
+    DayIndex shownDayIndex_;     // events passing tagFilter_, empty without one
+    UsageIndex usageIndex_;
+    ChronoIndex chronoIndex_;
+    std::unordered_map<uint64_t, uint32_t> uidIndex_;  // uid -> position in events_
+    std::vector<EventListener*> listeners_;
+    TagTable tags_;
+    uint64_t tagFilter_ = 0;
+    std::vector<uint32_t> filteredRows_;     // chronological rows shown
+    uint64_t filteredRevision_ = ~0ull;      // what filteredRows_ was built for
+    uint64_t filteredMask_ = 0;
+    uint64_t revision_ = 0;
+    uint32_t nextId_ = 1;
+    uint16_t site_;
+    uint64_t lastStamp_ = 0;
+    int longestEventMinutes_ = 60;  // only grows; bounds getTimedRows look-back
+    void noteDuration(const Event& event);
+    void addShown(const Event& event) {
+        if (event.tags & tagFilter_) shownDayIndex_.add(event);
+    }
+    void removeShown(const Event& event) {
+        if (event.tags & tagFilter_) shownDayIndex_.remove(event);
+    }
+    void rebuildShown();
+    // Keys of the timed rows getTimedRows() and getTimedEvents() return
+    void timedKeys(int dayNumber, int fromMinute, int toMinute, int64_t& fromKey, int64_t& toKey) const;
+    void noteStamp(uint64_t stamp);
+    void refreshFiltered();
+    Event& insertOne(const Event& event);
+    void insertBatch(std::vector<Event>& batch, ChangeOrigin origin);
+    void replaceOne(Event* event, const Event& updated);
+    void removeAt(uint32_t index);
+    bool owns(const Event* event) const {
+        return event >= events_.data() && event < events_.data() + events_.size();
+    }
+    void notifyChanged(const Event& event, ChangeOrigin origin);
+    void notifyRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin);
 };
 
 } // namespace calendar
@@ -0,0 +1,222 @@
+#include "event_delta.h"
+#include "memory_tracker.h"
+
+namespace calendar {
+
+namespace {
+
+const uint8_t kMagic = 0xCD;
+const uint8_t kFormat = 3;
+const uint8_t kSyncMagic = 0xCE;
+const uint8_t kSyncVersion = 1;
+const uint8_t kSyncMore = 0x01;
+
+void putVarint(uint64_t value, std::string& out) {
+    while (value >= 0x80) {
+        out += (char)(uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)(uint8_t)value;
+}
+
+void putSigned(int value, std::string& out) {
+    putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31), out);
+}
+
+void putFixed64(uint64_t value, std::string& out) {
+    for (int i = 0; i < 8; i++) out += (char)(uint8_t)(value >> (i * 8));
+}
+
+void putText(const std::string& text, std::string& out) {
+    putVarint(text.size(), out);
+    out += text;
+}
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool varint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) return false;
+            uint8_t byte = *p++;
+            out |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool signedInt(int& out) {
+        uint64_t raw;
+        if (!varint(raw) || raw > 0xFFFFFFFFull) return false;
+        uint32_t zigzag = (uint32_t)raw;
+        out = (int)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        return true;
+    }
+
+    bool fixed64(uint64_t& out) {
+        if (end - p < 8) return false;
+        out = 0;
+        for (int i = 0; i < 8; i++) out |= (uint64_t)p[i] << (i * 8);
+        p += 8;
+        return true;
+    }
+
+    bool text(std::string& out) {
+        uint64_t len;
+        if (!varint(len) || (uint64_t)(end - p) < len) return false;
+        out.assign((const char*)p, (size_t)len);
+        p += len;
+        return true;
+    }
+};
+
+void appendBatch(const std::vector<EventDelta>& deltas, std::string& out) {
+    out += (char)kMagic;
+    out += (char)kFormat;
+    putVarint(deltas.size(), out);
+    for (const EventDelta& delta : deltas) {
+        out += (char)delta.kind;
+        putFixed64(delta.uid, out);
+        putVarint(delta.stamp, out);
+        if (delta.kind != EventDelta::UPSERT) continue;
+        const Event& evt = delta.event;
+        putSigned(evt.day, out);
+        putSigned(evt.month, out);
+        putSigned(evt.year, out);
+        putSigned(evt.hourStart, out);
+        putSigned(evt.minuteStart, out);
+        putSigned(evt.hourEnd, out);
+        putSigned(evt.minuteEnd, out);
+        out += (char)(evt.isAllDay ? 1 : 0);
+        putSigned(evt.reminderMinutes, out);
+        putVarint(evt.tags, out);
+        putText(evt.recurrence, out);
+        putText(evt.text, out);
+    }
+}
+
+bool readBatch(Reader& in, std::vector<EventDelta>& out) {
+    out.clear();
+    uint64_t count;
+    if (in.end - in.p < 2 || in.p[0] != kMagic || in.p[1] != kFormat) return false;
+    in.p += 2;
+    if (!in.varint(count)) return false;
+    // Each delta takes at least ten bytes, so a bogus count cannot reserve much
+    if (count > (uint64_t)(in.end - in.p) / 10) return false;
+    out.resize((size_t)count);
+    for (EventDelta& delta : out) {
+        if (in.p >= in.end) return false;
+        uint8_t kind = *in.p++;
+        if (kind != EventDelta::UPSERT && kind != EventDelta::REMOVE) return false;
+        delta.kind = (EventDelta::Kind)kind;
+        if (!in.fixed64(delta.uid) || !in.varint(delta.stamp)) return false;
+        if (delta.kind != EventDelta::UPSERT) continue;
+        Event& evt = delta.event;
+        if (!in.signedInt(evt.day) || !in.signedInt(evt.month) || !in.signedInt(evt.year) ||
+            !in.signedInt(evt.hourStart) || !in.signedInt(evt.minuteStart) ||
+            !in.signedInt(evt.hourEnd) || !in.signedInt(evt.minuteEnd) || in.p >= in.end) {
+            return false;
+        }
+        evt.isAllDay = *in.p++ != 0;
+        if (!in.signedInt(evt.reminderMinutes) || !in.varint(evt.tags)) return false;
+        if (!in.text(evt.recurrence) || !in.text(evt.text)) return false;
+        evt.uid = delta.uid;
+        evt.stamp = delta.stamp;
+    }
+    return true;
+}
+
+} // namespace
+
+void encodeDeltas(const std::vector<EventDelta>& deltas, std::string& out) {
+    out.clear();
+    appendBatch(deltas, out);
+}
+
+bool decodeDeltas(const std::string& payload, std::vector<EventDelta>& out) {
+    MEMORY_SCOPE(MEM_TEXT);
+    Reader in = {(const uint8_t*)payload.data(), (const uint8_t*)payload.data() + payload.size()};
+    return readBatch(in, out);
+}
+
+void encodeSyncMessage(const SyncMessage& message, std::string& out) {
+    out.clear();
+    out += (char)kSyncMagic;
+    out += (char)kSyncVersion;
+    out += (char)(message.more ? kSyncMore : 0);
+    putVarint(message.cursor, out);
+    appendBatch(message.deltas, out);
+}
+
+bool decodeSyncMessage(const std::string& payload, SyncMessage& out) {
+    MEMORY_SCOPE(MEM_TEXT);
+    Reader in = {(const uint8_t*)payload.data(), (const uint8_t*)payload.data() + payload.size()};
+    if (payload.size() < 3 || in.p[0] != kSyncMagic || in.p[1] != kSyncVersion) return false;
+    out.more = (in.p[2] & kSyncMore) != 0;
+    in.p += 3;
+    return in.varint(out.cursor) && readBatch(in, out.deltas);
+}
+
+void DeltaMerger::noteRemove(uint64_t uid, uint64_t stamp) {
+    tombstones_[uid] = stamp;
+}
+
+bool DeltaMerger::buried(const EventDelta& delta) const {
+    auto tombstone = tombstones_.find(delta.uid);
+    return tombstone != tombstones_.end() && tombstone->second >= delta.stamp;
+}
+
+bool DeltaMerger::apply(EventManager& events, const EventDelta& delta, ChangeOrigin origin) {
+    if (buried(delta)) return false;
+    Event* local = events.findByUid(delta.uid);
+
+    if (delta.kind == EventDelta::REMOVE) {
+        tombstones_[delta.uid] = delta.stamp;
+        // A later local edit outlives an earlier removal
+        if (!local || local->stamp > delta.stamp) return false;
+        events.applyRemove(delta.uid, delta.stamp, origin);
+        return true;
+    }
+
+    if (local && local->stamp >= delta.stamp) return false;
+    events.applyUpsert(delta.event, origin);
+    return true;
+}
+
+size_t DeltaMerger::applyAll(EventManager& events, const std::vector<EventDelta>& deltas, ChangeOrigin origin) {
+    size_t changed = 0;
+    for (const EventDelta& delta : deltas) {
+        if (delta.kind == EventDelta::UPSERT && !events.findByUid(delta.uid)) {
+            if (buried(delta)) continue;
+            MEMORY_SCOPE(MEM_EVENTS);
+            auto queued = insertIndex_.find(delta.uid);
+            if (queued == insertIndex_.end()) {
+                insertIndex_[delta.uid] = inserts_.size();
+                inserts_.push_back(delta.event);
+            } else if (inserts_[queued->second].stamp < delta.stamp) {
+                inserts_[queued->second] = delta.event;
+            }
+            continue;
+        }
+        if (apply(events, delta, origin)) changed++;
+    }
+    if (inserts_.empty()) return changed;
+
+    // Drop queued events a later delta in the batch removed
+    size_t kept = 0;
+    for (Event& evt : inserts_) {
+        auto tombstone = tombstones_.find(evt.uid);
+        if (tombstone != tombstones_.end() && tombstone->second >= evt.stamp) continue;
+        if (&inserts_[kept] != &evt) inserts_[kept] = std::move(evt);
+        kept++;
+    }
+    inserts_.resize(kept);
+    insertIndex_.clear();
+    changed += inserts_.size();
+    events.applyInserts(inserts_, origin);
+    return changed;
+}
+
+} // namespace calendar
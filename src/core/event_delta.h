@@ -0,0 +1,83 @@
+#ifndef EVENT_DELTA_H
+#define EVENT_DELTA_H
+
+#include "event.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace calendar {
+
+// One change to one event, as sent between tabs
+struct EventDelta {
+    enum Kind : uint8_t {
+        UPSERT = 1,
+        REMOVE = 2
+    };
+
+    Kind kind;
+    uint64_t uid;
+    uint64_t stamp;
+    Event event;        // UPSERT only
+
+    EventDelta() : kind(UPSERT), uid(0), stamp(0) {}
+};
+
+// Compact binary batch: a magic/format byte pair, a varint count, then per
+// delta the kind, uid (8 bytes), stamp and, for upserts, the fields as
+// zigzag varints (the all-day flag a byte, the tag bits a plain varint)
+// with length-prefixed text. Local ids and versions are not sent. A typical
+// timed event takes about 30 bytes plus its text.
+void encodeDeltas(const std::vector<EventDelta>& deltas, std::string& out);
+// False if the payload is truncated or from another format
+bool decodeDeltas(const std::string& payload, std::vector<EventDelta>& out);
+
+// One exchange with the sync server, the same shape both ways: the client
+// sends the server cursor it has caught up to and its pending deltas; the
+// server answers with its new cursor and the changes recorded after the
+// old one. more is set when the answer was cut short and the client should
+// ask again straight away.
+struct SyncMessage {
+    uint64_t cursor;
+    bool more;
+    std::vector<EventDelta> deltas;
+
+    SyncMessage() : cursor(0), more(false) {}
+};
+
+// A magic/version pair, a flags byte and the cursor, then an encodeDeltas
+// batch
+void encodeSyncMessage(const SyncMessage& message, std::string& out);
+bool decodeSyncMessage(const std::string& payload, SyncMessage& out);
+
+// Last-writer-wins merge of remote deltas per event: the higher stamp
+// wins. Removals leave a tombstone, so an older upsert that arrives after
+// the removal cannot bring the event back.
+class DeltaMerger {
+public:
+    // True if events changed; the change is reported to listeners with
+    // origin. Cost is a hash lookup plus the incremental index update a
+    // local edit would do, whatever the calendar size.
+    bool apply(EventManager& events, const EventDelta& delta, ChangeOrigin origin);
+    // apply() for a whole batch, except that events new to the calendar
+    // are inserted together at the end, so a large pull is not one sorted
+    // insert per event. Returns how many deltas changed events.
+    size_t applyAll(EventManager& events, const std::vector<EventDelta>& deltas, ChangeOrigin origin);
+    // Removals that did not come through apply() need tombstones too,
+    // against late upserts from this merger's source
+    void noteRemove(uint64_t uid, uint64_t stamp);
+
+    size_t tombstoneCount() const { return tombstones_.size(); }
+
+private:
+    bool buried(const EventDelta& delta) const;
+
+    std::unordered_map<uint64_t, uint64_t> tombstones_;  // uid -> stamp of removal
+    std::vector<Event> inserts_;
+    std::unordered_map<uint64_t, size_t> insertIndex_;   // uid -> position in inserts_
+};
+
+} // namespace calendar
+
+#endif // EVENT_DELTA_H
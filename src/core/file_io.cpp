@@ -0,0 +1,77 @@
+#include "file_io.h"
+#include <emscripten.h>
+
+namespace calendar {
+
+void FileIO::requestFile(const char* accept) {
+    EM_ASM({
+        Module.calendarFile = null;
+        Module.calendarFileDismissed = false;
+        const input = document.createElement('input');
+        input.type = 'file';
+        input.accept = UTF8ToString($0);
+        input.oncancel = function() {
+            Module.calendarFileDismissed = true;
+        };
+        input.onchange = function() {
+            if (!input.files.length) {
+                Module.calendarFileDismissed = true;
+                return;
+            }
+            const reader = new FileReader();
+            reader.onload = function() {
+                Module.calendarFile = new Uint8Array(reader.result);
+            };
+            reader.readAsArrayBuffer(input.files[0]);
+        };
+        input.click();
+    }, accept);
+}
+
+bool FileIO::isFileReady() {
+    return EM_ASM_INT({
+        return Module.calendarFile ? 1 : 0;
+    }) != 0;
+}
+
+bool FileIO::isPickDismissed() {
+    return EM_ASM_INT({
+        return Module.calendarFileDismissed ? 1 : 0;
+    }) != 0;
+}
+
+size_t FileIO::fileSize() {
+    return (size_t)EM_ASM_DOUBLE({
+        return Module.calendarFile ? Module.calendarFile.length : 0;
+    });
+}
+
+size_t FileIO::readChunk(size_t offset, char* buffer, size_t maxLen) {
+    return (size_t)EM_ASM_DOUBLE({
+        const file = Module.calendarFile;
+        if (!file || $0 >= file.length) return 0;
+        const chunk = file.subarray($0, Math.min($0 + $2, file.length));
+        HEAPU8.set(chunk, $1);
+        return chunk.length;
+    }, (double)offset, buffer, (double)maxLen);
+}
+
+void FileIO::releaseFile() {
+    EM_ASM({
+        Module.calendarFile = null;
+    });
+}
+
+void FileIO::downloadFile(const char* filename, const char* mimeType, const std::string& data) {
+    EM_ASM({
+        const bytes = HEAPU8.slice($2, $2 + $3);
+        const blob = new Blob([bytes], { type: UTF8ToString($1) });
+        const link = document.createElement('a');
+        link.href = URL.createObjectURL(blob);
+        link.download = UTF8ToString($0);
+        link.click();
+        setTimeout(function() { URL.revokeObjectURL(link.href); }, 0);
+    }, filename, mimeType, data.data(), data.size());
+}
+
+} // namespace calendar
@@ -0,0 +1,30 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cstddef>
+#include <string>
+
+namespace calendar {
+
+// Bridge to browser file pickers and downloads. A picked file is held on the
+// JS side and copied into wasm memory one chunk at a time, so large imports
+// never need the whole file on the C++ heap. Native builds link
+// file_io_native.cpp instead, which reads and writes local files.
+class FileIO {
+public:
+    // Opens the file picker; the file becomes readable once isFileReady().
+    static void requestFile(const char* accept);
+    static bool isFileReady();
+    // True once the picker was closed without choosing a file; no file
+    // will come for this request
+    static bool isPickDismissed();
+    static size_t fileSize();
+    static size_t readChunk(size_t offset, char* buffer, size_t maxLen);
+    static void releaseFile();
+
+    static void downloadFile(const char* filename, const char* mimeType, const std::string& data);
+};
+
+} // namespace calendar
+
+#endif // FILE_IO_H
@@ -0,0 +1,59 @@
+#include "file_io.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace calendar {
+
+namespace {
+
+// There is no picker outside the browser; the "picked" file is the one
+// named by $CALENDAR_IMPORT_FILE
+FILE* g_file = nullptr;
+size_t g_fileSize = 0;
+bool g_dismissed = false;   // nothing named, or it could not be opened
+
+} // namespace
+
+void FileIO::requestFile(const char*) {
+    releaseFile();
+    const char* path = getenv("CALENDAR_IMPORT_FILE");
+    g_file = path && *path ? fopen(path, "rb") : nullptr;
+    g_dismissed = !g_file;
+    if (!g_file) return;
+    fseek(g_file, 0, SEEK_END);
+    g_fileSize = (size_t)ftell(g_file);
+}
+
+bool FileIO::isFileReady() {
+    return g_file != nullptr;
+}
+
+bool FileIO::isPickDismissed() {
+    return g_dismissed;
+}
+
+size_t FileIO::fileSize() {
+    return g_fileSize;
+}
+
+size_t FileIO::readChunk(size_t offset, char* buffer, size_t maxLen) {
+    if (!g_file || offset >= g_fileSize) return 0;
+    fseek(g_file, (long)offset, SEEK_SET);
+    return fread(buffer, 1, maxLen, g_file);
+}
+
+void FileIO::releaseFile() {
+    if (g_file) fclose(g_file);
+    g_file = nullptr;
+    g_fileSize = 0;
+}
+
+// Downloads land in the working directory
+void FileIO::downloadFile(const char* filename, const char*, const std::string& data) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return;
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+} // namespace calendar
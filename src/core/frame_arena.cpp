@@ -0,0 +1,56 @@
+#include "frame_arena.h"
+#include "memory_tracker.h"
+#include <cstdint>
+
+namespace calendar {
+
+FrameArena::FrameArena(size_t blockSize)
+    : block_(static_cast<char*>(MemoryTracker::allocate(blockSize, MEM_UI_FRAME))),
+      capacity_(blockSize), used_(0), highWater_(0), overflowBytes_(0) {}
+
+FrameArena::~FrameArena() {
+    for (char* block : overflow_) MemoryTracker::release(block);
+    MemoryTracker::release(block_);
+}
+
+FrameArena& FrameArena::frame() {
+    static FrameArena arena;
+    return arena;
+}
+
+void* FrameArena::allocate(size_t size, size_t align) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block_);
+    size_t offset = ((base + used_ + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    if (offset + size <= capacity_) {
+        used_ = offset + size;
+        return block_ + offset;
+    }
+
+    // Out of room: serve this frame from the heap and grow at the next reset.
+    // MemoryTracker blocks are max_align_t aligned, which covers align.
+    char* block = static_cast<char*>(MemoryTracker::allocate(size, MEM_UI_FRAME));
+    MEMORY_SCOPE(MEM_UI_FRAME);
+    overflow_.push_back(block);
+    overflowBytes_ += size;
+    return block;
+}
+
+void FrameArena::reset() {
+    size_t needed = used_ + overflowBytes_;
+    if (needed > highWater_) highWater_ = needed;
+
+    if (!overflow_.empty()) {
+        for (char* block : overflow_) MemoryTracker::release(block);
+        overflow_.clear();
+        // Room for the frame that overflowed plus headroom for alignment
+        size_t grown = capacity_;
+        while (grown < needed + needed / 4) grown *= 2;
+        MemoryTracker::release(block_);
+        block_ = static_cast<char*>(MemoryTracker::allocate(grown, MEM_UI_FRAME));
+        capacity_ = grown;
+    }
+    used_ = 0;
+    overflowBytes_ = 0;
+}
+
+} // namespace calendar
@@ -0,0 +1,77 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace calendar {
+
+// Linear allocator for data that lives for one frame. Allocation is a
+// pointer bump; nothing is freed individually and reset() rewinds it all.
+// When a frame overflows the block, reset() replaces it with one block big
+// enough for that frame, so steady-state frames never reach the heap.
+class FrameArena {
+public:
+    static const size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit FrameArena(size_t blockSize = kDefaultBlockSize);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+    void reset();
+
+    size_t bytesUsed() const { return used_ + overflowBytes_; }
+    size_t capacity() const { return capacity_; }
+    size_t highWater() const { return highWater_; }
+
+    // The arena main_loop resets at the top of every frame
+    static FrameArena& frame();
+
+private:
+    char* block_;
+    size_t capacity_;
+    size_t used_;
+    size_t highWater_;
+    // Blocks taken when the main block ran out; released on reset()
+    std::vector<char*> overflow_;
+    size_t overflowBytes_;
+};
+
+// std::allocator replacement that draws from a FrameArena; deallocate is a
+// no-op, so containers using it must not outlive the frame
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(FrameArena& arena) : arena_(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t count) { return arena_->allocateArray<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    FrameArena* arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+    FrameArena* arena_;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace calendar
+
+#endif // FRAME_ARENA_H
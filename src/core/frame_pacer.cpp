@@ -0,0 +1,44 @@
+#include "frame_pacer.h"
+
+namespace calendar {
+
+FramePacer::FramePacer()
+    : pendingFrames_(kSettleFrames), nextDeadlineMs_(0.0), lastRenderMs_(0.0),
+      framesRendered_(0), framesSkipped_(0) {}
+
+void FramePacer::requestFrames(int count) {
+    if (count > pendingFrames_) {
+        pendingFrames_ = count;
+    }
+}
+
+void FramePacer::requestFrameAt(double timeMs) {
+    if (nextDeadlineMs_ == 0.0 || timeMs < nextDeadlineMs_) {
+        nextDeadlineMs_ = timeMs;
+    }
+}
+
+bool FramePacer::shouldRender(double nowMs) {
+    bool render = false;
+    if (pendingFrames_ > 0) {
+        pendingFrames_--;
+        render = true;
+    }
+    if (nextDeadlineMs_ != 0.0 && nowMs >= nextDeadlineMs_) {
+        nextDeadlineMs_ = 0.0;
+        render = true;
+    }
+    if (nowMs - lastRenderMs_ >= kHeartbeatMs) {
+        render = true;
+    }
+
+    if (render) {
+        lastRenderMs_ = nowMs;
+        framesRendered_++;
+    } else {
+        framesSkipped_++;
+    }
+    return render;
+}
+
+} // namespace calendar
@@ -0,0 +1,37 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+namespace calendar {
+
+// Decides whether the main loop should build and present a frame. Input and
+// data changes request a few frames so ImGui can settle hover/click state;
+// otherwise only timer deadlines and a slow heartbeat cause a redraw.
+class FramePacer {
+public:
+    static const int kSettleFrames = 3;
+    static constexpr double kHeartbeatMs = 30000.0;
+
+    FramePacer();
+
+    void requestFrames(int count = kSettleFrames);
+    void requestFrameAt(double timeMs);
+
+    // Called once per loop iteration; consumes a pending frame if it renders
+    bool shouldRender(double nowMs);
+
+    uint64_t framesRendered() const { return framesRendered_; }
+    uint64_t framesSkipped() const { return framesSkipped_; }
+
+private:
+    int pendingFrames_;
+    double nextDeadlineMs_;   // earliest timer wake-up, 0 if none
+    double lastRenderMs_;
+    uint64_t framesRendered_;
+    uint64_t framesSkipped_;
+};
+
+} // namespace calendar
+
+#endif // FRAME_PACER_H
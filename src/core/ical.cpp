@@ -0,0 +1,444 @@
+#include "ical.h"
+#include "calendar.h"
+#include "memory_tracker.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace calendar {
+
+namespace {
+
+int parseDigits(const char* s, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        value = value * 10 + (s[i] - '0');
+    }
+    return value;
+}
+
+std::string unescapeText(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        char c = value[i];
+        if (c == '\\' && i + 1 < value.size()) {
+            char next = value[++i];
+            result += (next == 'n' || next == 'N') ? '\n' : next;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+std::string escapeText(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': result += "\\\\"; break;
+            case ';':  result += "\\;"; break;
+            case ',':  result += "\\,"; break;
+            case '\n': result += "\\n"; break;
+            default:   result += c; break;
+        }
+    }
+    return result;
+}
+
+// Parses an RFC 5545 dur-value such as "PT1H30M" or "P1D" into minutes.
+int parseDuration(const std::string& value) {
+    int minutes = 0;
+    int number = 0;
+    bool inTime = false;
+    for (char c : value) {
+        if (c >= '0' && c <= '9') {
+            number = number * 10 + (c - '0');
+            continue;
+        }
+        switch (c) {
+            case 'T': inTime = true; break;
+            case 'W': minutes += number * 7 * 24 * 60; break;
+            case 'D': minutes += number * 24 * 60; break;
+            case 'H': minutes += number * 60; break;
+            case 'M': if (inTime) minutes += number; break;
+            default: break;
+        }
+        number = 0;
+    }
+    return minutes;
+}
+
+// True if params (";NAME=VALUE;...") holds exactly this NAME=VALUE pair, so
+// VALUE=DATE does not match VALUE=DATE-TIME
+bool hasParam(const std::string& params, const char* param) {
+    size_t len = strlen(param);
+    for (size_t pos = params.find(param); pos != std::string::npos; pos = params.find(param, pos + 1)) {
+        size_t end = pos + len;
+        if (pos > 0 && params[pos - 1] == ';' && (end == params.size() || params[end] == ';' || params[end] == ':')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Exports write "<uid as 16 hex digits>@wasm-calendar"; returns 0 for any
+// other UID, which then gets a fresh uid like any imported event
+uint64_t parseOwnUid(const std::string& value) {
+    static const char kSuffix[] = "@wasm-calendar";
+    const size_t suffixLen = sizeof(kSuffix) - 1;
+    if (value.size() != 16 + suffixLen || value.compare(16, suffixLen, kSuffix) != 0) return 0;
+    uint64_t uid = 0;
+    for (size_t i = 0; i < 16; i++) {
+        char c = value[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) return 0;
+        uid = (uid << 4) | (uint64_t)digit;
+    }
+    return uid;
+}
+
+bool sameDate(int y1, int m1, int d1, int y2, int m2, int d2) {
+    return y1 == y2 && m1 == m2 && d1 == d2;
+}
+
+} // namespace
+
+ICalReader::ICalReader(TagTable* tags) : tags_(tags) {
+    reset();
+}
+
+void ICalReader::reset() {
+    partial_.clear();
+    logical_.clear();
+    hasLogical_ = false;
+    inEvent_ = false;
+    nestedDepth_ = 0;
+    inAlarm_ = false;
+    durationMinutes_ = -1;
+    start_ = DateTime();
+    end_ = DateTime();
+    current_ = Event();
+    eventsRead_ = 0;
+}
+
+size_t ICalReader::feed(const char* data, size_t len, std::vector<Event>& out) {
+    size_t before = eventsRead_;
+    const char* end = data + len;
+
+    while (data < end) {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+        if (!newline) {
+            partial_.append(data, end - data);
+            break;
+        }
+
+        if (!partial_.empty()) {
+            partial_.append(data, newline - data);
+            pushPhysicalLine(partial_.data(), partial_.size(), out);
+            partial_.clear();
+        } else {
+            pushPhysicalLine(data, newline - data, out);
+        }
+        data = newline + 1;
+    }
+    return eventsRead_ - before;
+}
+
+size_t ICalReader::finish(std::vector<Event>& out) {
+    size_t before = eventsRead_;
+    if (!partial_.empty()) {
+        pushPhysicalLine(partial_.data(), partial_.size(), out);
+        partial_.clear();
+    }
+    if (hasLogical_) {
+        processLogicalLine(out);
+        hasLogical_ = false;
+    }
+    return eventsRead_ - before;
+}
+
+void ICalReader::pushPhysicalLine(const char* data, size_t len, std::vector<Event>& out) {
+    if (len > 0 && data[len - 1] == '\r') len--;
+
+    // Unfolding: a line starting with whitespace continues the previous one
+    if (len > 0 && (data[0] == ' ' || data[0] == '\t') && hasLogical_) {
+        logical_.append(data + 1, len - 1);
+        return;
+    }
+
+    if (hasLogical_) {
+        processLogicalLine(out);
+    }
+    logical_.assign(data, len);
+    hasLogical_ = true;
+}
+
+void ICalReader::processLogicalLine(std::vector<Event>& out) {
+    // name *(";" param) ":" value, where params may hold quoted ':' characters
+    size_t nameEnd = logical_.find_first_of(";:");
+    if (nameEnd == std::string::npos) return;
+
+    size_t valueStart = nameEnd;
+    bool quoted = false;
+    for (; valueStart < logical_.size(); valueStart++) {
+        char c = logical_[valueStart];
+        if (c == '"') quoted = !quoted;
+        else if (c == ':' && !quoted) break;
+    }
+    if (valueStart >= logical_.size()) return;
+
+    std::string name = logical_.substr(0, nameEnd);
+    for (auto& c : name) {
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    }
+    std::string params = logical_.substr(nameEnd, valueStart - nameEnd);
+    std::string value = logical_.substr(valueStart + 1);
+
+    if (name == "BEGIN") {
+        if (value == "VEVENT" && !inEvent_) {
+            inEvent_ = true;
+            nestedDepth_ = 0;
+            durationMinutes_ = -1;
+            start_ = DateTime();
+            end_ = DateTime();
+            current_ = Event();
+        } else if (inEvent_) {
+            inAlarm_ = nestedDepth_ == 0 && value == "VALARM";
+            nestedDepth_++;
+        }
+    } else if (name == "END") {
+        if (!inEvent_) return;
+        if (nestedDepth_ > 0) {
+            nestedDepth_--;
+            inAlarm_ = false;
+        } else if (value == "VEVENT") {
+            finishEvent(out);
+            inEvent_ = false;
+        }
+    } else if (inEvent_ && nestedDepth_ == 0) {
+        handleProperty(name, params, value);
+    } else if (inAlarm_ && nestedDepth_ == 1 && name == "TRIGGER") {
+        handleTrigger(params, value);
+    }
+}
+
+void ICalReader::handleProperty(const std::string& name, const std::string& params, const std::string& value) {
+    MEMORY_SCOPE(MEM_TEXT);
+    if (name == "DTSTART") {
+        start_ = parseDateTime(params, value);
+    } else if (name == "DTEND") {
+        end_ = parseDateTime(params, value);
+    } else if (name == "DURATION") {
+        durationMinutes_ = parseDuration(value);
+    } else if (name == "UID") {
+        current_.uid = parseOwnUid(value);
+    } else if (name == "SUMMARY") {
+        current_.text = unescapeText(value);
+    } else if (name == "RRULE") {
+        current_.recurrence = value;
+    } else if (name == "CATEGORIES" && tags_) {
+        handleCategories(value);
+    }
+}
+
+void ICalReader::handleCategories(const std::string& value) {
+    // Comma-separated, with escaped commas inside names
+    size_t start = 0;
+    for (size_t i = 0; i <= value.size(); i++) {
+        if (i < value.size() && value[i] == '\\') {
+            i++;
+            continue;
+        }
+        if (i < value.size() && value[i] != ',') continue;
+        int bit = tags_->intern(unescapeText(value.substr(start, i - start)));
+        if (bit >= 0) current_.tags |= 1ull << bit;
+        start = i + 1;
+    }
+}
+
+void ICalReader::handleTrigger(const std::string& params, const std::string& value) {
+    // Only the first alarm, and only relative to the start; absolute and
+    // end-relative triggers are dropped
+    if (current_.reminderMinutes >= 0) return;
+    if (hasParam(params, "VALUE=DATE-TIME") || hasParam(params, "RELATED=END")) {
+        return;
+    }
+    int minutes = parseDuration(value);
+    if (!value.empty() && value[0] == '-') current_.reminderMinutes = minutes;
+    else if (minutes == 0) current_.reminderMinutes = 0;
+}
+
+void ICalReader::finishEvent(std::vector<Event>& out) {
+    if (!start_.valid) return;
+
+    current_.day = start_.day;
+    current_.month = start_.month;
+    current_.year = start_.year;
+
+    if (start_.dateOnly) {
+        current_.isAllDay = true;
+        current_.hourStart = -1;
+        current_.minuteStart = 0;
+        current_.hourEnd = -1;
+        current_.minuteEnd = 0;
+    } else {
+        current_.isAllDay = false;
+        current_.hourStart = start_.hour;
+        current_.minuteStart = start_.minute;
+
+        // Events are single-day; anything running past midnight is clipped
+        if (end_.valid && !end_.dateOnly) {
+            if (sameDate(end_.year, end_.month, end_.day, start_.year, start_.month, start_.day)) {
+                current_.hourEnd = end_.hour;
+                current_.minuteEnd = end_.minute;
+            } else {
+                current_.hourEnd = 23;
+                current_.minuteEnd = 59;
+            }
+        } else if (durationMinutes_ >= 0) {
+            int endMinutes = start_.hour * 60 + start_.minute + durationMinutes_;
+            if (endMinutes >= 24 * 60) endMinutes = 23 * 60 + 59;
+            current_.hourEnd = endMinutes / 60;
+            current_.minuteEnd = endMinutes % 60;
+        }
+    }
+
+    out.push_back(std::move(current_));
+    current_ = Event();
+    eventsRead_++;
+}
+
+ICalReader::DateTime ICalReader::parseDateTime(const std::string& params, const std::string& value) {
+    DateTime dt = {};
+    if (value.size() < 8) return dt;
+
+    const char* s = value.c_str();
+    dt.year = parseDigits(s, 4);
+    dt.month = parseDigits(s + 4, 2) - 1;
+    dt.day = parseDigits(s + 6, 2);
+    if (dt.year < 0 || dt.month < 0 || dt.month > 11 || dt.day < 1 ||
+        dt.day > CalendarLogic::getDaysInMonth(dt.month, dt.year)) {
+        return dt;
+    }
+
+    if (value.size() < 15 || value[8] != 'T' || hasParam(params, "VALUE=DATE")) {
+        dt.dateOnly = true;
+        dt.valid = true;
+        return dt;
+    }
+
+    dt.hour = parseDigits(s + 9, 2);
+    dt.minute = parseDigits(s + 11, 2);
+    if (dt.hour < 0 || dt.hour > 23 || dt.minute < 0 || dt.minute > 59) return dt;
+
+    // UTC times are shown in local wall-clock time; TZID values are taken as-is
+    if (value.size() > 15 && value[15] == 'Z') {
+        tm utc = {};
+        utc.tm_year = dt.year - 1900;
+        utc.tm_mon = dt.month;
+        utc.tm_mday = dt.day;
+        utc.tm_hour = dt.hour;
+        utc.tm_min = dt.minute;
+        time_t t = timegm(&utc);
+        tm local = {};
+        localtime_r(&t, &local);
+        dt.year = local.tm_year + 1900;
+        dt.month = local.tm_mon;
+        dt.day = local.tm_mday;
+        dt.hour = local.tm_hour;
+        dt.minute = local.tm_min;
+    }
+
+    dt.valid = true;
+    return dt;
+}
+
+ICalWriter::ICalWriter(const TagTable* tags) : tags_(tags), sequence_(0) {
+    time_t now = time(nullptr);
+    tm utc = {};
+    gmtime_r(&now, &utc);
+    strftime(stamp_, sizeof(stamp_), "%Y%m%dT%H%M%SZ", &utc);
+}
+
+void ICalWriter::writeHeader(std::string& out) {
+    out += "BEGIN:VCALENDAR\r\n";
+    out += "VERSION:2.0\r\n";
+    out += "PRODID:-//wasm-calendar//EN\r\n";
+    out += "CALSCALE:GREGORIAN\r\n";
+}
+
+void ICalWriter::writeEvent(const Event& event, std::string& out) {
+    char buffer[96];
+
+    out += "BEGIN:VEVENT\r\n";
+    // The event's own uid, so importing an export again finds the same events
+    snprintf(buffer, sizeof(buffer), "UID:%016llx@wasm-calendar\r\n", (unsigned long long)event.uid);
+    out += buffer;
+    out += "DTSTAMP:";
+    out += stamp_;
+    out += "\r\n";
+
+    if (event.isAllDay || event.hourStart == -1) {
+        snprintf(buffer, sizeof(buffer), "DTSTART;VALUE=DATE:%04d%02d%02d\r\n",
+                event.year, event.month + 1, event.day);
+        out += buffer;
+    } else {
+        snprintf(buffer, sizeof(buffer), "DTSTART:%04d%02d%02dT%02d%02d00\r\n",
+                event.year, event.month + 1, event.day, event.hourStart, event.minuteStart);
+        out += buffer;
+        if (event.hourEnd != -1) {
+            snprintf(buffer, sizeof(buffer), "DTEND:%04d%02d%02dT%02d%02d00\r\n",
+                    event.year, event.month + 1, event.day, event.hourEnd, event.minuteEnd);
+            out += buffer;
+        }
+    }
+
+    writeFolded("SUMMARY:" + escapeText(event.text), out);
+    if (!event.recurrence.empty()) {
+        writeFolded("RRULE:" + event.recurrence, out);
+    }
+    if (tags_ && event.tags) {
+        std::string categories;
+        for (int bit = 0; bit < TagTable::kMaxTags; bit++) {
+            if (!(event.tags & (1ull << bit)) || !tags_->defined(bit)) continue;
+            categories += categories.empty() ? "CATEGORIES:" : ",";
+            categories += escapeText(tags_->name(bit));
+        }
+        if (!categories.empty()) writeFolded(categories, out);
+    }
+    if (event.reminderMinutes >= 0) {
+        out += "BEGIN:VALARM\r\nACTION:DISPLAY\r\n";
+        writeFolded("DESCRIPTION:" + escapeText(event.text), out);
+        snprintf(buffer, sizeof(buffer), "TRIGGER:-PT%dM\r\nEND:VALARM\r\n", event.reminderMinutes);
+        out += buffer;
+    }
+    out += "END:VEVENT\r\n";
+    sequence_++;
+}
+
+void ICalWriter::writeFooter(std::string& out) {
+    out += "END:VCALENDAR\r\n";
+}
+
+void ICalWriter::writeFolded(const std::string& line, std::string& out) {
+    // Content lines are folded at 75 octets without splitting UTF-8 sequences
+    const size_t limit = 75;
+    size_t pos = 0;
+    size_t width = limit;
+    while (line.size() - pos > width) {
+        size_t cut = pos + width;
+        while (cut > pos && (static_cast<unsigned char>(line[cut]) & 0xC0) == 0x80) cut--;
+        out.append(line, pos, cut - pos);
+        out += "\r\n ";
+        pos = cut;
+        width = limit - 1;
+    }
+    out.append(line, pos, std::string::npos);
+    out += "\r\n";
+}
+
+} // namespace calendar
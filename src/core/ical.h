@@ -0,0 +1,81 @@
+#ifndef ICAL_H
+#define ICAL_H
+
+#include "event.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace calendar {
+
+// Incremental RFC 5545 reader. Input can be fed in arbitrarily sized chunks;
+// folded lines and lines split across chunk boundaries are reassembled, and
+// each completed VEVENT is appended to the caller's batch. With a tag
+// table, CATEGORIES become tags, naming new ones while bits are free. A UID
+// written by ICalWriter becomes the event's uid; any other is dropped.
+class ICalReader {
+public:
+    explicit ICalReader(TagTable* tags = nullptr);
+
+    // Parses the chunk and appends finished events to out.
+    // Returns the number of events appended.
+    size_t feed(const char* data, size_t len, std::vector<Event>& out);
+    // Flushes a trailing line that has no terminating newline.
+    size_t finish(std::vector<Event>& out);
+    void reset();
+
+    size_t eventsRead() const { return eventsRead_; }
+
+private:
+    void pushPhysicalLine(const char* data, size_t len, std::vector<Event>& out);
+    void processLogicalLine(std::vector<Event>& out);
+    void handleProperty(const std::string& name, const std::string& params, const std::string& value);
+    void handleTrigger(const std::string& params, const std::string& value);
+    void handleCategories(const std::string& value);
+    void finishEvent(std::vector<Event>& out);
+
+    struct DateTime {
+        int year, month, day, hour, minute;
+        bool dateOnly;
+        bool valid;
+    };
+    static DateTime parseDateTime(const std::string& params, const std::string& value);
+
+    TagTable* tags_;
+    std::string partial_;   // physical line split across chunks
+    std::string logical_;   // unfolded content line awaiting continuations
+    bool hasLogical_;
+    bool inEvent_;
+    int nestedDepth_;       // VALARM etc. inside a VEVENT
+    bool inAlarm_;          // directly inside a VALARM of the event
+    int durationMinutes_;   // -1 if no DURATION property
+    DateTime start_;
+    DateTime end_;
+    Event current_;
+    size_t eventsRead_;
+};
+
+// RFC 5545 writer. Output is appended to a caller-owned string so exports can
+// be produced a slice of events at a time. Each event's uid goes into its
+// UID. With a tag table, named tags are written as CATEGORIES.
+class ICalWriter {
+public:
+    explicit ICalWriter(const TagTable* tags = nullptr);
+
+    void writeHeader(std::string& out);
+    void writeEvent(const Event& event, std::string& out);
+    void writeFooter(std::string& out);
+
+    size_t eventsWritten() const { return sequence_; }
+
+private:
+    static void writeFolded(const std::string& line, std::string& out);
+
+    const TagTable* tags_;
+    char stamp_[20];        // DTSTAMP shared by every event of one export
+    size_t sequence_;
+};
+
+} // namespace calendar
+
+#endif // ICAL_H
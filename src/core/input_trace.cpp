@@ -0,0 +1,162 @@
+#include "input_trace.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace calendar {
+
+namespace {
+
+void appendLine(std::string& out, const char* format, ...) {
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) return;
+    out.append(buffer, len < (int)sizeof(buffer) ? len : (int)sizeof(buffer) - 1);
+    out += '\n';
+}
+
+} // namespace
+
+InputTrace::InputTrace()
+    : clockYear_(2025), clockMonth_(0), clockDay_(1), clockHour_(9), clockMinute_(0),
+      hasDataset_(false) {}
+
+void InputTrace::clear() {
+    *this = InputTrace();
+}
+
+void InputTrace::setClock(int year, int month, int day, int hour, int minute) {
+    clockYear_ = year;
+    clockMonth_ = month;
+    clockDay_ = day;
+    clockHour_ = hour;
+    clockMinute_ = minute;
+}
+
+void InputTrace::setDataset(const DatasetOptions& options) {
+    dataset_ = options;
+    hasDataset_ = true;
+}
+
+void InputTrace::addFrame(float deltaMs, float displayWidth, float displayHeight) {
+    Frame frame;
+    frame.deltaMs = deltaMs;
+    frame.displayWidth = displayWidth;
+    frame.displayHeight = displayHeight;
+    frame.firstInput = (uint32_t)inputs_.size();
+    frame.inputCount = 0;
+    frames_.push_back(frame);
+}
+
+void InputTrace::addInput(const TraceInput& input) {
+    if (frames_.empty()) return;
+    inputs_.push_back(input);
+    frames_.back().inputCount++;
+}
+
+void InputTrace::serialize(std::string& out) const {
+    out.reserve(out.size() + 96 + frames_.size() * 24 + inputs_.size() * 16);
+    appendLine(out, "trace %d", kFormatVersion);
+    appendLine(out, "clock %d %d %d %d %d", clockYear_, clockMonth_, clockDay_, clockHour_, clockMinute_);
+    if (hasDataset_) {
+        appendLine(out, "dataset %zu %s %llu %d %d", dataset_.count, distributionName(dataset_.distribution),
+                   (unsigned long long)dataset_.seed, dataset_.startYear, dataset_.years);
+    }
+    for (const Frame& frame : frames_) {
+        appendLine(out, "f %.3f %g %g", frame.deltaMs, frame.displayWidth, frame.displayHeight);
+        for (uint32_t i = frame.firstInput; i < frame.firstInput + frame.inputCount; i++) {
+            const TraceInput& input = inputs_[i];
+            switch (input.type) {
+                case TraceInput::MOUSE_POS: appendLine(out, "m %g %g", input.x, input.y); break;
+                case TraceInput::MOUSE_BUTTON: appendLine(out, "b %d %d", input.code, input.down ? 1 : 0); break;
+                case TraceInput::MOUSE_WHEEL: appendLine(out, "w %g %g", input.x, input.y); break;
+                case TraceInput::KEY: appendLine(out, "k %d %d", input.code, input.down ? 1 : 0); break;
+                case TraceInput::CHAR: appendLine(out, "c %d", input.code); break;
+                case TraceInput::FOCUS: appendLine(out, "a %d", input.down ? 1 : 0); break;
+            }
+        }
+    }
+}
+
+bool InputTrace::parse(const std::string& text) {
+    clear();
+    bool sawHeader = false;
+    size_t pos = 0;
+    char line[128];
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        size_t len = end - pos;
+        if (len >= sizeof(line)) return false;
+        memcpy(line, text.data() + pos, len);
+        line[len] = '\0';
+        pos = end + 1;
+        if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+
+        TraceInput input = {};
+        int value = 0;
+        int down = 0;
+        if (!sawHeader) {
+            if (sscanf(line, "trace %d", &value) != 1 || value != kFormatVersion) return false;
+            sawHeader = true;
+        } else if (strncmp(line, "clock ", 6) == 0) {
+            if (sscanf(line + 6, "%d %d %d %d %d", &clockYear_, &clockMonth_, &clockDay_,
+                       &clockHour_, &clockMinute_) != 5) return false;
+        } else if (strncmp(line, "dataset ", 8) == 0) {
+            unsigned long long count, seed;
+            char distribution[16];
+            if (sscanf(line + 8, "%llu %15s %llu %d %d", &count, distribution, &seed,
+                       &dataset_.startYear, &dataset_.years) != 5 ||
+                !parseDistribution(distribution, dataset_.distribution)) return false;
+            dataset_.count = (size_t)count;
+            dataset_.seed = seed;
+            hasDataset_ = true;
+        } else if (line[0] == 'f') {
+            Frame frame = {};
+            if (sscanf(line + 1, "%f %f %f", &frame.deltaMs, &frame.displayWidth, &frame.displayHeight) != 3) {
+                return false;
+            }
+            addFrame(frame.deltaMs, frame.displayWidth, frame.displayHeight);
+        } else if (frames_.empty()) {
+            return false;
+        } else {
+            switch (line[0]) {
+                case 'm':
+                    input.type = TraceInput::MOUSE_POS;
+                    if (sscanf(line + 1, "%f %f", &input.x, &input.y) != 2) return false;
+                    break;
+                case 'b':
+                    input.type = TraceInput::MOUSE_BUTTON;
+                    if (sscanf(line + 1, "%d %d", &input.code, &down) != 2) return false;
+                    break;
+                case 'w':
+                    input.type = TraceInput::MOUSE_WHEEL;
+                    if (sscanf(line + 1, "%f %f", &input.x, &input.y) != 2) return false;
+                    break;
+                case 'k':
+                    input.type = TraceInput::KEY;
+                    if (sscanf(line + 1, "%d %d", &input.code, &down) != 2) return false;
+                    break;
+                case 'c':
+                    input.type = TraceInput::CHAR;
+                    if (sscanf(line + 1, "%d", &input.code) != 1) return false;
+                    break;
+                case 'a':
+                    input.type = TraceInput::FOCUS;
+                    if (sscanf(line + 1, "%d", &down) != 1) return false;
+                    break;
+                default:
+                    return false;
+            }
+            input.down = down != 0;
+            addInput(input);
+        }
+    }
+    return sawHeader;
+}
+
+} // namespace calendar
@@ -0,0 +1,89 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include "synthetic.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace calendar {
+
+// One input event as ImGui received it. Codes are ImGui's own values
+// (ImGuiMouseButton, ImGuiKey, Unicode code point).
+struct TraceInput {
+    enum Type : uint8_t {
+        MOUSE_POS,      // x, y
+        MOUSE_BUTTON,   // code, down
+        MOUSE_WHEEL,    // x, y
+        KEY,            // code, down
+        CHAR,           // code
+        FOCUS           // down = focused
+    };
+    Type type;
+    bool down;
+    int code;
+    float x, y;
+};
+
+// A recorded session: the clock it started at, optionally the synthetic
+// calendar it ran against, and per rendered frame the delta time, display
+// size and the inputs queued for that frame.
+//
+// Stored as text, one record per line:
+//   trace 1
+//   clock <year> <month> <day> <hour> <minute>
+//   dataset <count> <distribution> <seed> <startYear> <years>
+//   f <deltaMs> <width> <height>
+//   m <x> <y> | b <button> <0|1> | w <x> <y> | k <key> <0|1> | c <char> | a <0|1>
+// Lines starting with # are comments.
+class InputTrace {
+public:
+    static const int kFormatVersion = 1;
+
+    struct Frame {
+        float deltaMs;
+        float displayWidth;
+        float displayHeight;
+        uint32_t firstInput;
+        uint32_t inputCount;
+    };
+
+    InputTrace();
+
+    void clear();
+    void setClock(int year, int month, int day, int hour, int minute);
+    // Without a dataset the trace replays against whatever events are loaded
+    void setDataset(const DatasetOptions& options);
+
+    void addFrame(float deltaMs, float displayWidth, float displayHeight);
+    // Appends to the last frame added
+    void addInput(const TraceInput& input);
+
+    int clockYear() const { return clockYear_; }
+    int clockMonth() const { return clockMonth_; }
+    int clockDay() const { return clockDay_; }
+    int clockHour() const { return clockHour_; }
+    int clockMinute() const { return clockMinute_; }
+    bool hasDataset() const { return hasDataset_; }
+    const DatasetOptions& dataset() const { return dataset_; }
+
+    size_t frameCount() const { return frames_.size(); }
+    const Frame& frame(size_t i) const { return frames_[i]; }
+    const TraceInput& input(size_t i) const { return inputs_[i]; }
+
+    void serialize(std::string& out) const;
+    // Returns false on a malformed or unsupported trace
+    bool parse(const std::string& text);
+
+private:
+    int clockYear_, clockMonth_, clockDay_, clockHour_, clockMinute_;
+    bool hasDataset_;
+    DatasetOptions dataset_;
+    std::vector<Frame> frames_;
+    std::vector<TraceInput> inputs_;
+};
+
+} // namespace calendar
+
+#endif // INPUT_TRACE_H
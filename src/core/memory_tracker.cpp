@@ -0,0 +1,150 @@
+#include "memory_tracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#ifdef __EMSCRIPTEN__
+#include <emscripten/heap.h>
+#endif
+
+namespace calendar {
+
+namespace {
+
+// Every tracked block carries its size and tag just before the pointer
+// handed out; the header keeps the caller's block maximally aligned.
+struct BlockHeader {
+    size_t size;
+    uint32_t tag;
+};
+const size_t kHeaderSize = 16;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header too large");
+static_assert(alignof(std::max_align_t) <= kHeaderSize, "block header breaks alignment");
+
+struct AtomicStats {
+    std::atomic<int64_t> liveBytes;
+    std::atomic<int64_t> liveAllocations;
+    std::atomic<int64_t> peakBytes;
+    std::atomic<uint64_t> totalAllocations;
+};
+
+// Constant-initialised, so allocations made during static initialisation
+// are counted safely
+AtomicStats g_stats[MEM_TAG_COUNT];
+std::atomic<uint64_t> g_totalAllocations(0);
+thread_local MemoryTag t_currentTag = MEM_UNTAGGED;
+
+const char* const kTagNames[MEM_TAG_COUNT] = {
+    "untagged", "events", "text", "indexes", "storage", "ui_frame", "ui_caches", "imgui"
+};
+
+} // namespace
+
+void* MemoryTracker::allocate(size_t size, MemoryTag tag) {
+    char* raw = static_cast<char*>(malloc(kHeaderSize + size));
+    if (!raw) return nullptr;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(raw);
+    header->size = size;
+    header->tag = (uint32_t)tag;
+
+    AtomicStats& stats = g_stats[tag];
+    int64_t live = stats.liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+    int64_t peak = stats.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !stats.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    stats.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    stats.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    g_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    return raw + kHeaderSize;
+}
+
+void MemoryTracker::release(void* ptr) {
+    if (!ptr) return;
+    char* raw = static_cast<char*>(ptr) - kHeaderSize;
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(raw);
+    AtomicStats& stats = g_stats[header->tag];
+    stats.liveBytes.fetch_sub((int64_t)header->size, std::memory_order_relaxed);
+    stats.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    free(raw);
+}
+
+MemoryTag MemoryTracker::currentTag() {
+    return t_currentTag;
+}
+
+MemoryTag MemoryTracker::swapTag(MemoryTag tag) {
+    MemoryTag previous = t_currentTag;
+    t_currentTag = tag;
+    return previous;
+}
+
+MemoryTracker::TagStats MemoryTracker::stats(MemoryTag tag) {
+    const AtomicStats& stats = g_stats[tag];
+    TagStats result;
+    result.liveBytes = stats.liveBytes.load(std::memory_order_relaxed);
+    result.liveAllocations = stats.liveAllocations.load(std::memory_order_relaxed);
+    result.peakBytes = stats.peakBytes.load(std::memory_order_relaxed);
+    result.totalAllocations = stats.totalAllocations.load(std::memory_order_relaxed);
+    return result;
+}
+
+const char* MemoryTracker::tagName(MemoryTag tag) {
+    return kTagNames[tag];
+}
+
+uint64_t MemoryTracker::totalAllocations() {
+    return g_totalAllocations.load(std::memory_order_relaxed);
+}
+
+int64_t MemoryTracker::liveBytes() {
+    int64_t total = 0;
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        total += g_stats[tag].liveBytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t MemoryTracker::heapSize() {
+#ifdef __EMSCRIPTEN__
+    return emscripten_get_heap_size();
+#else
+    return 0;
+#endif
+}
+
+void MemoryTracker::writeJSON(std::string& out, size_t eventCount) {
+    char buffer[192];
+    snprintf(buffer, sizeof(buffer), "{\"heapBytes\":%zu,\"trackedBytes\":%lld,\"events\":%zu,\"tags\":{",
+             heapSize(), (long long)liveBytes(), eventCount);
+    out += buffer;
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        TagStats tagStats = stats((MemoryTag)tag);
+        snprintf(buffer, sizeof(buffer),
+                 "%s\"%s\":{\"liveBytes\":%lld,\"liveAllocations\":%lld,\"peakBytes\":%lld,\"totalAllocations\":%llu}",
+                 tag > 0 ? "," : "", kTagNames[tag], (long long)tagStats.liveBytes,
+                 (long long)tagStats.liveAllocations, (long long)tagStats.peakBytes,
+                 (unsigned long long)tagStats.totalAllocations);
+        out += buffer;
+    }
+    out += "}}";
+}
+
+} // namespace calendar
+
+namespace {
+
+void* trackedNew(size_t size) {
+    void* ptr = calendar::MemoryTracker::allocate(size, calendar::MemoryTracker::currentTag());
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+} // namespace
+
+// Replacing the global operators is the only way to see allocations made by
+// the standard library; ImGui is routed here through SetAllocatorFunctions.
+void* operator new(size_t size) { return trackedNew(size); }
+void* operator new[](size_t size) { return trackedNew(size); }
+void operator delete(void* ptr) noexcept { calendar::MemoryTracker::release(ptr); }
+void operator delete[](void* ptr) noexcept { calendar::MemoryTracker::release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { calendar::MemoryTracker::release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { calendar::MemoryTracker::release(ptr); }
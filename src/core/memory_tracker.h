@@ -0,0 +1,72 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace calendar {
+
+// Subsystem a heap allocation is charged to. Code marks what it is doing
+// with MEMORY_SCOPE; anything allocated outside a scope is untagged.
+enum MemoryTag {
+    MEM_UNTAGGED,
+    MEM_EVENTS,      // EventManager's event array
+    MEM_TEXT,        // event descriptions and formatted labels
+    MEM_INDEXES,     // day and chronological indexes
+    MEM_STORAGE,     // JSON and .ics serialisation buffers
+    MEM_UI_FRAME,    // temporaries built while rendering a frame
+    MEM_UI_CACHES,   // grid geometry and labels kept across frames
+    MEM_IMGUI,       // everything ImGui allocates through its allocator hooks
+    MEM_TAG_COUNT
+};
+
+// Live and cumulative heap usage per tag, fed by the replaced global
+// operator new/delete and by ImGui's allocator functions.
+class MemoryTracker {
+public:
+    struct TagStats {
+        int64_t liveBytes;
+        int64_t liveAllocations;
+        int64_t peakBytes;
+        uint64_t totalAllocations;
+    };
+
+    static void* allocate(size_t size, MemoryTag tag);
+    static void release(void* ptr);
+
+    static MemoryTag currentTag();
+    static MemoryTag swapTag(MemoryTag tag);   // returns the previous tag
+
+    static TagStats stats(MemoryTag tag);
+    static const char* tagName(MemoryTag tag);
+    static uint64_t totalAllocations();
+    static int64_t liveBytes();
+
+    // Size of the wasm linear memory; it never shrinks, so this is also its
+    // high-water mark. 0 on native builds.
+    static size_t heapSize();
+
+    // {"heapBytes":..,"tags":{"events":{...},...}} for offline comparison
+    static void writeJSON(std::string& out, size_t eventCount);
+};
+
+class MemoryScope {
+public:
+    explicit MemoryScope(MemoryTag tag) : previous_(MemoryTracker::swapTag(tag)) {}
+    ~MemoryScope() { MemoryTracker::swapTag(previous_); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryTag previous_;
+};
+
+#define MEMORY_SCOPE_CONCAT_INNER(a, b) a##b
+#define MEMORY_SCOPE_CONCAT(a, b) MEMORY_SCOPE_CONCAT_INNER(a, b)
+#define MEMORY_SCOPE(tag) calendar::MemoryScope MEMORY_SCOPE_CONCAT(memoryScope_, __LINE__)(tag)
+
+} // namespace calendar
+
+#endif // MEMORY_TRACKER_H
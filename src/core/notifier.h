@@ -0,0 +1,21 @@
+#ifndef NOTIFIER_H
+#define NOTIFIER_H
+
+namespace calendar {
+
+// System notifications for reminders, for when the page is not in view.
+// The browser build links notifier_web.cpp (the Notification API); native
+// builds link notifier_native.cpp, which has nothing to show them with.
+class Notifier {
+public:
+    // Asks for permission once, on a user action; later calls do nothing
+    static void requestPermission();
+    // Shown only while the page is hidden; a visible page shows its own
+    // toast. Tabs pass the same tag for the same reminder, so the browser
+    // shows it once however many tabs fire it.
+    static void show(const char* title, const char* body, const char* tag);
+};
+
+} // namespace calendar
+
+#endif // NOTIFIER_H
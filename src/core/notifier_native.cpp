@@ -0,0 +1,9 @@
+#include "notifier.h"
+
+namespace calendar {
+
+void Notifier::requestPermission() {}
+
+void Notifier::show(const char*, const char*, const char*) {}
+
+} // namespace calendar
@@ -0,0 +1,21 @@
+#include "notifier.h"
+#include <emscripten.h>
+
+namespace calendar {
+
+void Notifier::requestPermission() {
+    EM_ASM({
+        if (typeof Notification === 'undefined' || Notification.permission !== 'default') return;
+        Notification.requestPermission();
+    });
+}
+
+void Notifier::show(const char* title, const char* body, const char* tag) {
+    EM_ASM({
+        if (typeof Notification === 'undefined' || Notification.permission !== 'granted') return;
+        if (document.visibilityState !== 'hidden') return;
+        new Notification(UTF8ToString($0), {body: UTF8ToString($1), tag: UTF8ToString($2)});
+    }, title, body, tag);
+}
+
+} // namespace calendar
@@ -0,0 +1,184 @@
+#include "persistence_worker.h"
+#include "memory_tracker.h"
+#include "storage.h"
+#ifdef __EMSCRIPTEN__
+#include <emscripten/threading.h>
+#endif
+
+namespace calendar {
+
+PersistenceWorker& PersistenceWorker::instance() {
+    static PersistenceWorker worker;
+    return worker;
+}
+
+PersistenceWorker::PersistenceWorker()
+    : pendingJobs_(0), running_(false), loading_(false), loadRevision_(0), exited_(false),
+      stopping_(false) {}
+
+PersistenceWorker::~PersistenceWorker() {
+    stop();
+}
+
+bool PersistenceWorker::start() {
+    if (running_) return true;
+#ifdef CALENDAR_THREADS
+#ifdef __EMSCRIPTEN__
+    // The page only loads the threaded build when cross-origin isolated,
+    // but SharedArrayBuffer can still be missing (e.g. disabled by policy)
+    if (!emscripten_has_threading_support()) return false;
+#endif
+    stopping_ = false;
+    exited_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&PersistenceWorker::run, this);
+    running_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PersistenceWorker::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+
+    // The worker may be waiting for room in results_, so keep draining
+    // until it has finished the queue; loaded calendars have nowhere to go
+    Result result;
+    for (;;) {
+        bool exited = exited_.load(std::memory_order_acquire);
+        while (results_.pop(result)) {
+            if (result.type == JOB_SAVE) StorageManager::writeStoredJSON(result.json);
+        }
+        if (exited) break;
+        std::this_thread::yield();
+    }
+    thread_.join();
+    running_ = false;
+}
+
+bool PersistenceWorker::save(const std::vector<Event>& events) {
+    if (!running_) return false;
+    if (loading_) return true;
+    Job job;
+    job.type = JOB_SAVE;
+    {
+        MEMORY_SCOPE(MEM_STORAGE);
+        job.events = events;
+    }
+    return submit(job);
+}
+
+bool PersistenceWorker::loadFromStorage(const EventManager& events) {
+    if (!running_) return false;
+    Job job;
+    job.type = JOB_LOAD;
+    {
+        MEMORY_SCOPE(MEM_STORAGE);
+        if (!StorageManager::readStoredJSON(job.json)) return true;
+    }
+    if (!submit(job)) return false;
+    loading_ = true;
+    loadRevision_ = events.getRevision();
+    return true;
+}
+
+bool PersistenceWorker::poll(EventManager& events) {
+    bool changed = false;
+    Result result;
+    while (results_.pop(result)) {
+        if (result.type == JOB_SAVE) {
+            StorageManager::writeStoredJSON(result.json);
+        } else if (result.type == JOB_LOAD) {
+            // Events added or synced from other tabs or the server before the stored
+            // calendar arrived were never saved; carry them over, newest
+            // stamp winning
+            bool edited = events.getRevision() != loadRevision_;
+            if (edited) {
+                for (const Event& evt : events.getAllEvents()) {
+                    Event* stored = result.loaded->findByUid(evt.uid);
+                    if (!stored || stored->stamp < evt.stamp) result.loaded->applyUpsert(evt, CHANGE_LOCAL);
+                }
+            }
+            events.replaceWith(*result.loaded);
+            loading_ = false;
+            changed = true;
+            // Same one-time migration as StorageManager::loadEventsFromStorage,
+            // and the same refusal to save over a payload it could not read
+            if (result.version < 0) {
+                StorageManager::keepStoredPayload();
+            } else if (edited || result.assigned || result.version < StorageManager::kSchemaVersion) {
+                StorageManager::saveEventsToStorage(events.getAllEvents());
+            }
+        }
+        // Free the payload now rather than when the slot is next reused
+        result = Result();
+    }
+    return changed;
+}
+
+bool PersistenceWorker::submit(Job& job) {
+    pendingJobs_.fetch_add(1, std::memory_order_acq_rel);
+    if (!jobs_.push(job)) {
+        pendingJobs_.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    // Taking the mutex orders the push before the worker's empty() check,
+    // so the wake-up cannot be lost
+    { std::lock_guard<std::mutex> lock(wakeMutex_); }
+    wake_.notify_one();
+    return true;
+}
+
+void PersistenceWorker::publish(Result& result) {
+    while (!results_.push(result)) std::this_thread::yield();
+}
+
+void PersistenceWorker::run() {
+    Job job;
+    Job latestSave;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_ && jobs_.empty()) break;
+        }
+
+        int taken = 0;
+        bool haveSave = false;
+        while (jobs_.pop(job)) {
+            taken++;
+            if (job.type == JOB_SAVE) {
+                // Only the newest snapshot matters
+                latestSave = std::move(job);
+                haveSave = true;
+            } else if (job.type == JOB_LOAD) {
+                Result result;
+                result.type = JOB_LOAD;
+                std::vector<Event> parsed;
+                result.version = StorageManager::parseFromJSON(job.json, parsed);
+                job.json = std::string();
+                result.assigned = StorageManager::lacksIdentity(parsed);
+                result.loaded.reset(new EventManager());
+                result.loaded->addEvents(parsed);
+                publish(result);
+            }
+        }
+        if (haveSave) {
+            MEMORY_SCOPE(MEM_STORAGE);
+            Result result;
+            result.type = JOB_SAVE;
+            result.json = StorageManager::serializeToJSON(latestSave.events);
+            latestSave.events = std::vector<Event>();
+            publish(result);
+        }
+        pendingJobs_.fetch_sub(taken, std::memory_order_acq_rel);
+    }
+    exited_.store(true, std::memory_order_release);
+}
+
+} // namespace calendar
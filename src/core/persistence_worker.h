@@ -0,0 +1,97 @@
+#ifndef PERSISTENCE_WORKER_H
+#define PERSISTENCE_WORKER_H
+
+#include "event.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace calendar {
+
+// Background thread that owns JSON serialisation, parsing and the index
+// build for a loaded calendar. The UI thread hands over event snapshots and
+// stored payloads through one SPSC queue and collects finished work from
+// another in poll(); storage itself is only touched on the UI thread, since
+// localStorage does not exist inside a web worker.
+//
+// Only builds compiled with CALENDAR_THREADS (the -pthread web variant and
+// native builds) have a thread to start. Everywhere else start() returns
+// false and StorageManager keeps doing the work inline.
+class PersistenceWorker {
+public:
+    static PersistenceWorker& instance();
+
+    // False when threads are unavailable; callers then stay single-threaded
+    bool start();
+    // Finishes queued work, writes any last save and joins the thread
+    void stop();
+    bool running() const { return running_; }
+
+    // Copies the events; bursts of saves are coalesced into the newest one.
+    // False if not running or the queue is full; the caller saves inline.
+    // While a load is in flight saves are dropped, so the stored calendar
+    // is not overwritten before it has been read back.
+    bool save(const std::vector<Event>& events);
+    // Reads the stored payload here, then parses and indexes it on the
+    // worker; the calendar replaces events in a later poll(), keeping any
+    // events added meanwhile. False if the worker cannot take the job, in
+    // which case the caller loads inline.
+    bool loadFromStorage(const EventManager& events);
+
+    // Once per main loop iteration on the UI thread: writes finished saves
+    // and swaps a loaded calendar into events. True if events changed.
+    bool poll(EventManager& events);
+    // A loaded calendar has yet to be swapped in
+    bool loading() const { return loading_; }
+    bool busy() const { return pendingJobs_.load(std::memory_order_acquire) > 0 || !results_.empty(); }
+
+private:
+    static const size_t kQueueSize = 16;
+
+    enum JobType { JOB_NONE, JOB_SAVE, JOB_LOAD };
+
+    struct Job {
+        JobType type = JOB_NONE;
+        std::vector<Event> events;  // JOB_SAVE
+        std::string json;           // JOB_LOAD
+    };
+
+    struct Result {
+        JobType type = JOB_NONE;
+        std::string json;                       // JOB_SAVE: payload to write
+        std::unique_ptr<EventManager> loaded;   // JOB_LOAD
+        int version = -1;
+        bool assigned = false;                  // JOB_LOAD: uids or stamps handed out
+    };
+
+    PersistenceWorker();
+    ~PersistenceWorker();
+
+    bool submit(Job& job);
+    void run();
+    void publish(Result& result);
+
+    SpscQueue<Job, kQueueSize> jobs_;       // UI -> worker
+    SpscQueue<Result, kQueueSize> results_; // worker -> UI
+    std::atomic<int> pendingJobs_;  // submitted but not yet turned into results
+    bool running_;
+    bool loading_;
+    uint64_t loadRevision_;     // of the UI's events when the load was queued
+    std::atomic<bool> exited_;
+    std::thread thread_;
+
+    // Only for sleeping while idle; the queues themselves are lock-free
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+};
+
+} // namespace calendar
+
+#endif // PERSISTENCE_WORKER_H
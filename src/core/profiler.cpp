@@ -0,0 +1,121 @@
+#include "profiler.h"
+#include "memory_tracker.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace calendar {
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : enabled_(false), inFrame_(false), frameStartMs_(0.0), frameStartAllocs_(0),
+      numSections_(0), numCounters_(0), historyNext_(0), historyCount_(0),
+      traceNext_(0), traceCount_(0) {
+    memset(&current_, 0, sizeof(current_));
+}
+
+uint64_t Profiler::allocationCount() {
+    return MemoryTracker::totalAllocations();
+}
+
+double Profiler::nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (enabled == enabled_) return;
+    enabled_ = enabled;
+    // Start from a clean slate so old frames don't skew the percentiles
+    inFrame_ = false;
+    historyNext_ = historyCount_ = 0;
+    traceNext_ = traceCount_ = 0;
+    memset(&current_, 0, sizeof(current_));
+}
+
+int Profiler::sectionId(const char* name) {
+    for (int i = 0; i < numSections_; i++) {
+        if (strcmp(sectionNames_[i], name) == 0) return i;
+    }
+    // Out of slots: share the last one rather than fail
+    if (numSections_ == kMaxSections) return kMaxSections - 1;
+    sectionNames_[numSections_] = name;
+    return numSections_++;
+}
+
+int Profiler::counterId(const char* name) {
+    for (int i = 0; i < numCounters_; i++) {
+        if (strcmp(counterNames_[i], name) == 0) return i;
+    }
+    if (numCounters_ == kMaxCounters) return kMaxCounters - 1;
+    counterNames_[numCounters_] = name;
+    return numCounters_++;
+}
+
+void Profiler::beginFrame() {
+    if (!enabled_) return;
+    inFrame_ = true;
+    frameStartMs_ = nowMs();
+    frameStartAllocs_ = allocationCount();
+}
+
+void Profiler::endFrame() {
+    if (!enabled_ || !inFrame_) return;
+    inFrame_ = false;
+    current_.frameMs = (float)(nowMs() - frameStartMs_);
+    current_.frameAllocs = (uint32_t)(allocationCount() - frameStartAllocs_);
+
+    history_[historyNext_] = current_;
+    historyNext_ = (historyNext_ + 1) % kHistoryFrames;
+    if (historyCount_ < kHistoryFrames) historyCount_++;
+    memset(&current_, 0, sizeof(current_));
+}
+
+void Profiler::endSection(int id, double startMs, uint64_t startAllocs) {
+    double endMs = nowMs();
+    current_.sectionMs[id] += (float)(endMs - startMs);
+    current_.sectionCalls[id]++;
+    current_.sectionAllocs[id] += (uint32_t)(allocationCount() - startAllocs);
+
+    TraceEvent& event = trace_[traceNext_];
+    event.section = id;
+    event.startMs = startMs;
+    event.durationMs = endMs - startMs;
+    traceNext_ = (traceNext_ + 1) % kMaxTraceEvents;
+    if (traceCount_ < kMaxTraceEvents) traceCount_++;
+}
+
+const Profiler::FrameRecord& Profiler::history(int i) const {
+    int oldest = historyCount_ < kHistoryFrames ? 0 : historyNext_;
+    return history_[(oldest + i) % kHistoryFrames];
+}
+
+void Profiler::writeChromeTrace(std::string& out) const {
+    int oldest = traceCount_ < kMaxTraceEvents ? 0 : traceNext_;
+    // Events are stored as they end, so an enclosing scope can start before
+    // the oldest entry; timestamps are relative to the earliest start
+    double originMs = 0.0;
+    for (int i = 0; i < traceCount_; i++) {
+        double startMs = trace_[(oldest + i) % kMaxTraceEvents].startMs;
+        if (i == 0 || startMs < originMs) originMs = startMs;
+    }
+
+    out.reserve(out.size() + 32 + (size_t)traceCount_ * 96);
+    out += "{\"traceEvents\":[";
+    char buffer[192];
+    for (int i = 0; i < traceCount_; i++) {
+        const TraceEvent& event = trace_[(oldest + i) % kMaxTraceEvents];
+        int len = snprintf(buffer, sizeof(buffer),
+                           "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                           i > 0 ? "," : "", sectionNames_[event.section],
+                           (event.startMs - originMs) * 1000.0, event.durationMs * 1000.0);
+        out.append(buffer, len < (int)sizeof(buffer) ? len : (int)sizeof(buffer) - 1);
+    }
+    out += "],\"displayTimeUnit\":\"ms\"}";
+}
+
+} // namespace calendar
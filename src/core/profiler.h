@@ -0,0 +1,124 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace calendar {
+
+// Frame profiler: named scoped timers and counters, recorded per frame into
+// a ring buffer. Always compiled in; while disabled a scope costs one branch.
+class Profiler {
+public:
+    static const int kMaxSections = 32;
+    static const int kMaxCounters = 16;
+    static const int kHistoryFrames = 240;
+    static const int kMaxTraceEvents = 16384;
+
+    struct FrameRecord {
+        float frameMs;
+        uint32_t frameAllocs;
+        float sectionMs[kMaxSections];
+        uint32_t sectionCalls[kMaxSections];
+        uint32_t sectionAllocs[kMaxSections];
+        int64_t counters[kMaxCounters];
+    };
+
+    static Profiler& instance();
+
+    bool enabled() const { return enabled_; }
+    void setEnabled(bool enabled);
+
+    // Registers a name once and returns its slot; PROFILE_SCOPE and
+    // PROFILE_COUNT cache the result in a function-local static
+    int sectionId(const char* name);
+    int counterId(const char* name);
+
+    void beginFrame();
+    void endFrame();
+
+    void endSection(int id, double startMs, uint64_t startAllocs);
+    void count(int id, int64_t delta) { if (enabled_) current_.counters[id] += delta; }
+
+    // Tracked heap allocations since startup
+    static uint64_t allocationCount();
+    static double nowMs();
+
+    int sectionCount() const { return numSections_; }
+    int counterCount() const { return numCounters_; }
+    const char* sectionName(int id) const { return sectionNames_[id]; }
+    const char* counterName(int id) const { return counterNames_[id]; }
+
+    // Completed frames, oldest first
+    int historySize() const { return historyCount_; }
+    const FrameRecord& history(int i) const;
+
+    // Chrome trace-event JSON ("ph":"X" complete events) for chrome://tracing
+    void writeChromeTrace(std::string& out) const;
+
+private:
+    Profiler();
+
+    struct TraceEvent {
+        int section;
+        double startMs;
+        double durationMs;
+    };
+
+    bool enabled_;
+    bool inFrame_;
+    double frameStartMs_;
+    uint64_t frameStartAllocs_;
+    FrameRecord current_;
+
+    const char* sectionNames_[kMaxSections];
+    const char* counterNames_[kMaxCounters];
+    int numSections_;
+    int numCounters_;
+
+    FrameRecord history_[kHistoryFrames];
+    int historyNext_;
+    int historyCount_;
+
+    TraceEvent trace_[kMaxTraceEvents];
+    int traceNext_;
+    int traceCount_;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(int id) : id_(id), active_(Profiler::instance().enabled()) {
+        if (active_) {
+            startMs_ = Profiler::nowMs();
+            startAllocs_ = Profiler::allocationCount();
+        }
+    }
+    ~ProfileScope() {
+        if (active_) Profiler::instance().endSection(id_, startMs_, startAllocs_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int id_;
+    bool active_;
+    double startMs_;
+    uint64_t startAllocs_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profileId_, __LINE__) = calendar::Profiler::instance().sectionId(name); \
+    calendar::ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileId_, __LINE__))
+#define PROFILE_COUNT(name, delta) \
+    do { \
+        static const int profileCounterId = calendar::Profiler::instance().counterId(name); \
+        calendar::Profiler::instance().count(profileCounterId, (delta)); \
+    } while (0)
+
+} // namespace calendar
+
+#endif // PROFILER_H
@@ -0,0 +1,168 @@
+#include "recurrence.h"
+#include "calendar.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace calendar {
+
+namespace {
+
+// Past this many periods without an occurrence a rule is treated as ended
+const int kMaxPeriods = 5000;
+
+const char* const kWeekdays[7] = {"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+
+int floorDiv(int a, int b) {
+    int q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Monday = 0, as in CalendarLogic::getDayOfWeek, without the date round trip
+int weekdayOf(int dayNumber) {
+    int weekday = (dayNumber + 3) % 7;
+    return weekday < 0 ? weekday + 7 : weekday;
+}
+
+int monthIndexOf(int dayNumber) {
+    int day, month, year;
+    CalendarLogic::fromDayNumber(dayNumber, day, month, year);
+    return year * 12 + month;
+}
+
+} // namespace
+
+RecurrenceRule::RecurrenceRule()
+    : frequency_(FREQ_NONE), interval_(1), count_(-1), untilDay_(-1), byDay_(0), byMonthDay_(0) {}
+
+bool RecurrenceRule::parse(const std::string& rrule) {
+    *this = RecurrenceRule();
+    size_t pos = 0;
+    while (pos < rrule.size()) {
+        size_t end = rrule.find(';', pos);
+        if (end == std::string::npos) end = rrule.size();
+        size_t eq = rrule.find('=', pos);
+        if (eq != std::string::npos && eq < end) {
+            std::string name = rrule.substr(pos, eq - pos);
+            std::string value = rrule.substr(eq + 1, end - eq - 1);
+            if (name == "FREQ") {
+                if (value == "DAILY") frequency_ = FREQ_DAILY;
+                else if (value == "WEEKLY") frequency_ = FREQ_WEEKLY;
+                else if (value == "MONTHLY") frequency_ = FREQ_MONTHLY;
+                else if (value == "YEARLY") frequency_ = FREQ_YEARLY;
+            } else if (name == "INTERVAL") {
+                interval_ = atoi(value.c_str());
+                if (interval_ < 1) interval_ = 1;
+            } else if (name == "COUNT") {
+                count_ = atoi(value.c_str());
+            } else if (name == "UNTIL" && value.size() >= 8) {
+                // The date is enough; occurrences are whole days here
+                int year = atoi(value.substr(0, 4).c_str());
+                int month = atoi(value.substr(4, 2).c_str()) - 1;
+                int day = atoi(value.substr(6, 2).c_str());
+                untilDay_ = CalendarLogic::toDayNumber(day, month, year);
+            } else if (name == "BYDAY") {
+                // Ordinals ("2TU") only mean something in monthly rules
+                for (int i = 0; i < 7; i++) {
+                    if (value.find(kWeekdays[i]) != std::string::npos) byDay_ |= (uint8_t)(1 << i);
+                }
+            } else if (name == "BYMONTHDAY") {
+                for (const char* p = value.c_str(); *p;) {
+                    int day = atoi(p);
+                    if (day >= 1 && day <= 31) byMonthDay_ |= 1u << day;
+                    const char* comma = strchr(p, ',');
+                    if (!comma) break;
+                    p = comma + 1;
+                }
+            }
+        }
+        pos = end + 1;
+    }
+    return frequency_ != FREQ_NONE;
+}
+
+int RecurrenceRule::periodOf(int startDay, int day) const {
+    switch (frequency_) {
+        case FREQ_DAILY:
+            return floorDiv(day - startDay, interval_);
+        case FREQ_WEEKLY:
+            return floorDiv(day - (startDay - weekdayOf(startDay)), 7 * interval_);
+        case FREQ_MONTHLY:
+            return floorDiv(monthIndexOf(day) - monthIndexOf(startDay), interval_);
+        case FREQ_YEARLY:
+            return floorDiv(monthIndexOf(day) / 12 - monthIndexOf(startDay) / 12, interval_);
+        default:
+            return 0;
+    }
+}
+
+int RecurrenceRule::daysOfPeriod(int startDay, int k, int* days) const {
+    int count = 0;
+    switch (frequency_) {
+        case FREQ_DAILY:
+            days[count++] = startDay + k * interval_;
+            break;
+        case FREQ_WEEKLY: {
+            int base = startDay - weekdayOf(startDay) + k * 7 * interval_;
+            uint8_t mask = byDay_ ? byDay_ : (uint8_t)(1 << weekdayOf(startDay));
+            for (int weekday = 0; weekday < 7; weekday++) {
+                if (mask & (1 << weekday)) days[count++] = base + weekday;
+            }
+            break;
+        }
+        case FREQ_MONTHLY: {
+            int startDom, startMonth, startYear;
+            CalendarLogic::fromDayNumber(startDay, startDom, startMonth, startYear);
+            int index = startYear * 12 + startMonth + k * interval_;
+            int year = floorDiv(index, 12);
+            int month = index - year * 12;
+            int daysInMonth = CalendarLogic::getDaysInMonth(month, year);
+            uint32_t mask = byMonthDay_ ? byMonthDay_ : 1u << startDom;
+            // Months too short for the day are skipped, as RFC 5545 says
+            for (int dom = 1; dom <= daysInMonth; dom++) {
+                if (mask & (1u << dom)) days[count++] = CalendarLogic::toDayNumber(dom, month, year);
+            }
+            break;
+        }
+        case FREQ_YEARLY: {
+            int startDom, startMonth, startYear;
+            CalendarLogic::fromDayNumber(startDay, startDom, startMonth, startYear);
+            int year = startYear + k * interval_;
+            if (startDom <= CalendarLogic::getDaysInMonth(startMonth, year)) {
+                days[count++] = CalendarLogic::toDayNumber(startDom, startMonth, year);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // The first period may begin before the event does
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (days[i] >= startDay) days[kept++] = days[i];
+    }
+    return kept;
+}
+
+int RecurrenceRule::nextOnOrAfter(int startDay, int fromDay) const {
+    if (frequency_ == FREQ_NONE) return -1;
+    if (fromDay < startDay) fromDay = startDay;
+    if (untilDay_ >= 0 && fromDay > untilDay_) return -1;
+
+    int days[31];
+    int seen = 0;
+    int first = count_ >= 0 ? 0 : periodOf(startDay, fromDay);
+    if (first < 0) first = 0;
+    int last = first + kMaxPeriods + (count_ > 0 ? count_ : 0);
+    for (int k = first; k < last; k++) {
+        int n = daysOfPeriod(startDay, k, days);
+        for (int i = 0; i < n; i++) {
+            if (count_ >= 0 && seen++ >= count_) return -1;
+            if (untilDay_ >= 0 && days[i] > untilDay_) return -1;
+            if (days[i] >= fromDay) return days[i];
+        }
+    }
+    return -1;
+}
+
+} // namespace calendar
@@ -0,0 +1,50 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <cstdint>
+#include <string>
+
+namespace calendar {
+
+// The part of an RFC 5545 RRULE the calendar expands: FREQ=DAILY, WEEKLY,
+// MONTHLY or YEARLY with INTERVAL, COUNT, UNTIL, BYDAY (weekly rules) and
+// BYMONTHDAY (monthly rules); other parts are ignored. Occurrences are day
+// numbers (CalendarLogic::toDayNumber) found one at a time from any date,
+// so a rule is never expanded further ahead than a caller asks.
+class RecurrenceRule {
+public:
+    enum Frequency {
+        FREQ_NONE,
+        FREQ_DAILY,
+        FREQ_WEEKLY,
+        FREQ_MONTHLY,
+        FREQ_YEARLY
+    };
+
+    RecurrenceRule();
+
+    // False if the rule has no FREQ the calendar understands
+    bool parse(const std::string& rrule);
+    Frequency frequency() const { return frequency_; }
+
+    // First occurrence on or after fromDay of an event first held on
+    // startDay, or -1 once the rule has run out. Unbounded rules jump
+    // straight to fromDay; COUNT rules walk from the start to count.
+    int nextOnOrAfter(int startDay, int fromDay) const;
+
+private:
+    int periodOf(int startDay, int day) const;
+    // Occurrence days of period k in ascending order, none before startDay
+    int daysOfPeriod(int startDay, int k, int* days) const;
+
+    Frequency frequency_;
+    int interval_;
+    int count_;            // -1 if unbounded
+    int untilDay_;         // -1 if unbounded
+    uint8_t byDay_;        // bit per weekday, Monday = bit 0; 0 = the start's weekday
+    uint32_t byMonthDay_;  // bit per day of the month; 0 = the start's day
+};
+
+} // namespace calendar
+
+#endif // RECURRENCE_H
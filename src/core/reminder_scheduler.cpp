@@ -0,0 +1,163 @@
+#include "reminder_scheduler.h"
+#include "calendar.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+#include "recurrence.h"
+#include <algorithm>
+#include <climits>
+
+namespace calendar {
+
+namespace {
+
+const int64_t kDayMs = 24 * 60 * 60 * 1000;
+
+// Puts the earliest entry at the front of the std heap functions' max-heap
+template <typename Entry>
+struct FiresLater {
+    bool operator()(const Entry& a, const Entry& b) const { return a.fireMs > b.fireMs; }
+};
+
+// Events without a start time are reminded of relative to midnight
+int64_t startOffsetMs(const Event& event) {
+    if (event.isAllDay || event.hourStart < 0) return 0;
+    return (int64_t)(event.hourStart * 60 + event.minuteStart) * 60000;
+}
+
+int64_t ceilDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && a > 0) ? q + 1 : q;
+}
+
+} // namespace
+
+ReminderScheduler::ReminderScheduler(EventManager& events)
+    : events_(events), nextTicket_(1), nowMs_(0), started_(false) {
+    events_.addListener(this);
+}
+
+ReminderScheduler::~ReminderScheduler() {
+    events_.removeListener(this);
+}
+
+void ReminderScheduler::start(int64_t nowMs) {
+    nowMs_ = nowMs;
+    started_ = true;
+    rebuild();
+}
+
+void ReminderScheduler::eventChanged(const Event& event, ChangeOrigin origin) {
+    (void)origin;
+    if (!started_) return;
+    schedule(event, INT_MIN);
+}
+
+void ReminderScheduler::eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) {
+    (void)stamp;
+    (void)origin;
+    live_.erase(uid);
+}
+
+void ReminderScheduler::eventsReplaced() {
+    if (started_) rebuild();
+}
+
+void ReminderScheduler::schedule(const Event& event, int fromDay) {
+    if (event.reminderMinutes < 0) {
+        live_.erase(event.uid);
+        return;
+    }
+
+    // First day whose occurrence would not have started yet
+    int64_t offsetMs = startOffsetMs(event);
+    fromDay = std::max(fromDay, (int)ceilDiv(nowMs_ - offsetMs, kDayMs));
+    int startDay = CalendarLogic::toDayNumber(event.day, event.month, event.year);
+    int day = startDay >= fromDay ? startDay : -1;
+    if (!event.recurrence.empty()) {
+        RecurrenceRule rule;
+        if (rule.parse(event.recurrence)) day = rule.nextOnOrAfter(startDay, fromDay);
+    }
+    if (day < 0) {
+        live_.erase(event.uid);
+        return;
+    }
+
+    MEMORY_SCOPE(MEM_INDEXES);
+    Entry entry;
+    entry.fireMs = day * kDayMs + offsetMs - (int64_t)event.reminderMinutes * 60000;
+    entry.uid = event.uid;
+    entry.ticket = nextTicket_++;
+    entry.occurrenceDay = day;
+    live_[event.uid] = entry.ticket;
+    heap_.push_back(entry);
+    std::push_heap(heap_.begin(), heap_.end(), FiresLater<Entry>());
+
+    // Edits leave their old entries behind; sweep once they dominate
+    if (heap_.size() > 2 * live_.size() + 64) {
+        heap_.erase(std::remove_if(heap_.begin(), heap_.end(), [this](const Entry& e) { return !live(e); }),
+                    heap_.end());
+        std::make_heap(heap_.begin(), heap_.end(), FiresLater<Entry>());
+    }
+}
+
+void ReminderScheduler::rebuild() {
+    PROFILE_SCOPE("reminders.rebuild");
+    heap_.clear();
+    live_.clear();
+    for (const Event& event : events_.getAllEvents()) {
+        if (event.reminderMinutes >= 0) schedule(event, INT_MIN);
+    }
+}
+
+bool ReminderScheduler::live(const Entry& entry) const {
+    auto it = live_.find(entry.uid);
+    return it != live_.end() && it->second == entry.ticket;
+}
+
+void ReminderScheduler::dropStaleTop() {
+    while (!heap_.empty() && !live(heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), FiresLater<Entry>());
+        heap_.pop_back();
+    }
+}
+
+int64_t ReminderScheduler::nextDueMs() {
+    dropStaleTop();
+    return heap_.empty() ? -1 : heap_.front().fireMs;
+}
+
+bool ReminderScheduler::poll(int64_t nowMs, std::vector<Reminder>& due) {
+    nowMs_ = nowMs;
+    if (heap_.empty() || heap_.front().fireMs > nowMs) return false;
+
+    PROFILE_SCOPE("reminders.fire");
+    size_t before = due.size();
+    for (;;) {
+        dropStaleTop();
+        if (heap_.empty() || heap_.front().fireMs > nowMs) break;
+        std::pop_heap(heap_.begin(), heap_.end(), FiresLater<Entry>());
+        Entry entry = heap_.back();
+        heap_.pop_back();
+        live_.erase(entry.uid);
+
+        Event* event = events_.findByUid(entry.uid);
+        if (!event) continue;
+        // Missed altogether (the machine slept through it): skip to the next
+        int64_t startMs = entry.occurrenceDay * kDayMs + startOffsetMs(*event);
+        if (nowMs <= std::max(startMs, entry.fireMs + kLateGraceMs)) {
+            MEMORY_SCOPE(MEM_TEXT);
+            due.emplace_back();
+            Reminder& reminder = due.back();
+            reminder.uid = event->uid;
+            CalendarLogic::fromDayNumber(entry.occurrenceDay, reminder.day, reminder.month, reminder.year);
+            reminder.hourStart = event->isAllDay ? -1 : event->hourStart;
+            reminder.minuteStart = event->minuteStart;
+            reminder.minutesBefore = event->reminderMinutes;
+            reminder.text = event->text;
+        }
+        schedule(*event, entry.occurrenceDay + 1);
+    }
+    return due.size() > before;
+}
+
+} // namespace calendar
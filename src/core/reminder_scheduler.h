@@ -0,0 +1,81 @@
+#ifndef REMINDER_SCHEDULER_H
+#define REMINDER_SCHEDULER_H
+
+#include "event.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace calendar {
+
+// One reminder that came due, for one occurrence of an event
+struct Reminder {
+    uint64_t uid;
+    int day;
+    int month;
+    int year;
+    int hourStart;      // -1 for all-day events
+    int minuteStart;
+    int minutesBefore;
+    std::string text;
+};
+
+// Keeps every upcoming reminder in a min-heap ordered by fire time, so
+// poll() only looks at the top and costs nothing until one is due. Edits
+// and removals reach it as an EventListener; instead of searching the heap
+// they replace or drop the event's ticket in live_, and entries holding an
+// old ticket are discarded when they surface (or all at once when they
+// outnumber the live ones). Recurring events hold one entry, for their
+// next occurrence; the one after it is scheduled when it fires. Times are
+// Clock::localMs().
+class ReminderScheduler : public EventListener {
+public:
+    // A reminder is still shown this long after it was due, if the event
+    // has not started yet either (a suspended tab, a slow frame)
+    static const int64_t kLateGraceMs = 5 * 60 * 1000;
+
+    explicit ReminderScheduler(EventManager& events);
+    ~ReminderScheduler();
+
+    // Schedules the calendar as it is; later changes come in as listener calls
+    void start(int64_t nowMs);
+    // Appends the reminders due at nowMs to due and schedules the next
+    // occurrences of recurring ones. True if any were added.
+    bool poll(int64_t nowMs, std::vector<Reminder>& due);
+    // Fire time of the earliest pending reminder, or -1 if there is none
+    int64_t nextDueMs();
+
+    size_t scheduledCount() const { return live_.size(); }
+
+    void eventChanged(const Event& event, ChangeOrigin origin) override;
+    void eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) override;
+    void eventsReplaced() override;
+
+private:
+    struct Entry {
+        int64_t fireMs;
+        uint64_t uid;
+        uint64_t ticket;
+        int occurrenceDay;
+    };
+
+    // Pushes the event's first occurrence starting at or after nowMs_ and
+    // not before fromDay, if it has a reminder
+    void schedule(const Event& event, int fromDay);
+    void rebuild();
+    // Pops entries that are stale until a live one is on top
+    void dropStaleTop();
+    bool live(const Entry& entry) const;
+
+    EventManager& events_;
+    std::vector<Entry> heap_;
+    std::unordered_map<uint64_t, uint64_t> live_;   // uid -> ticket of its scheduled entry
+    uint64_t nextTicket_;
+    int64_t nowMs_;
+    bool started_;
+};
+
+} // namespace calendar
+
+#endif // REMINDER_SCHEDULER_H
@@ -1,111 +1,521 @@
 #include "storage.h"
-#include <emscripten.h>
-#include <emscripten/html5.h>
+#include "memory_tracker.h"
+#include "persistence_worker.h"
+#include "profiler.h"
+#include "storage_backend.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
 namespace calendar {
 
+namespace {
+
+// Forward-only reader over a JSON payload. Loaders for each schema version
+// drive it directly, so no loader needs to search ahead in the document.
+struct JsonCursor {
+    const char* p;
+    const char* end;
+
+    JsonCursor(const std::string& json) : p(json.data()), end(json.data() + json.size()) {}
+
+    bool atEnd() const { return p >= end; }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    // Exact match with no whitespace skipping, for the fixed-layout fast path
+    bool consumeLiteral(const char* literal, size_t len) {
+        if ((size_t)(end - p) < len || memcmp(p, literal, len) != 0) return false;
+        p += len;
+        return true;
+    }
+
+    // The next key of a fixed-layout record, as ,"key": or "key": for the
+    // first one; like consumeLiteral, no whitespace is allowed
+    template <size_t N>
+    bool expectKey(const char (&key)[N], bool first = false) {
+        const size_t len = N - 1;
+        if (!first && !consumeLiteral(",", 1)) return false;
+        if ((size_t)(end - p) < len + 3 || p[0] != '"' || memcmp(p + 1, key, len) != 0 || p[len + 1] != '"' ||
+            p[len + 2] != ':') {
+            return false;
+        }
+        p += len + 3;
+        return true;
+    }
+
+    bool readInt(int& out) {
+        skipWhitespace();
+        bool negative = false;
+        if (p < end && *p == '-') {
+            negative = true;
+            p++;
+        }
+        if (p >= end || *p < '0' || *p > '9') return false;
+        int value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            p++;
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // Quoted hex, as uids and stamps are written: JavaScript readers
+    // would lose precision on 64-bit numbers
+    bool readHex64(uint64_t& out) {
+        if (!consume('"')) return false;
+        uint64_t value = 0;
+        const char* start = p;
+        while (p < end && *p != '"') {
+            char c = *p++;
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else return false;
+            value = (value << 4) | (uint64_t)digit;
+        }
+        if (p >= end || p == start || p - start > 16) return false;
+        p++;
+        out = value;
+        return true;
+    }
+
+    bool readBool(bool& out) {
+        skipWhitespace();
+        if (consumeLiteral("true", 4)) {
+            out = true;
+            return true;
+        }
+        if (consumeLiteral("false", 5)) {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool readString(std::string& out) {
+        if (!consume('"')) return false;
+        out.clear();
+        const char* start = p;
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                p++;
+                continue;
+            }
+            out.append(start, p - start);
+            if (++p >= end) return false;
+            char c = *p++;
+            switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (end - p < 4) return false;
+                    unsigned code = (unsigned)strtoul(std::string(p, 4).c_str(), nullptr, 16);
+                    p += 4;
+                    appendUtf8(code, out);
+                    break;
+                }
+                default: out += c; break;
+            }
+            start = p;
+        }
+        if (p >= end) return false;
+        out.append(start, p - start);
+        p++;
+        return true;
+    }
+
+    // Schema v0/v1 wrote text unescaped, terminated by the closing "}
+    bool readUnescapedText(std::string& out) {
+        if (!consume('"')) return false;
+        const char* close = p;
+        while (close + 1 < end && !(close[0] == '"' && close[1] == '}')) close++;
+        if (close + 1 >= end) return false;
+        out.assign(p, close - p);
+        p = close + 1;
+        return true;
+    }
+
+    bool readKey(std::string& key) {
+        return readString(key) && consume(':');
+    }
+
+    static void appendUtf8(unsigned code, std::string& out) {
+        if (code < 0x80) {
+            out += (char)code;
+        } else if (code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        } else {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+};
+
+void appendEscaped(const std::string& text, std::string& out) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+void appendInt(int value, std::string& out) {
+    char buffer[16];
+    int len = snprintf(buffer, sizeof(buffer), "%d", value);
+    out.append(buffer, len);
+}
+
+void appendHex64(uint64_t value, std::string& out) {
+    char buffer[20];
+    int len = snprintf(buffer, sizeof(buffer), "\"%llx\"", (unsigned long long)value);
+    out.append(buffer, len);
+}
+
+const char* const kStorageKey = "calendar_events";
+const char* const kTagsKey = "calendar_tags";
+bool g_persistenceEnabled = true;
+bool g_storedPayloadKept = false;
+
+} // namespace
+
+void StorageManager::setPersistenceEnabled(bool enabled) {
+    g_persistenceEnabled = enabled;
+}
+
+bool StorageManager::persistenceEnabled() {
+    return g_persistenceEnabled;
+}
+
+void StorageManager::keepStoredPayload() {
+    g_storedPayloadKept = true;
+}
+
+bool StorageManager::storedPayloadKept() {
+    return g_storedPayloadKept;
+}
+
 void StorageManager::saveEventsToStorage(const std::vector<Event>& events) {
-    std::string json = serializeToJSON(events);
-    
-    EM_ASM({
-        localStorage.setItem('calendar_events', UTF8ToString($0));
-    }, json.c_str());
-}
-
-void StorageManager::loadEventsFromStorage(std::vector<Event>& events) {
-    char* stored = (char*)EM_ASM_PTR({
-        const data = localStorage.getItem('calendar_events');
-        if (!data) return null;
-        const len = lengthBytesUTF8(data) + 1;
-        const ptr = _malloc(len);
-        stringToUTF8(data, ptr, len);
-        return ptr;
-    });
-    
-    if (stored) {
-        std::string json = stored;
-        free(stored);
-        parseFromJSON(json, events);
+    if (!g_persistenceEnabled || g_storedPayloadKept) return;
+    PROFILE_SCOPE("storage.save");
+    MEMORY_SCOPE(MEM_STORAGE);
+    // With the worker running only the snapshot copy is paid here
+    if (PersistenceWorker::instance().save(events)) return;
+    StorageBackend::write(kStorageKey, serializeToJSON(events));
+}
+
+void StorageManager::loadEventsFromStorage(EventManager& events) {
+    PROFILE_SCOPE("storage.load");
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string json;
+    if (!readStoredJSON(json)) return;
+
+    std::vector<Event> parsed;
+    int version = parseFromJSON(json, parsed);
+    bool assigned = lacksIdentity(parsed);
+    events.addEvents(parsed);
+    // One-time migration: rewrite old payloads so later loads take the fast
+    // path, after addEvents has handed out the missing uids and stamps.
+    // What cannot be read is never overwritten.
+    if (version < 0) {
+        keepStoredPayload();
+    } else if (version < kSchemaVersion || assigned) {
+        saveEventsToStorage(events.getAllEvents());
+    }
+}
+
+bool StorageManager::lacksIdentity(const std::vector<Event>& events) {
+    for (const Event& evt : events) {
+        if (evt.uid == 0 || evt.stamp == 0) return true;
+    }
+    return false;
+}
+
+bool StorageManager::readStoredJSON(std::string& json) {
+    return StorageBackend::read(kStorageKey, json);
+}
+
+void StorageManager::writeStoredJSON(const std::string& json) {
+    // Saves the worker serialised before the load came back unreadable
+    if (g_storedPayloadKept) return;
+    StorageBackend::write(kStorageKey, json);
+}
+
+// {"version":1,"tags":["WORK","",...]}, one name per bit up to the last
+// one named; unnamed bits are empty strings
+void StorageManager::saveTags(const TagTable& tags) {
+    if (!g_persistenceEnabled) return;
+    MEMORY_SCOPE(MEM_STORAGE);
+    int count = TagTable::kMaxTags;
+    while (count > 0 && !tags.defined(count - 1)) count--;
+    std::string json = "{\"version\":1,\"tags\":[";
+    for (int bit = 0; bit < count; bit++) {
+        if (bit > 0) json += ',';
+        appendEscaped(tags.name(bit), json);
+    }
+    json += "]}";
+    StorageBackend::write(kTagsKey, json);
+}
+
+void StorageManager::loadTags(TagTable& tags) {
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string json;
+    if (!StorageBackend::read(kTagsKey, json)) return;
+    JsonCursor cursor(json);
+    std::string key;
+    int version = 0;
+    if (!cursor.consume('{') || !cursor.readKey(key) || key != "version" || !cursor.readInt(version) ||
+        version != 1 || !cursor.consume(',') || !cursor.readKey(key) || key != "tags" || !cursor.consume('[')) {
+        return;
+    }
+    tags.clear();
+    std::string name;
+    for (int bit = 0; bit < TagTable::kMaxTags && cursor.readString(name); bit++) {
+        tags.rename(bit, name);
+        cursor.consume(',');
     }
 }
 
 std::string StorageManager::serializeToJSON(const std::vector<Event>& events) {
-    std::string json = "[";
-    for (size_t i = 0; i < events.size(); i++) {
-        if (i > 0) json += ",";
-        json += "{\"day\":" + std::to_string(events[i].day);
-        json += ",\"month\":" + std::to_string(events[i].month);
-        json += ",\"year\":" + std::to_string(events[i].year);
-        json += ",\"hourStart\":" + std::to_string(events[i].hourStart);
-        json += ",\"minuteStart\":" + std::to_string(events[i].minuteStart);
-        json += ",\"hourEnd\":" + std::to_string(events[i].hourEnd);
-        json += ",\"minuteEnd\":" + std::to_string(events[i].minuteEnd);
-        json += ",\"isAllDay\":" + std::string(events[i].isAllDay ? "true" : "false");
-        json += ",\"text\":\"" + events[i].text + "\"}";
-    }
-    json += "]";
+    std::string json;
+    json.reserve(32 + events.size() * 232);
+    beginJSON(json);
+    for (const Event& evt : events) appendEventJSON(evt, json);
+    endJSON(json);
     return json;
 }
 
-void StorageManager::parseFromJSON(const std::string& json, std::vector<Event>& events) {
+void StorageManager::beginJSON(std::string& json) {
+    json += "{\"version\":";
+    appendInt(kSchemaVersion, json);
+    json += ",\"events\":[";
+}
+
+void StorageManager::appendEventJSON(const Event& evt, std::string& json) {
+    // Every event but the first follows another's closing brace
+    if (json.back() == '}') json += ",";
+    // Field order is fixed; parseVersioned relies on it
+    json += "{\"uid\":";
+    appendHex64(evt.uid, json);
+    json += ",\"stamp\":";
+    appendHex64(evt.stamp, json);
+    json += ",\"day\":";
+    appendInt(evt.day, json);
+    json += ",\"month\":";
+    appendInt(evt.month, json);
+    json += ",\"year\":";
+    appendInt(evt.year, json);
+    json += ",\"hourStart\":";
+    appendInt(evt.hourStart, json);
+    json += ",\"minuteStart\":";
+    appendInt(evt.minuteStart, json);
+    json += ",\"hourEnd\":";
+    appendInt(evt.hourEnd, json);
+    json += ",\"minuteEnd\":";
+    appendInt(evt.minuteEnd, json);
+    json += evt.isAllDay ? ",\"isAllDay\":true" : ",\"isAllDay\":false";
+    json += ",\"remind\":";
+    appendInt(evt.reminderMinutes, json);
+    json += ",\"tags\":";
+    appendHex64(evt.tags, json);
+    json += ",\"rrule\":";
+    appendEscaped(evt.recurrence, json);
+    json += ",\"text\":";
+    appendEscaped(evt.text, json);
+    json += "}";
+}
+
+void StorageManager::endJSON(std::string& json) {
+    json += "]}";
+}
+
+void StorageManager::saveSerialized(const std::string& json) {
+    if (!g_persistenceEnabled || g_storedPayloadKept) return;
+    // Like PersistenceWorker::save: the calendar still being loaded must
+    // not be overwritten; its arrival saves what was added meanwhile
+    if (PersistenceWorker::instance().loading()) return;
+    StorageBackend::write(kStorageKey, json);
+}
+
+int StorageManager::detectSchemaVersion(const std::string& json) {
+    JsonCursor cursor(json);
+    if (cursor.consume('{')) {
+        // {"version":N,"events":[...]}
+        std::string key;
+        int version = 0;
+        if (cursor.readKey(key) && key == "version" && cursor.readInt(version)) {
+            return version;
+        }
+        return -1;
+    }
+    if (!cursor.consume('[')) return -1;
+
+    // Unversioned arrays: v1 has hourStart, v0 only the single hour/minute
+    std::string key;
+    if (cursor.consume('{')) {
+        while (cursor.readKey(key)) {
+            if (key == "hourStart") return 1;
+            if (key == "text") break;
+            int ignored;
+            if (!cursor.readInt(ignored)) break;
+            cursor.consume(',');
+        }
+    }
+    return 0;
+}
+
+int StorageManager::parseFromJSON(const std::string& json, std::vector<Event>& events) {
+    // The decoded strings outlive the parse as event descriptions
+    MEMORY_SCOPE(MEM_TEXT);
     events.clear();
-    
-    // Simple JSON parsing
-    size_t pos = 0;
-    while ((pos = json.find("\"day\":", pos)) != std::string::npos) {
+
+    int version = detectSchemaVersion(json);
+    bool parsed = false;
+    switch (version) {
+        case 0: parsed = parseV0(json, events); break;
+        case 1: parsed = parseV1(json, events); break;
+        case 2:
+        case 3:
+        case 4:
+        case 5: parsed = parseVersioned(json, version, events); break;
+        default: break;
+    }
+    return parsed ? version : -1;
+}
+
+// v0: [{"day":1,"month":0,"year":2024,"hour":9,"minute":30,"text":"..."}]
+// hour and minute are optional; events have no end time.
+bool StorageManager::parseV0(const std::string& json, std::vector<Event>& events) {
+    JsonCursor cursor(json);
+    cursor.consume('[');
+    std::string key;
+    while (cursor.consume('{')) {
         Event evt;
-        
-        pos += 6;
-        evt.day = std::stoi(json.substr(pos, json.find(",", pos) - pos));
-        
-        pos = json.find("\"month\":", pos) + 8;
-        evt.month = std::stoi(json.substr(pos, json.find(",", pos) - pos));
-        
-        pos = json.find("\"year\":", pos) + 7;
-        evt.year = std::stoi(json.substr(pos, json.find(",", pos) - pos));
-        
-        // Try new format first
-        size_t hourStartPos = json.find("\"hourStart\":", pos);
-        if (hourStartPos != std::string::npos && hourStartPos < json.find("\"text\":", pos)) {
-            evt.hourStart = std::stoi(json.substr(hourStartPos + 12, json.find(",", hourStartPos) - (hourStartPos + 12)));
-            
-            size_t minuteStartPos = json.find("\"minuteStart\":", pos);
-            evt.minuteStart = std::stoi(json.substr(minuteStartPos + 14, json.find(",", minuteStartPos) - (minuteStartPos + 14)));
-            
-            size_t hourEndPos = json.find("\"hourEnd\":", pos);
-            evt.hourEnd = std::stoi(json.substr(hourEndPos + 10, json.find(",", hourEndPos) - (hourEndPos + 10)));
-            
-            size_t minuteEndPos = json.find("\"minuteEnd\":", pos);
-            evt.minuteEnd = std::stoi(json.substr(minuteEndPos + 12, json.find(",", minuteEndPos) - (minuteEndPos + 12)));
-            
-            size_t allDayPos = json.find("\"isAllDay\":", pos);
-            if (allDayPos != std::string::npos) {
-                std::string allDayStr = json.substr(allDayPos + 11, 4);
-                evt.isAllDay = (allDayStr == "true");
-            }
-        } else {
-            // Fallback: old format with single hour/minute
-            size_t hourPos = json.find("\"hour\":", pos);
-            if (hourPos != std::string::npos && hourPos < json.find("\"text\":", pos)) {
-                evt.hourStart = std::stoi(json.substr(hourPos + 7, json.find(",", hourPos) - (hourPos + 7)));
-                evt.hourEnd = -1;
-            }
-            
-            size_t minutePos = json.find("\"minute\":", pos);
-            if (minutePos != std::string::npos && minutePos < json.find("\"text\":", pos)) {
-                evt.minuteStart = std::stoi(json.substr(minutePos + 9, json.find(",", minutePos) - (minutePos + 9)));
+        while (cursor.readKey(key)) {
+            if (key == "text") {
+                if (!cursor.readUnescapedText(evt.text)) return false;
+            } else {
+                int value = 0;
+                if (!cursor.readInt(value)) return false;
+                if (key == "day") evt.day = value;
+                else if (key == "month") evt.month = value;
+                else if (key == "year") evt.year = value;
+                else if (key == "hour") evt.hourStart = value;
+                else if (key == "minute") evt.minuteStart = value;
             }
+            cursor.consume(',');
         }
-        
-        pos = json.find("\"text\":\"", pos) + 8;
-        size_t end = json.find("\"}", pos);
-        evt.text = json.substr(pos, end - pos);
-        
-        events.push_back(evt);
-        pos = end;
+        cursor.consume('}');
+        events.push_back(std::move(evt));
+        cursor.consume(',');
     }
+    return cursor.consume(']');
 }
 
-} // namespace calendar
+// v1: [{"day":..,"month":..,"year":..,"hourStart":..,"minuteStart":..,
+//       "hourEnd":..,"minuteEnd":..,"isAllDay":..,"text":"..."}]
+// with an optional "rrule" before "text"; text is not escaped.
+bool StorageManager::parseV1(const std::string& json, std::vector<Event>& events) {
+    JsonCursor cursor(json);
+    cursor.consume('[');
+    std::string key;
+    while (cursor.consume('{')) {
+        Event evt;
+        while (cursor.readKey(key)) {
+            bool ok = true;
+            if (key == "text") ok = cursor.readUnescapedText(evt.text);
+            else if (key == "rrule") ok = cursor.readString(evt.recurrence);
+            else if (key == "isAllDay") ok = cursor.readBool(evt.isAllDay);
+            else if (key == "day") ok = cursor.readInt(evt.day);
+            else if (key == "month") ok = cursor.readInt(evt.month);
+            else if (key == "year") ok = cursor.readInt(evt.year);
+            else if (key == "hourStart") ok = cursor.readInt(evt.hourStart);
+            else if (key == "minuteStart") ok = cursor.readInt(evt.minuteStart);
+            else if (key == "hourEnd") ok = cursor.readInt(evt.hourEnd);
+            else if (key == "minuteEnd") ok = cursor.readInt(evt.minuteEnd);
+            if (!ok) return false;
+            cursor.consume(',');
+        }
+        cursor.consume('}');
+        events.push_back(std::move(evt));
+        cursor.consume(',');
+    }
+    return cursor.consume(']');
+}
 
+// v2..v5: {"version":N,"events":[...]}. Within a version every record has
+// the same fields in the same order, so they are matched as literals with
+// no key lookup at all; the version says which of the later fields to
+// expect. v3 put "uid" and "stamp" (quoted hex) in front, v4 added "remind"
+// (minutes, -1 for none) after "isAllDay" and v5 "tags" (quoted hex) after
+// "remind", as serializeToJSON writes it.
+bool StorageManager::parseVersioned(const std::string& json, int version, std::vector<Event>& events) {
+    JsonCursor cursor(json);
+    std::string key;
+    int stored = 0;
+    if (!cursor.consume('{') || !cursor.readKey(key) || !cursor.readInt(stored) || !cursor.consume(',') ||
+        !cursor.readKey(key) || key != "events" || !cursor.consume('[')) {
+        return false;
+    }
+
+    bool hasUid = version >= 3;
+    bool hasRemind = version >= 4;
+    bool hasTags = version >= 5;
+    while (cursor.consume('{')) {
+        Event evt;
+        bool ok = (!hasUid || (cursor.expectKey("uid", true) && cursor.readHex64(evt.uid) &&
+                               cursor.expectKey("stamp") && cursor.readHex64(evt.stamp))) &&
+                  cursor.expectKey("day", !hasUid) && cursor.readInt(evt.day) &&
+                  cursor.expectKey("month") && cursor.readInt(evt.month) &&
+                  cursor.expectKey("year") && cursor.readInt(evt.year) &&
+                  cursor.expectKey("hourStart") && cursor.readInt(evt.hourStart) &&
+                  cursor.expectKey("minuteStart") && cursor.readInt(evt.minuteStart) &&
+                  cursor.expectKey("hourEnd") && cursor.readInt(evt.hourEnd) &&
+                  cursor.expectKey("minuteEnd") && cursor.readInt(evt.minuteEnd) &&
+                  cursor.expectKey("isAllDay") && cursor.readBool(evt.isAllDay) &&
+                  (!hasRemind || (cursor.expectKey("remind") && cursor.readInt(evt.reminderMinutes))) &&
+                  (!hasTags || (cursor.expectKey("tags") && cursor.readHex64(evt.tags))) &&
+                  cursor.expectKey("rrule") && cursor.readString(evt.recurrence) &&
+                  cursor.expectKey("text") && cursor.readString(evt.text) &&
+                  cursor.consume('}');
+        if (!ok) return false;
+        events.push_back(std::move(evt));
+        cursor.consume(',');
+    }
+    return cursor.consume(']') && cursor.consume('}');
+}
+
+} // namespace calendar
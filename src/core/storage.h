@@ -2,21 +2,67 @@
 #define STORAGE_H
 
 #include "event.h"
+#include <string>
 #include <vector>
 
 namespace calendar {
 
 class StorageManager {
 public:
+    // Version stamped into saved data. Bump it and teach parseVersioned the
+    // new fields when the on-disk layout changes; older payloads are
+    // migrated on first load.
+    static const int kSchemaVersion = 5;
+
     static void saveEventsToStorage(const std::vector<Event>& events);
-    static void loadEventsFromStorage(std::vector<Event>& events);
+    // While disabled, saves are dropped; trace replays edit synthetic data
+    // that must not overwrite the user's calendar
+    static void setPersistenceEnabled(bool enabled);
+    static bool persistenceEnabled();
+    // Called when the stored payload could not be read (a newer schema, an
+    // unknown layout or corrupt data): it is left exactly as it is and
+    // every save is dropped for the rest of the session
+    static void keepStoredPayload();
+    static bool storedPayloadKept();
+    // Adds the stored calendar to events, which gives every event a uid and
+    // stamp; old payloads, and events stored without either, are saved
+    // back once with them so every load and every tab agrees on them
+    static void loadEventsFromStorage(EventManager& events);
+    // True if some parsed event has no uid or stamp yet
+    static bool lacksIdentity(const std::vector<Event>& events);
+    // Raw payload access for PersistenceWorker, which serialises and parses
+    // on its own thread but reads and writes storage on the UI thread
+    static bool readStoredJSON(std::string& json);
+    static void writeStoredJSON(const std::string& json);
+
+    // Tag names live under their own key, written when they change rather
+    // than with every save of the events. Loading keeps the table's
+    // defaults if nothing was stored.
+    static void saveTags(const TagTable& tags);
+    static void loadTags(TagTable& tags);
 
-private:
     static std::string serializeToJSON(const std::vector<Event>& events);
-    static void parseFromJSON(const std::string& json, std::vector<Event>& events);
+    // serializeToJSON a piece at a time, for saves spread over several
+    // frames: the header, each event in order, then the footer. The result
+    // is stored with saveSerialized, under the same rules as
+    // saveEventsToStorage.
+    static void beginJSON(std::string& json);
+    static void appendEventJSON(const Event& evt, std::string& json);
+    static void endJSON(std::string& json);
+    static void saveSerialized(const std::string& json);
+    // Returns the schema version that was read, or -1 if the version is
+    // unknown or newer than kSchemaVersion or the payload is malformed;
+    // events then hold whatever could be read before the error
+    static int parseFromJSON(const std::string& json, std::vector<Event>& events);
+
+private:
+    static int detectSchemaVersion(const std::string& json);
+    static bool parseV0(const std::string& json, std::vector<Event>& events);
+    static bool parseV1(const std::string& json, std::vector<Event>& events);
+    // Every {"version":N,...} layout; version decides the fields expected
+    static bool parseVersioned(const std::string& json, int version, std::vector<Event>& events);
 };
 
 } // namespace calendar
 
 #endif // STORAGE_H
-
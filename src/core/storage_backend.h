@@ -0,0 +1,20 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <string>
+
+namespace calendar {
+
+// Raw key/value persistence under StorageManager. The browser build links
+// storage_web.cpp (localStorage); native builds link storage_native.cpp,
+// which keeps each key in a file so the core runs outside the browser.
+class StorageBackend {
+public:
+    // Returns false if nothing is stored under key
+    static bool read(const char* key, std::string& out);
+    static void write(const char* key, const std::string& value);
+};
+
+} // namespace calendar
+
+#endif // STORAGE_BACKEND_H
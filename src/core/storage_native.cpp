@@ -0,0 +1,41 @@
+#include "storage_backend.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace calendar {
+
+namespace {
+
+// One file per key, in $CALENDAR_STORAGE_DIR or the working directory
+std::string pathForKey(const char* key) {
+    const char* dir = getenv("CALENDAR_STORAGE_DIR");
+    std::string path = dir && *dir ? dir : ".";
+    path += '/';
+    path += key;
+    path += ".json";
+    return path;
+}
+
+} // namespace
+
+bool StorageBackend::read(const char* key, std::string& out) {
+    FILE* file = fopen(pathForKey(key).c_str(), "rb");
+    if (!file) return false;
+    out.clear();
+    char buffer[64 * 1024];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+void StorageBackend::write(const char* key, const std::string& value) {
+    FILE* file = fopen(pathForKey(key).c_str(), "wb");
+    if (!file) return;
+    fwrite(value.data(), 1, value.size(), file);
+    fclose(file);
+}
+
+} // namespace calendar
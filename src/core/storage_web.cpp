@@ -0,0 +1,29 @@
+#include "storage_backend.h"
+#include <emscripten.h>
+#include <cstdlib>
+
+namespace calendar {
+
+bool StorageBackend::read(const char* key, std::string& out) {
+    char* stored = (char*)EM_ASM_PTR({
+        const data = localStorage.getItem(UTF8ToString($0));
+        if (!data) return null;
+        const len = lengthBytesUTF8(data) + 1;
+        const ptr = _malloc(len);
+        stringToUTF8(data, ptr, len);
+        return ptr;
+    }, key);
+
+    if (!stored) return false;
+    out = stored;
+    free(stored);
+    return true;
+}
+
+void StorageBackend::write(const char* key, const std::string& value) {
+    EM_ASM({
+        localStorage.setItem(UTF8ToString($0), UTF8ToString($1));
+    }, key, value.c_str());
+}
+
+} // namespace calendar
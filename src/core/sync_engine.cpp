@@ -0,0 +1,244 @@
+#include "sync_engine.h"
+#include "memory_tracker.h"
+#include "persistence_worker.h"
+#include "profiler.h"
+#include "storage.h"
+#include "storage_backend.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace calendar {
+
+namespace {
+
+// Stored log: "cursor <hex>" then one "<U|R> <uid hex> <stamp hex>" line
+// per op. Text, since localStorage only holds strings.
+bool parseLine(const char*& p, char& kind, uint64_t& uid, uint64_t& stamp) {
+    kind = *p;
+    if (kind != 'U' && kind != 'R') return false;
+    char* end;
+    uid = strtoull(p + 1, &end, 16);
+    stamp = strtoull(end, &end, 16);
+    p = end;
+    while (*p == '\n') p++;
+    return true;
+}
+
+} // namespace
+
+SyncEngine::SyncEngine(EventManager& events, SyncTransport& transport)
+    : events_(events), transport_(transport), cursor_(0), savedCursor_(0), started_(false),
+      exchanging_(false), online_(true), edited_(false), logDirty_(false), syncNow_(true),
+      firstEditMs_(-1.0), saveAtMs_(-1.0), lastEditMs_(0.0), nextPullMs_(0.0), retryAtMs_(0.0), backoffMs_(0.0), bytesSent_(0),
+      bytesReceived_(0), deltasPushed_(0), deltasPulled_(0) {
+    events_.addListener(this);
+}
+
+SyncEngine::~SyncEngine() {
+    events_.removeListener(this);
+}
+
+void SyncEngine::start() {
+    std::string stored;
+    if (StorageBackend::read(kStorageKey, stored)) {
+        cursor_ = strtoull(stored.c_str() + (stored.compare(0, 7, "cursor ") == 0 ? 7 : 0), nullptr, 16);
+    }
+    savedCursor_ = cursor_;
+    mergeStoredLog();
+    started_ = true;
+}
+
+void SyncEngine::eventChanged(const Event& event, ChangeOrigin origin) {
+    // Other tabs push their own edits; the server has its own
+    if (origin != CHANGE_LOCAL || !StorageManager::persistenceEnabled()) return;
+    notePending(event.uid, EventDelta::UPSERT, event.stamp);
+}
+
+void SyncEngine::eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) {
+    if (origin == CHANGE_SERVER || !StorageManager::persistenceEnabled()) return;
+    merger_.noteRemove(uid, stamp);
+    if (origin == CHANGE_LOCAL) notePending(uid, EventDelta::REMOVE, stamp);
+}
+
+void SyncEngine::notePending(uint64_t uid, EventDelta::Kind kind, uint64_t stamp) {
+    MEMORY_SCOPE(MEM_STORAGE);
+    PendingOp& op = pending_[uid];
+    op.kind = kind;
+    op.stamp = stamp;
+    edited_ = true;
+    logDirty_ = true;
+}
+
+bool SyncEngine::poll(double nowMs) {
+    // The stored calendar has to be in before the log is replayed against it
+    if (!started_ || !StorageManager::persistenceEnabled() || PersistenceWorker::instance().loading()) {
+        return false;
+    }
+    MEMORY_SCOPE(MEM_STORAGE);
+
+    if (edited_) {
+        edited_ = false;
+        lastEditMs_ = nowMs;
+        if (firstEditMs_ < 0.0) firstEditMs_ = nowMs;
+    }
+
+    bool changed = false;
+    if (exchanging_) {
+        SyncTransportStatus status = transport_.receive(response_);
+        if (status != SYNC_PENDING) {
+            exchanging_ = false;
+            if (status == SYNC_DONE && decodeSyncMessage(response_, message_)) {
+                bytesReceived_ += response_.size();
+                changed = finishExchange(nowMs);
+            } else {
+                failExchange(nowMs);
+            }
+        }
+    }
+    if (!exchanging_ && dueForExchange(nowMs)) startExchange();
+    if (saveAtMs_ >= 0.0 && nowMs >= saveAtMs_) {
+        saveAtMs_ = -1.0;
+        StorageManager::saveEventsToStorage(events_.getAllEvents());
+        savedCursor_ = cursor_;
+        logDirty_ = true;
+    }
+    if (logDirty_) saveLog();
+    return changed;
+}
+
+bool SyncEngine::dueForExchange(double nowMs) const {
+    if (nowMs < retryAtMs_) return false;
+    if (syncNow_ || nowMs >= nextPullMs_) return true;
+    if (pending_.empty()) return false;
+    return nowMs - lastEditMs_ >= kPushDelayMs || nowMs - firstEditMs_ >= kMaxPushWaitMs;
+}
+
+void SyncEngine::startExchange() {
+    PROFILE_SCOPE("sync.push");
+    mergeStoredLog();
+
+    message_.cursor = cursor_;
+    message_.more = false;
+    message_.deltas.clear();
+    inFlight_.clear();
+    for (auto it = pending_.begin(); it != pending_.end() && message_.deltas.size() < kMaxPushDeltas;) {
+        uint64_t uid = it->first;
+        const PendingOp& op = it->second;
+        if (op.kind == EventDelta::UPSERT) {
+            // Sent as it is now, which may be newer than the logged change
+            Event* current = events_.findByUid(uid);
+            if (!current) {
+                // Replaced by a load or a replay without a removal to log
+                it = pending_.erase(it);
+                logDirty_ = true;
+                continue;
+            }
+            message_.deltas.emplace_back();
+            EventDelta& delta = message_.deltas.back();
+            delta.kind = EventDelta::UPSERT;
+            delta.uid = uid;
+            delta.stamp = current->stamp;
+            MEMORY_SCOPE(MEM_TEXT);
+            delta.event = *current;
+        } else {
+            message_.deltas.emplace_back();
+            EventDelta& delta = message_.deltas.back();
+            delta.kind = EventDelta::REMOVE;
+            delta.uid = uid;
+            delta.stamp = op.stamp;
+        }
+        inFlight_.push_back({uid, message_.deltas.back().stamp});
+        ++it;
+    }
+
+    encodeSyncMessage(message_, request_);
+    if (!transport_.send(request_)) return;
+    exchanging_ = true;
+    syncNow_ = false;
+    bytesSent_ += request_.size();
+}
+
+bool SyncEngine::finishExchange(double nowMs) {
+    PROFILE_SCOPE("sync.pull");
+    online_ = true;
+    backoffMs_ = 0.0;
+    retryAtMs_ = 0.0;
+    nextPullMs_ = nowMs + kPullIntervalMs;
+
+    // Edits made while the exchange ran stay pending
+    bool fullBatch = inFlight_.size() >= kMaxPushDeltas;
+    for (const Sent& sent : inFlight_) {
+        auto it = pending_.find(sent.uid);
+        if (it != pending_.end() && it->second.stamp <= sent.stamp) pending_.erase(it);
+        uint64_t& acked = acked_[sent.uid];
+        acked = std::max(acked, sent.stamp);
+    }
+    deltasPushed_ += inFlight_.size();
+    inFlight_.clear();
+    if (pending_.empty()) firstEditMs_ = -1.0;
+
+    bool changed = merger_.applyAll(events_, message_.deltas, CHANGE_SERVER) > 0;
+    deltasPulled_ += message_.deltas.size();
+    cursor_ = message_.cursor;
+    logDirty_ = true;
+    syncNow_ = message_.more || fullBatch;
+
+    if (changed && saveAtMs_ < 0.0) saveAtMs_ = nowMs + kSaveDelayMs;
+    // With nothing waiting to be saved, storage is as current as the cursor
+    if (saveAtMs_ < 0.0) savedCursor_ = cursor_;
+    return changed;
+}
+
+void SyncEngine::failExchange(double nowMs) {
+    online_ = false;
+    inFlight_.clear();
+    backoffMs_ = std::min(kMaxBackoffMs, std::max(kMinBackoffMs, backoffMs_ * 2.0));
+    retryAtMs_ = nowMs + backoffMs_;
+}
+
+void SyncEngine::mergeStoredLog() {
+    std::string stored;
+    if (!StorageBackend::read(kStorageKey, stored)) return;
+    const char* p = stored.c_str();
+    const char* firstOp = strchr(p, '\n');
+    if (!firstOp) return;
+    p = firstOp + 1;
+
+    char kind;
+    uint64_t uid, stamp;
+    while (parseLine(p, kind, uid, stamp)) {
+        // Pushed by this tab since the log was written
+        auto acked = acked_.find(uid);
+        if (acked != acked_.end() && acked->second >= stamp) continue;
+        auto it = pending_.find(uid);
+        if (it != pending_.end() && it->second.stamp >= stamp) continue;
+        MEMORY_SCOPE(MEM_STORAGE);
+        PendingOp& op = pending_[uid];
+        op.kind = kind == 'U' ? EventDelta::UPSERT : EventDelta::REMOVE;
+        op.stamp = stamp;
+    }
+}
+
+void SyncEngine::saveLog() {
+    PROFILE_SCOPE("sync.log");
+    // Another tab may have logged edits since; keep them
+    mergeStoredLog();
+    acked_.clear();
+    logDirty_ = false;
+
+    std::string log;
+    log.reserve(24 + pending_.size() * 36);
+    char line[48];
+    snprintf(line, sizeof(line), "cursor %llx\n", (unsigned long long)savedCursor_);
+    log += line;
+    for (const auto& entry : pending_) {
+        snprintf(line, sizeof(line), "%c %llx %llx\n", entry.second.kind == EventDelta::UPSERT ? 'U' : 'R',
+                 (unsigned long long)entry.first, (unsigned long long)entry.second.stamp);
+        log += line;
+    }
+    StorageBackend::write(kStorageKey, log);
+}
+
+} // namespace calendar
@@ -0,0 +1,117 @@
+#ifndef SYNC_ENGINE_H
+#define SYNC_ENGINE_H
+
+#include "event.h"
+#include "event_delta.h"
+#include "sync_transport.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace calendar {
+
+// Offline-first sync of the calendar with a server through a pluggable
+// SyncTransport. Local edits go into an operation log keyed by event uid,
+// so repeated edits of one event while offline collapse into one entry
+// that is sent with the event's state at push time. Each exchange pushes
+// the log (in batches of kMaxPushDeltas) and pulls what the server
+// recorded since the cursor of the previous exchange; pulled deltas are
+// merged last-writer-wins like those from other tabs. The log and the
+// cursor are kept in storage, shared by all tabs, so edits made offline
+// survive a reload and are pushed by whichever tab is open.
+//
+// Pushes wait kPushDelayMs after the last edit, so a burst of edits goes
+// out as one request, and at most kMaxPushWaitMs after the first. With
+// nothing to push the server is asked every kPullIntervalMs. A failed
+// exchange is retried with exponential backoff up to kMaxBackoffMs. Like
+// TabSync it stands still while persistence is off.
+//
+// Saving costs the whole calendar, so pulled changes are saved at most
+// once per kSaveDelayMs however many exchanges bring them. The cursor in
+// the stored log only moves past them once they are, so a tab closed in
+// between pulls them again.
+class SyncEngine : public EventListener {
+public:
+    static constexpr const char* kStorageKey = "calendar_sync";
+    static constexpr double kPushDelayMs = 500.0;
+    static constexpr double kMaxPushWaitMs = 5000.0;
+    static constexpr double kPullIntervalMs = 30000.0;
+    static constexpr double kMinBackoffMs = 1000.0;
+    static constexpr double kMaxBackoffMs = 60000.0;
+    static constexpr double kSaveDelayMs = 2000.0;
+    static const size_t kMaxPushDeltas = 1000;
+
+    SyncEngine(EventManager& events, SyncTransport& transport);
+    ~SyncEngine();
+
+    // Reads the stored log and cursor; the first poll() then syncs
+    void start();
+    // Once per main loop iteration. True if server changes were applied.
+    bool poll(double nowMs);
+
+    void eventChanged(const Event& event, ChangeOrigin origin) override;
+    void eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) override;
+
+    uint64_t cursor() const { return cursor_; }
+    size_t pendingCount() const { return pending_.size(); }
+    bool exchanging() const { return exchanging_; }
+    // False once an exchange has failed, until one succeeds
+    bool online() const { return online_; }
+    uint64_t bytesSent() const { return bytesSent_; }
+    uint64_t bytesReceived() const { return bytesReceived_; }
+    uint64_t deltasPushed() const { return deltasPushed_; }
+    uint64_t deltasPulled() const { return deltasPulled_; }
+
+private:
+    struct PendingOp {
+        EventDelta::Kind kind;
+        uint64_t stamp;   // the change to push; later changes replace it
+    };
+
+    struct Sent {
+        uint64_t uid;
+        uint64_t stamp;
+    };
+
+    bool dueForExchange(double nowMs) const;
+    void startExchange();
+    bool finishExchange(double nowMs);
+    void failExchange(double nowMs);
+    void notePending(uint64_t uid, EventDelta::Kind kind, uint64_t stamp);
+    // Folds in ops other tabs stored and this tab has not pushed
+    void mergeStoredLog();
+    void saveLog();
+
+    EventManager& events_;
+    SyncTransport& transport_;
+    DeltaMerger merger_;
+    std::unordered_map<uint64_t, PendingOp> pending_;   // uid -> newest unpushed change
+    std::unordered_map<uint64_t, uint64_t> acked_;      // pushed since the last saveLog()
+    std::vector<Sent> inFlight_;
+    SyncMessage message_;
+    std::string request_;
+    std::string response_;
+    uint64_t cursor_;
+    uint64_t savedCursor_;   // cursor whose pulled changes are in storage
+    bool started_;
+    bool exchanging_;
+    bool online_;
+    bool edited_;        // local change since the last poll
+    bool logDirty_;
+    bool syncNow_;       // more to push or pull than the last exchange took
+    double firstEditMs_; // oldest unpushed edit, -1 if none
+    double saveAtMs_;    // when pulled changes are saved, -1 if none wait
+    double lastEditMs_;
+    double nextPullMs_;
+    double retryAtMs_;
+    double backoffMs_;
+    uint64_t bytesSent_;
+    uint64_t bytesReceived_;
+    uint64_t deltasPushed_;
+    uint64_t deltasPulled_;
+};
+
+} // namespace calendar
+
+#endif // SYNC_ENGINE_H
@@ -0,0 +1,23 @@
+#include "sync_transport.h"
+
+namespace calendar {
+
+HttpSyncTransport::HttpSyncTransport(const std::string& url) : url_(url), pending_(false) {}
+
+bool HttpSyncTransport::configuredUrl(std::string&) {
+    return false;
+}
+
+bool HttpSyncTransport::send(const std::string&) {
+    if (pending_) return false;
+    pending_ = true;
+    return true;
+}
+
+SyncTransportStatus HttpSyncTransport::receive(std::string&) {
+    if (!pending_) return SYNC_IDLE;
+    pending_ = false;
+    return SYNC_FAILED;
+}
+
+} // namespace calendar
@@ -0,0 +1,69 @@
+#include "sync_transport.h"
+#include <emscripten.h>
+#include <cstdlib>
+
+namespace calendar {
+
+HttpSyncTransport::HttpSyncTransport(const std::string& url) : url_(url), pending_(false) {}
+
+bool HttpSyncTransport::configuredUrl(std::string& out) {
+    char* url = (char*)EM_ASM_PTR({
+        const url = new URLSearchParams(location.search).get('sync');
+        if (!url) return null;
+        const len = lengthBytesUTF8(url) + 1;
+        const ptr = _malloc(len);
+        stringToUTF8(url, ptr, len);
+        return ptr;
+    });
+
+    if (!url) return false;
+    out = url;
+    free(url);
+    return true;
+}
+
+bool HttpSyncTransport::send(const std::string& request) {
+    if (pending_) return false;
+    pending_ = true;
+    // slice() copies out of the wasm heap before anything is awaited;
+    // CompressionStream is missing in older browsers, which send as is
+    EM_ASM({
+        const url = UTF8ToString($0);
+        const body = HEAPU8.slice($1, $1 + $2);
+        const exchange = { status: $4, answer: null };
+        Module.syncExchange = exchange;
+        (async function() {
+            const headers = { 'Content-Type': 'application/octet-stream' };
+            let payload = body;
+            if (body.length >= $3 && typeof CompressionStream !== 'undefined') {
+                const stream = new Blob([body]).stream().pipeThrough(new CompressionStream('deflate'));
+                payload = new Uint8Array(await new Response(stream).arrayBuffer());
+                headers['Content-Encoding'] = 'deflate';
+            }
+            const reply = await fetch(url, { method: 'POST', headers: headers, body: payload, cache: 'no-store' });
+            if (!reply.ok) throw new Error('sync: HTTP ' + reply.status);
+            exchange.answer = new Uint8Array(await reply.arrayBuffer());
+            exchange.status = $5;
+        })().catch(function() { exchange.status = $6; });
+    }, url_.c_str(), request.data(), request.size(), (int)kCompressMinBytes,
+       SYNC_PENDING, SYNC_DONE, SYNC_FAILED);
+    return true;
+}
+
+SyncTransportStatus HttpSyncTransport::receive(std::string& response) {
+    if (!pending_) return SYNC_IDLE;
+    int status = EM_ASM_INT({ return Module.syncExchange.status; });
+    if (status == SYNC_PENDING) return SYNC_PENDING;
+    pending_ = false;
+    if (status == SYNC_DONE) {
+        int size = EM_ASM_INT({ return Module.syncExchange.answer.length; });
+        response.resize(size);
+        EM_ASM({
+            if ($1) HEAPU8.set(Module.syncExchange.answer, $0);
+        }, response.data(), size);
+    }
+    EM_ASM({ Module.syncExchange = null; });
+    return (SyncTransportStatus)status;
+}
+
+} // namespace calendar
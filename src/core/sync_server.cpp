@@ -0,0 +1,46 @@
+#include "sync_server.h"
+
+namespace calendar {
+
+SyncServer::SyncServer() : nextSequence_(1) {}
+
+bool SyncServer::handle(const std::string& request, std::string& response) {
+    if (!decodeSyncMessage(request, request_)) return false;
+    // A cursor from before the server was reset: start the client over
+    if (request_.cursor > head()) request_.cursor = 0;
+
+    // Collected before the request's own changes are recorded, so they are
+    // not echoed back
+    answer_.deltas.clear();
+    answer_.more = false;
+    auto entry = log_.upper_bound(request_.cursor);
+    for (; entry != log_.end(); ++entry) {
+        if (answer_.deltas.size() == kMaxDeltasPerAnswer) {
+            answer_.more = true;
+            break;
+        }
+        answer_.deltas.push_back(records_[entry->second].delta);
+        answer_.cursor = entry->first;
+    }
+
+    for (EventDelta& delta : request_.deltas) {
+        auto it = records_.find(delta.uid);
+        if (it != records_.end()) {
+            if (it->second.delta.stamp >= delta.stamp) continue;
+            log_.erase(it->second.sequence);
+        } else {
+            it = records_.emplace(delta.uid, Record()).first;
+        }
+        it->second.sequence = nextSequence_++;
+        it->second.delta = std::move(delta);
+        log_[it->second.sequence] = it->first;
+    }
+
+    // A cut-short answer resumes where it stopped, changes from this
+    // request included
+    if (!answer_.more) answer_.cursor = head();
+    encodeSyncMessage(answer_, response);
+    return true;
+}
+
+} // namespace calendar
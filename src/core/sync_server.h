@@ -0,0 +1,46 @@
+#ifndef SYNC_SERVER_H
+#define SYNC_SERVER_H
+
+#include "event_delta.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace calendar {
+
+// In-process reference implementation of the sync endpoint, for native
+// builds and benchmarks; web/serve.py's /sync endpoint does the same. It
+// keeps one record per event uid, the newest by stamp, numbered by the
+// sequence clients use as their cursor. A change takes a new number and
+// gives up its old one, so a client catching up after any time offline
+// gets each changed event once, in its current state, and nothing else.
+// Removals are kept as tombstones.
+class SyncServer {
+public:
+    static const size_t kMaxDeltasPerAnswer = 1000;
+
+    SyncServer();
+
+    // Takes an encoded SyncMessage; false if it is malformed
+    bool handle(const std::string& request, std::string& response);
+
+    uint64_t head() const { return nextSequence_ - 1; }
+    size_t recordCount() const { return records_.size(); }
+
+private:
+    struct Record {
+        uint64_t sequence;
+        EventDelta delta;
+    };
+
+    std::unordered_map<uint64_t, Record> records_;  // uid -> newest change
+    std::map<uint64_t, uint64_t> log_;              // sequence -> uid, current records only
+    uint64_t nextSequence_;
+    SyncMessage request_;
+    SyncMessage answer_;
+};
+
+} // namespace calendar
+
+#endif // SYNC_SERVER_H
@@ -0,0 +1,23 @@
+#include "sync_transport.h"
+#include "sync_server.h"
+
+namespace calendar {
+
+LocalSyncTransport::LocalSyncTransport(SyncServer& server)
+    : server_(server), status_(SYNC_IDLE), online_(true) {}
+
+bool LocalSyncTransport::send(const std::string& request) {
+    if (status_ != SYNC_IDLE) return false;
+    bool answered = online_ && server_.handle(request, response_);
+    status_ = answered ? SYNC_DONE : SYNC_FAILED;
+    return true;
+}
+
+SyncTransportStatus LocalSyncTransport::receive(std::string& response) {
+    SyncTransportStatus status = status_;
+    if (status == SYNC_DONE) response.swap(response_);
+    if (status != SYNC_PENDING) status_ = SYNC_IDLE;
+    return status;
+}
+
+} // namespace calendar
@@ -0,0 +1,73 @@
+#ifndef SYNC_TRANSPORT_H
+#define SYNC_TRANSPORT_H
+
+#include <string>
+
+namespace calendar {
+
+class SyncServer;
+
+enum SyncTransportStatus {
+    SYNC_IDLE,      // nothing sent
+    SYNC_PENDING,   // waiting for the answer
+    SYNC_DONE,      // answer received
+    SYNC_FAILED     // offline, unreachable or refused
+};
+
+// Carries one encoded SyncMessage to the sync endpoint and its answer
+// back. Exchanges are asynchronous and one at a time; the engine polls.
+class SyncTransport {
+public:
+    virtual ~SyncTransport() = default;
+
+    // False if an exchange is still running
+    virtual bool send(const std::string& request) = 0;
+    // SYNC_DONE (with response filled in) and SYNC_FAILED are reported
+    // once; the transport is idle again afterwards
+    virtual SyncTransportStatus receive(std::string& response) = 0;
+};
+
+// Talks to a SyncServer in the same process, answering on the next
+// receive(). setOnline(false) makes exchanges fail, to exercise offline
+// editing and catch-up.
+class LocalSyncTransport : public SyncTransport {
+public:
+    explicit LocalSyncTransport(SyncServer& server);
+
+    bool send(const std::string& request) override;
+    SyncTransportStatus receive(std::string& response) override;
+
+    void setOnline(bool online) { online_ = online; }
+
+private:
+    SyncServer& server_;
+    SyncTransportStatus status_;
+    std::string response_;
+    bool online_;
+};
+
+// POSTs to an HTTP endpoint with fetch(). Bodies over kCompressMinBytes
+// are deflated on the way out (Content-Encoding: deflate) and answers are
+// taken compressed the same way. The browser build links
+// sync_http_web.cpp; native builds link sync_http_native.cpp, where every
+// exchange fails.
+class HttpSyncTransport : public SyncTransport {
+public:
+    static const size_t kCompressMinBytes = 1024;
+
+    explicit HttpSyncTransport(const std::string& url);
+
+    // The endpoint the page was opened with (?sync=<url>), if any
+    static bool configuredUrl(std::string& out);
+
+    bool send(const std::string& request) override;
+    SyncTransportStatus receive(std::string& response) override;
+
+private:
+    std::string url_;
+    bool pending_;
+};
+
+} // namespace calendar
+
+#endif // SYNC_TRANSPORT_H
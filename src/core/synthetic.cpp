@@ -0,0 +1,316 @@
+#include "synthetic.h"
+#include "calendar.h"
+#include <cstdio>
+#include <cstring>
+
+namespace calendar {
+
+namespace {
+
+const char* const kWords[] = {
+    "Standup", "Review", "Planning", "Lunch", "Sync", "Design", "Budget", "Interview",
+    "Retro", "Demo", "Call", "Workshop", "Dentist", "Gym", "Release", "Offsite",
+    "with", "team", "client", "Q3", "roadmap", "1:1", "hiring", "infra"
+};
+const int kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+const char* const kRules[] = {
+    "FREQ=DAILY", "FREQ=WEEKLY;BYDAY=MO,WE,FR", "FREQ=MONTHLY;BYMONTHDAY=1", "FREQ=WEEKLY;INTERVAL=2"
+};
+
+const int kReminderMinutes[] = {0, 5, 10, 15, 30, 60, 24 * 60};
+
+void appendInt(int value, std::string& out) {
+    char buffer[16];
+    int len = snprintf(buffer, sizeof(buffer), "%d", value);
+    out.append(buffer, len);
+}
+
+// Text is written raw: the legacy layouts did not escape it
+void appendRawText(const std::string& text, std::string& out) {
+    out += '"';
+    out += text;
+    out += '"';
+}
+
+} // namespace
+
+uint64_t SyntheticRng::next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int SyntheticRng::range(int lo, int hi) {
+    return lo + (int)(next() % (uint64_t)(hi - lo + 1));
+}
+
+double SyntheticRng::unit() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+bool parseDistribution(const char* name, Distribution& out) {
+    if (strcmp(name, "uniform") == 0) out = DIST_UNIFORM;
+    else if (strcmp(name, "workday") == 0) out = DIST_WORKDAY;
+    else if (strcmp(name, "bursty") == 0) out = DIST_BURSTY;
+    else return false;
+    return true;
+}
+
+const char* distributionName(Distribution distribution) {
+    switch (distribution) {
+        case DIST_UNIFORM: return "uniform";
+        case DIST_WORKDAY: return "workday";
+        case DIST_BURSTY: return "bursty";
+    }
+    return "unknown";
+}
+
+void generateEvents(const DatasetOptions& options, std::vector<Event>& out) {
+    SyntheticRng rng(options.seed);
+    // Separate stream, so reminders leave the rest of a seed's calendar as it was
+    SyntheticRng reminderRng(options.seed ^ 0x5EED5EED5EED5EEDull);
+    SyntheticRng tagRng(options.seed ^ 0x7A657A657A657A65ull);
+    int firstDay = CalendarLogic::toDayNumber(1, 0, options.startYear);
+    int numDays = CalendarLogic::toDayNumber(1, 0, options.startYear + options.years) - firstDay;
+
+    // Bursty calendars draw most events from a small set of hot days
+    std::vector<int> hotDays;
+    if (options.distribution == DIST_BURSTY) {
+        int hotCount = numDays / 20 > 0 ? numDays / 20 : 1;
+        for (int i = 0; i < hotCount; i++) hotDays.push_back(rng.range(0, numDays - 1));
+    }
+
+    out.reserve(out.size() + options.count);
+    for (size_t i = 0; i < options.count; i++) {
+        int dayOffset = rng.range(0, numDays - 1);
+        if (options.distribution == DIST_WORKDAY) {
+            // Re-roll weekends most of the time
+            for (;;) {
+                int day, month, year;
+                CalendarLogic::fromDayNumber(firstDay + dayOffset, day, month, year);
+                int dayOfWeek = CalendarLogic::getDayOfWeek(day, month, year);
+                if ((dayOfWeek != 0 && dayOfWeek != 6) || rng.unit() < 0.1) break;
+                dayOffset = rng.range(0, numDays - 1);
+            }
+        } else if (options.distribution == DIST_BURSTY && rng.unit() < 0.8) {
+            dayOffset = hotDays[rng.range(0, (int)hotDays.size() - 1)];
+        }
+
+        Event evt;
+        CalendarLogic::fromDayNumber(firstDay + dayOffset, evt.day, evt.month, evt.year);
+
+        if (rng.unit() < options.allDayFraction) {
+            evt.isAllDay = true;
+        } else {
+            int start, duration;
+            if (options.distribution == DIST_WORKDAY) {
+                start = rng.range(8 * 4, 17 * 4) * 15;
+                static const int durations[] = {15, 30, 30, 60, 60, 60, 90, 120};
+                duration = durations[rng.range(0, 7)];
+            } else {
+                start = rng.range(0, 23 * 12) * 5;
+                duration = rng.range(1, 36) * 5;
+            }
+            int end = start + duration;
+            if (end > 23 * 60 + 59) end = 23 * 60 + 59;
+            evt.hourStart = start / 60;
+            evt.minuteStart = start % 60;
+            evt.hourEnd = end / 60;
+            evt.minuteEnd = end % 60;
+        }
+
+        int words = rng.range(1, 6);
+        for (int w = 0; w < words; w++) {
+            if (w > 0) evt.text += ' ';
+            evt.text += kWords[rng.range(0, kWordCount - 1)];
+        }
+        if (rng.unit() < options.recurringFraction) {
+            evt.recurrence = kRules[rng.range(0, 3)];
+        }
+        if (reminderRng.unit() < options.reminderFraction) {
+            evt.reminderMinutes = kReminderMinutes[reminderRng.range(0, 6)];
+        }
+        if (options.tagCount > 0) {
+            evt.tags = 1ull << tagRng.range(0, options.tagCount - 1);
+            if (tagRng.unit() < 0.2) evt.tags |= 1ull << tagRng.range(0, options.tagCount - 1);
+        }
+        out.push_back(std::move(evt));
+    }
+}
+
+// v0: [{"day":..,"month":..,"year":..,"hour":..,"minute":..,"text":"..."}]
+std::string writeLegacyV0(const std::vector<Event>& events) {
+    std::string json;
+    json.reserve(2 + events.size() * 96);
+    json += '[';
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& evt = events[i];
+        if (i > 0) json += ',';
+        json += "{\"day\":";
+        appendInt(evt.day, json);
+        json += ",\"month\":";
+        appendInt(evt.month, json);
+        json += ",\"year\":";
+        appendInt(evt.year, json);
+        if (evt.hourStart != -1) {
+            json += ",\"hour\":";
+            appendInt(evt.hourStart, json);
+            json += ",\"minute\":";
+            appendInt(evt.minuteStart, json);
+        }
+        json += ",\"text\":";
+        appendRawText(evt.text, json);
+        json += '}';
+    }
+    json += ']';
+    return json;
+}
+
+// v1: the v2 fields as a bare array, rrule only when set, text unescaped
+std::string writeLegacyV1(const std::vector<Event>& events) {
+    std::string json;
+    json.reserve(2 + events.size() * 160);
+    json += '[';
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& evt = events[i];
+        if (i > 0) json += ',';
+        json += "{\"day\":";
+        appendInt(evt.day, json);
+        json += ",\"month\":";
+        appendInt(evt.month, json);
+        json += ",\"year\":";
+        appendInt(evt.year, json);
+        json += ",\"hourStart\":";
+        appendInt(evt.hourStart, json);
+        json += ",\"minuteStart\":";
+        appendInt(evt.minuteStart, json);
+        json += ",\"hourEnd\":";
+        appendInt(evt.hourEnd, json);
+        json += ",\"minuteEnd\":";
+        appendInt(evt.minuteEnd, json);
+        json += evt.isAllDay ? ",\"isAllDay\":true" : ",\"isAllDay\":false";
+        if (!evt.recurrence.empty()) {
+            json += ",\"rrule\":";
+            appendRawText(evt.recurrence, json);
+        }
+        json += ",\"text\":";
+        appendRawText(evt.text, json);
+        json += '}';
+    }
+    json += ']';
+    return json;
+}
+
+// v2: the current layout without uid and stamp. Synthetic text needs no
+// escaping.
+std::string writeLegacyV2(const std::vector<Event>& events) {
+    std::string json;
+    json.reserve(32 + events.size() * 160);
+    json += "{\"version\":2,\"events\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& evt = events[i];
+        if (i > 0) json += ',';
+        json += "{\"day\":";
+        appendInt(evt.day, json);
+        json += ",\"month\":";
+        appendInt(evt.month, json);
+        json += ",\"year\":";
+        appendInt(evt.year, json);
+        json += ",\"hourStart\":";
+        appendInt(evt.hourStart, json);
+        json += ",\"minuteStart\":";
+        appendInt(evt.minuteStart, json);
+        json += ",\"hourEnd\":";
+        appendInt(evt.hourEnd, json);
+        json += ",\"minuteEnd\":";
+        appendInt(evt.minuteEnd, json);
+        json += evt.isAllDay ? ",\"isAllDay\":true" : ",\"isAllDay\":false";
+        json += ",\"rrule\":";
+        appendRawText(evt.recurrence, json);
+        json += ",\"text\":";
+        appendRawText(evt.text, json);
+        json += '}';
+    }
+    json += "]}";
+    return json;
+}
+
+// v3: versioned object with uid and stamp as quoted hex, no reminders
+std::string writeLegacyV3(const std::vector<Event>& events) {
+    std::string json;
+    json.reserve(32 + events.size() * 210);
+    json += "{\"version\":3,\"events\":[";
+    char hex[48];
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& evt = events[i];
+        if (i > 0) json += ',';
+        snprintf(hex, sizeof(hex), "{\"uid\":\"%llx\",\"stamp\":\"%llx\"",
+                 (unsigned long long)evt.uid, (unsigned long long)evt.stamp);
+        json += hex;
+        json += ",\"day\":";
+        appendInt(evt.day, json);
+        json += ",\"month\":";
+        appendInt(evt.month, json);
+        json += ",\"year\":";
+        appendInt(evt.year, json);
+        json += ",\"hourStart\":";
+        appendInt(evt.hourStart, json);
+        json += ",\"minuteStart\":";
+        appendInt(evt.minuteStart, json);
+        json += ",\"hourEnd\":";
+        appendInt(evt.hourEnd, json);
+        json += ",\"minuteEnd\":";
+        appendInt(evt.minuteEnd, json);
+        json += evt.isAllDay ? ",\"isAllDay\":true" : ",\"isAllDay\":false";
+        json += ",\"rrule\":";
+        appendRawText(evt.recurrence, json);
+        json += ",\"text\":";
+        appendRawText(evt.text, json);
+        json += '}';
+    }
+    json += "]}";
+    return json;
+}
+
+// v4: the current layout without tags
+std::string writeLegacyV4(const std::vector<Event>& events) {
+    std::string json;
+    json.reserve(32 + events.size() * 222);
+    json += "{\"version\":4,\"events\":[";
+    char hex[48];
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& evt = events[i];
+        if (i > 0) json += ',';
+        snprintf(hex, sizeof(hex), "{\"uid\":\"%llx\",\"stamp\":\"%llx\"",
+                 (unsigned long long)evt.uid, (unsigned long long)evt.stamp);
+        json += hex;
+        json += ",\"day\":";
+        appendInt(evt.day, json);
+        json += ",\"month\":";
+        appendInt(evt.month, json);
+        json += ",\"year\":";
+        appendInt(evt.year, json);
+        json += ",\"hourStart\":";
+        appendInt(evt.hourStart, json);
+        json += ",\"minuteStart\":";
+        appendInt(evt.minuteStart, json);
+        json += ",\"hourEnd\":";
+        appendInt(evt.hourEnd, json);
+        json += ",\"minuteEnd\":";
+        appendInt(evt.minuteEnd, json);
+        json += evt.isAllDay ? ",\"isAllDay\":true" : ",\"isAllDay\":false";
+        json += ",\"remind\":";
+        appendInt(evt.reminderMinutes, json);
+        json += ",\"rrule\":";
+        appendRawText(evt.recurrence, json);
+        json += ",\"text\":";
+        appendRawText(evt.text, json);
+        json += '}';
+    }
+    json += "]}";
+    return json;
+}
+
+} // namespace calendar
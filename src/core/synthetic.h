@@ -0,0 +1,58 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include "event.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace calendar {
+
+// Deterministic synthetic calendars for benchmarks and trace replay. The
+// generator uses its own PRNG rather than <random> distributions, so a seed
+// produces the same events with every compiler and standard library.
+enum Distribution {
+    DIST_UNIFORM,   // any day, any hour
+    DIST_WORKDAY,   // weekdays, office hours, meeting-sized durations
+    DIST_BURSTY     // 80% of events on 5% of the days
+};
+
+struct DatasetOptions {
+    size_t count = 10000;
+    Distribution distribution = DIST_WORKDAY;
+    int startYear = 2024;
+    int years = 2;
+    double allDayFraction = 0.1;
+    double recurringFraction = 0.05;
+    double reminderFraction = 0.2;
+    int tagCount = 6;           // each event gets one of the first tagCount tags, a fifth a second
+    uint64_t seed = 42;
+};
+
+class SyntheticRng {
+public:
+    explicit SyntheticRng(uint64_t seed) : state_(seed) {}
+
+    uint64_t next();                        // splitmix64
+    int range(int lo, int hi);              // inclusive
+    double unit();                          // [0, 1)
+
+private:
+    uint64_t state_;
+};
+
+bool parseDistribution(const char* name, Distribution& out);
+const char* distributionName(Distribution distribution);
+
+void generateEvents(const DatasetOptions& options, std::vector<Event>& out);
+
+// Payloads in the older layouts StorageManager still migrates from
+std::string writeLegacyV0(const std::vector<Event>& events);
+std::string writeLegacyV1(const std::vector<Event>& events);
+std::string writeLegacyV2(const std::vector<Event>& events);
+std::string writeLegacyV3(const std::vector<Event>& events);
+std::string writeLegacyV4(const std::vector<Event>& events);
+
+} // namespace calendar
+
+#endif // SYNTHETIC_H
@@ -0,0 +1,22 @@
+#ifndef TAB_CHANNEL_H
+#define TAB_CHANNEL_H
+
+#include <string>
+
+namespace calendar {
+
+// Binary messages to and from other tabs of the same origin. The browser
+// build links tab_channel_web.cpp (BroadcastChannel); native builds link
+// tab_channel_native.cpp, where there are no other tabs.
+class TabChannel {
+public:
+    // False if the platform has no channel to open
+    static bool open(const char* name);
+    static void post(const std::string& message);
+    // Oldest message another tab posted that has not been received yet
+    static bool receive(std::string& out);
+};
+
+} // namespace calendar
+
+#endif // TAB_CHANNEL_H
@@ -0,0 +1,15 @@
+#include "tab_channel.h"
+
+namespace calendar {
+
+bool TabChannel::open(const char*) {
+    return false;
+}
+
+void TabChannel::post(const std::string&) {}
+
+bool TabChannel::receive(std::string&) {
+    return false;
+}
+
+} // namespace calendar
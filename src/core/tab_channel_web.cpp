@@ -0,0 +1,38 @@
+#include "tab_channel.h"
+#include <emscripten.h>
+
+namespace calendar {
+
+bool TabChannel::open(const char* name) {
+    return EM_ASM_INT({
+        if (typeof BroadcastChannel === 'undefined') return 0;
+        Module.tabInbox = [];
+        Module.tabChannel = new BroadcastChannel(UTF8ToString($0));
+        Module.tabChannel.onmessage = function(e) {
+            Module.tabInbox.push(new Uint8Array(e.data));
+        };
+        return 1;
+    }, name) != 0;
+}
+
+void TabChannel::post(const std::string& message) {
+    // slice() copies out of the wasm heap, which may be shared memory
+    EM_ASM({
+        if (Module.tabChannel) Module.tabChannel.postMessage(HEAPU8.slice($0, $0 + $1).buffer);
+    }, message.data(), message.size());
+}
+
+bool TabChannel::receive(std::string& out) {
+    int size = EM_ASM_INT({
+        return Module.tabInbox && Module.tabInbox.length ? Module.tabInbox[0].length : -1;
+    });
+    if (size < 0) return false;
+    out.resize(size);
+    EM_ASM({
+        const message = Module.tabInbox.shift();
+        if (message.length) HEAPU8.set(message, $0);
+    }, out.data());
+    return true;
+}
+
+} // namespace calendar
@@ -0,0 +1,74 @@
+#include "tab_sync.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+#include "storage.h"
+#include "tab_channel.h"
+
+namespace calendar {
+
+TabSync::TabSync(EventManager& events)
+    : events_(events), open_(false), deltasSent_(0), deltasApplied_(0) {
+    events_.addListener(this);
+}
+
+TabSync::~TabSync() {
+    events_.removeListener(this);
+}
+
+bool TabSync::start() {
+    open_ = TabChannel::open(kChannelName);
+    return open_;
+}
+
+void TabSync::eventChanged(const Event& event, ChangeOrigin origin) {
+    // Every tab already has what another tab sent
+    if (!open_ || origin == CHANGE_TAB || !StorageManager::persistenceEnabled()) return;
+    MEMORY_SCOPE(MEM_STORAGE);
+    outbox_.emplace_back();
+    EventDelta& delta = outbox_.back();
+    delta.kind = EventDelta::UPSERT;
+    delta.uid = event.uid;
+    delta.stamp = event.stamp;
+    {
+        MEMORY_SCOPE(MEM_TEXT);
+        delta.event = event;
+    }
+}
+
+void TabSync::eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) {
+    if (!open_ || origin == CHANGE_TAB || !StorageManager::persistenceEnabled()) return;
+    MEMORY_SCOPE(MEM_STORAGE);
+    merger_.noteRemove(uid, stamp);
+    outbox_.emplace_back();
+    EventDelta& delta = outbox_.back();
+    delta.kind = EventDelta::REMOVE;
+    delta.uid = uid;
+    delta.stamp = stamp;
+}
+
+bool TabSync::poll() {
+    if (!open_) return false;
+    MEMORY_SCOPE(MEM_STORAGE);
+
+    if (!outbox_.empty()) {
+        PROFILE_SCOPE("sync.post");
+        encodeDeltas(outbox_, message_);
+        TabChannel::post(message_);
+        deltasSent_ += outbox_.size();
+        outbox_.clear();
+    }
+
+    bool changed = false;
+    while (TabChannel::receive(message_)) {
+        // Replays own the calendar; storage reload after the replay catches up
+        if (!StorageManager::persistenceEnabled()) continue;
+        if (!decodeDeltas(message_, inbox_)) continue;
+        PROFILE_SCOPE("sync.apply");
+        size_t applied = merger_.applyAll(events_, inbox_, CHANGE_TAB);
+        deltasApplied_ += applied;
+        if (applied > 0) changed = true;
+    }
+    return changed;
+}
+
+} // namespace calendar
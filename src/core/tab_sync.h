@@ -0,0 +1,50 @@
+#ifndef TAB_SYNC_H
+#define TAB_SYNC_H
+
+#include "event.h"
+#include "event_delta.h"
+#include <string>
+#include <vector>
+
+namespace calendar {
+
+// Keeps the calendars of several open tabs in step. Every local mutation,
+// and every change pulled from the sync server, is queued as an EventDelta
+// and poll() posts the frame's deltas as one message over TabChannel; deltas from other tabs are merged last-writer-
+// wins straight into the indexes, with no reparse. Nothing is sent or
+// applied while persistence is off (trace replays edit a synthetic
+// calendar); the reload after a replay picks up what other tabs saved.
+class TabSync : public EventListener {
+public:
+    static constexpr const char* kChannelName = "calendar_events";
+
+    explicit TabSync(EventManager& events);
+    ~TabSync();
+
+    // False where there is no channel (native builds, old browsers)
+    bool start();
+    // Once per main loop iteration. True if remote changes were applied.
+    // They are not saved here: the tab that made them already has, and a
+    // save costs the whole calendar however small the delta.
+    bool poll();
+
+    void eventChanged(const Event& event, ChangeOrigin origin) override;
+    void eventRemoved(uint64_t uid, uint64_t stamp, ChangeOrigin origin) override;
+
+    uint64_t deltasSent() const { return deltasSent_; }
+    uint64_t deltasApplied() const { return deltasApplied_; }
+
+private:
+    EventManager& events_;
+    bool open_;
+    std::vector<EventDelta> outbox_;
+    std::vector<EventDelta> inbox_;
+    std::string message_;
+    DeltaMerger merger_;
+    uint64_t deltasSent_;
+    uint64_t deltasApplied_;
+};
+
+} // namespace calendar
+
+#endif // TAB_SYNC_H
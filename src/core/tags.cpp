@@ -0,0 +1,96 @@
+#include "tags.h"
+#include "memory_tracker.h"
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+namespace calendar {
+
+namespace {
+
+const char* const kDefaultTags[] = {"WORK", "PERSONAL", "FAMILY", "HEALTH", "TRAVEL", "SOCIAL"};
+
+bool sameName(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i] >= 'a' && a[i] <= 'z' ? a[i] - ('a' - 'A') : a[i];
+        char y = b[i] >= 'a' && b[i] <= 'z' ? b[i] - ('a' - 'A') : b[i];
+        if (x != y) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TagTable::TagTable() {
+    for (size_t i = 0; i < sizeof(kDefaultTags) / sizeof(kDefaultTags[0]); i++) names_[i] = kDefaultTags[i];
+}
+
+int TagTable::find(const std::string& name) const {
+    if (name.empty()) return -1;
+    for (int bit = 0; bit < kMaxTags; bit++) {
+        if (sameName(names_[bit], name)) return bit;
+    }
+    return -1;
+}
+
+int TagTable::intern(const std::string& name) {
+    int bit = find(name);
+    if (bit >= 0 || name.empty()) return bit;
+    for (bit = 0; bit < kMaxTags; bit++) {
+        if (names_[bit].empty()) {
+            MEMORY_SCOPE(MEM_TEXT);
+            names_[bit] = name;
+            return bit;
+        }
+    }
+    return -1;
+}
+
+void TagTable::rename(int bit, const std::string& name) {
+    MEMORY_SCOPE(MEM_TEXT);
+    names_[bit] = name;
+}
+
+void TagTable::clear() {
+    for (std::string& name : names_) name.clear();
+}
+
+uint64_t TagTable::definedMask() const {
+    uint64_t mask = 0;
+    for (int bit = 0; bit < kMaxTags; bit++) {
+        if (!names_[bit].empty()) mask |= 1ull << bit;
+    }
+    return mask;
+}
+
+size_t countTagged(const uint64_t* tags, size_t count, uint64_t mask) {
+    size_t i = 0;
+    size_t found = 0;
+#ifdef __wasm_simd128__
+    v128_t wanted = wasm_i64x2_splat((int64_t)mask);
+    v128_t zero = wasm_i64x2_splat(0);
+    v128_t missed = zero;   // minus the rows without a wanted bit, per lane
+    for (; i + 2 <= count; i += 2) {
+        v128_t rows = wasm_v128_and(wasm_v128_load(tags + i), wanted);
+        missed = wasm_i64x2_add(missed, wasm_i64x2_eq(rows, zero));
+    }
+    found = i + (size_t)(wasm_i64x2_extract_lane(missed, 0) + wasm_i64x2_extract_lane(missed, 1));
+#endif
+    for (; i < count; i++) found += (tags[i] & mask) != 0;
+    return found;
+}
+
+uint64_t unionOfTags(const uint64_t* tags, size_t count) {
+    size_t i = 0;
+    uint64_t bits = 0;
+#ifdef __wasm_simd128__
+    v128_t any = wasm_i64x2_splat(0);
+    for (; i + 2 <= count; i += 2) any = wasm_v128_or(any, wasm_v128_load(tags + i));
+    bits = (uint64_t)wasm_i64x2_extract_lane(any, 0) | (uint64_t)wasm_i64x2_extract_lane(any, 1);
+#endif
+    for (; i < count; i++) bits |= tags[i];
+    return bits;
+}
+
+} // namespace calendar
@@ -0,0 +1,58 @@
+#ifndef TAGS_H
+#define TAGS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace calendar {
+
+// Names of the tags events carry in Event::tags: bit i is tag i. Only the
+// bits travel with events (storage, tabs, the sync server); the names are
+// kept per browser by StorageManager::saveTags().
+class TagTable {
+public:
+    static const int kMaxTags = 64;
+
+    // Starts with a few common categories named, so a fresh calendar has
+    // something to pick from
+    TagTable();
+
+    // The tag's bit, or -1. Names match case-insensitively.
+    int find(const std::string& name) const;
+    // find(), or names the first unused bit; -1 if all are taken or the
+    // name is empty
+    int intern(const std::string& name);
+    void rename(int bit, const std::string& name);
+    void clear();
+
+    const std::string& name(int bit) const { return names_[bit]; }
+    bool defined(int bit) const { return !names_[bit].empty(); }
+    uint64_t definedMask() const;
+
+private:
+    std::string names_[kMaxTags];
+};
+
+// Lowest set bit of a non-zero mask
+inline int firstTag(uint64_t tags) {
+    int bit = 0;
+    while (!(tags & 1)) {
+        tags >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+// Scans over a packed tag column (ChronoIndex::Run::tags). WebAssembly
+// builds with SIMD compare two rows per instruction; elsewhere the plain
+// loops are left to the compiler's vectoriser.
+
+// Rows with any bit of mask set
+size_t countTagged(const uint64_t* tags, size_t count, uint64_t mask);
+// Every bit set in any row
+uint64_t unionOfTags(const uint64_t* tags, size_t count);
+
+} // namespace calendar
+
+#endif // TAGS_H
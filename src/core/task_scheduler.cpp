@@ -0,0 +1,116 @@
+#include "task_scheduler.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace calendar {
+
+namespace {
+
+// Weight of the newest frame in the frame-work average
+const double kFrameWorkSmoothing = 0.1;
+// Headroom left for the browser's compositing and event dispatch
+const double kSafetyMarginMs = 2.0;
+
+} // namespace
+
+void Task::describe(char* buffer, size_t size) const {
+    float fraction = progress();
+    if (fraction < 0.0f) snprintf(buffer, size, "WORKING...");
+    else snprintf(buffer, size, "WORKING: %d%%", (int)(fraction * 100.0f));
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler() : nextId_(1), frameWorkMs_(-1.0) {}
+
+TaskId TaskScheduler::submit(std::unique_ptr<Task> task, TaskPriority priority) {
+    Entry entry;
+    entry.id = nextId_++;
+    entry.priority = priority;
+    entry.task = std::move(task);
+    entry.waiting = false;
+    TaskId id = entry.id;
+    // After every task of the same or higher priority
+    auto at = std::upper_bound(tasks_.begin(), tasks_.end(), priority,
+                               [](TaskPriority p, const Entry& e) { return p < e.priority; });
+    tasks_.insert(at, std::move(entry));
+    return id;
+}
+
+void TaskScheduler::cancel(TaskId id) {
+    for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+        if (it->id == id) {
+            std::unique_ptr<Task> task = std::move(it->task);
+            tasks_.erase(it);
+            task->cancelled();
+            return;
+        }
+    }
+}
+
+const Task* TaskScheduler::find(TaskId id) const {
+    for (const Entry& entry : tasks_) {
+        if (entry.id == id) return entry.task.get();
+    }
+    return nullptr;
+}
+
+bool TaskScheduler::hasRunnableTasks() const {
+    for (const Entry& entry : tasks_) {
+        if (!entry.waiting) return true;
+    }
+    return false;
+}
+
+void TaskScheduler::pollWaiting() {
+    for (Entry& entry : tasks_) {
+        if (entry.waiting && entry.task->ready()) entry.waiting = false;
+    }
+}
+
+void TaskScheduler::wakeWaiting() {
+    for (Entry& entry : tasks_) entry.waiting = false;
+}
+
+void TaskScheduler::noteFrameWork(double ms) {
+    if (frameWorkMs_ < 0.0) frameWorkMs_ = ms;
+    else frameWorkMs_ += (ms - frameWorkMs_) * kFrameWorkSmoothing;
+}
+
+double TaskScheduler::budgetMs() const {
+    double work = frameWorkMs_ < 0.0 ? 0.0 : frameWorkMs_;
+    double budget = kFrameTargetMs - work - kSafetyMarginMs;
+    return std::min(kMaxBudgetMs, std::max(kMinBudgetMs, budget));
+}
+
+void TaskScheduler::runSlice(double nowMs) {
+    if (tasks_.empty()) return;
+    PROFILE_SCOPE("tasks.slice");
+    double deadlineMs = nowMs + budgetMs();
+
+    size_t i = 0;
+    while (i < tasks_.size() && Profiler::nowMs() < deadlineMs) {
+        if (tasks_[i].waiting) {
+            i++;
+            continue;
+        }
+        TaskId id = tasks_[i].id;
+        TaskStatus status = tasks_[i].task->step(deadlineMs);
+        // step() may have submitted or cancelled tasks, so find it again
+        auto it = std::find_if(tasks_.begin(), tasks_.end(), [id](const Entry& e) { return e.id == id; });
+        if (it == tasks_.end()) continue;
+        i = (size_t)(it - tasks_.begin());
+        if (status == TASK_DONE) {
+            tasks_.erase(it);
+        } else {
+            it->waiting = status == TASK_WAITING;
+            i++;
+        }
+    }
+}
+
+} // namespace calendar
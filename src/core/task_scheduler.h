@@ -0,0 +1,103 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace calendar {
+
+enum TaskStatus {
+    TASK_DONE,      // finished; the scheduler drops it
+    TASK_YIELD,     // ran until the deadline and has more to do
+    TASK_WAITING    // blocked (file not picked yet); did no work
+};
+
+enum TaskPriority {
+    PRIORITY_HIGH,
+    PRIORITY_NORMAL,
+    PRIORITY_LOW,
+    PRIORITY_COUNT
+};
+
+// A long job broken into resumable slices. step() keeps its own position
+// between calls, the way the iCalendar reader keeps its parse state
+// between chunks.
+class Task {
+public:
+    virtual ~Task() = default;
+
+    // Does work until Profiler::nowMs() reaches deadlineMs or the job ends
+    virtual TaskStatus step(double deadlineMs) = 0;
+    // Called instead of further steps when the task is cancelled
+    virtual void cancelled() {}
+    // Polled every main loop iteration while the task is waiting, rendered
+    // or not, so it must be cheap: true once step() has something to do
+    // again. Otherwise a waiting task is only stepped again after new input
+    // (TaskScheduler::wakeWaiting()).
+    virtual bool ready() const { return false; }
+
+    // 0..1, or negative while the total is unknown
+    virtual float progress() const { return -1.0f; }
+    // Short upper-case status line for progress bars
+    virtual void describe(char* buffer, size_t size) const;
+};
+
+typedef uint32_t TaskId;
+
+// Cooperative scheduler for work too big for one frame. The main loop calls
+// runSlice() once per rendered frame, after input has been handled and the
+// frame presented, so tasks only get the time the frame left over: the
+// budget is the frame target minus a running average of the frame's own
+// work, clamped to [kMinBudgetMs, kMaxBudgetMs]. Higher priorities run
+// first, in submission order within a priority; waiting tasks are skipped.
+// Only runnable tasks keep frames coming: one that last returned
+// TASK_WAITING costs nothing until its ready() or new input wakes it.
+class TaskScheduler {
+public:
+    static constexpr double kFrameTargetMs = 1000.0 / 60.0;
+    static constexpr double kMinBudgetMs = 1.0;
+    static constexpr double kMaxBudgetMs = 8.0;
+
+    static TaskScheduler& instance();
+
+    TaskId submit(std::unique_ptr<Task> task, TaskPriority priority = PRIORITY_NORMAL);
+    // Calls the task's cancelled() and drops it; unknown ids are ignored.
+    // A task ends itself by returning TASK_DONE, never through cancel().
+    void cancel(TaskId id);
+    // Null once the task has finished or been cancelled
+    const Task* find(TaskId id) const;
+    bool idle() const { return tasks_.empty(); }
+    // False when every task is waiting
+    bool hasRunnableTasks() const;
+    // Makes waiting tasks whose ready() holds runnable again
+    void pollWaiting();
+    // Makes every waiting task runnable again; input may have unblocked them
+    void wakeWaiting();
+    size_t taskCount() const { return tasks_.size(); }
+
+    // Time the frame took before the slice (input, UI, render)
+    void noteFrameWork(double ms);
+    double budgetMs() const;
+    // Runs tasks until the budget from nowMs is spent or all are waiting
+    void runSlice(double nowMs);
+
+private:
+    TaskScheduler();
+
+    struct Entry {
+        TaskId id;
+        TaskPriority priority;
+        std::unique_ptr<Task> task;
+        bool waiting;           // last step returned TASK_WAITING
+    };
+
+    std::vector<Entry> tasks_;   // sorted by priority, then submission
+    TaskId nextId_;
+    double frameWorkMs_;         // exponential moving average, -1 before the first frame
+};
+
+} // namespace calendar
+
+#endif // TASK_SCHEDULER_H
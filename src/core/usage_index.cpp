@@ -0,0 +1,222 @@
+#include "usage_index.h"
+#include "calendar.h"
+#include "event.h"
+#include "memory_tracker.h"
+#include <algorithm>
+
+namespace calendar {
+
+namespace {
+
+const int kWindowSlots = (UsageIndex::kWindowEndMinute - UsageIndex::kWindowStartMinute) / UsageIndex::kSlotMinutes;
+const int kWindowMinutes = UsageIndex::kWindowEndMinute - UsageIndex::kWindowStartMinute;
+
+// Day-of-year slot, or -1 for dates outside the year, as in DayIndex
+int daySlot(int day, int month, int year) {
+    if (month < 0 || month > 11 || day < 1 || day > CalendarLogic::getDaysInMonth(month, year)) {
+        return -1;
+    }
+    return CalendarLogic::getDayOfYear(day, month, year);
+}
+
+void addTotals(UsageIndex::Totals& into, const UsageIndex::Totals& from, int sign) {
+    into.bookedMinutes += sign * from.bookedMinutes;
+    into.events += sign * from.events;
+    for (int i = 0; i < 7; i++) into.weekdayMinutes[i] += sign * from.weekdayMinutes[i];
+    for (int i = 0; i < 24; i++) into.hourMinutes[i] += sign * from.hourMinutes[i];
+}
+
+// Calls visit(year, first day number of the year, first slot, last slot)
+// for each year [firstDay, lastDay] touches
+template <typename Visit>
+void forEachYear(int firstDay, int lastDay, Visit visit) {
+    int dayNumber = firstDay;
+    while (dayNumber <= lastDay) {
+        int day, month, year;
+        CalendarLogic::fromDayNumber(dayNumber, day, month, year);
+        int yearStart = CalendarLogic::toDayNumber(1, 0, year);
+        int last = std::min(lastDay, CalendarLogic::toDayNumber(1, 0, year + 1) - 1);
+        visit(year, yearStart, dayNumber - yearStart, last - yearStart);
+        dayNumber = last + 1;
+    }
+}
+
+} // namespace
+
+void UsageIndex::MaxTree::init(int32_t leaf) {
+    values.assign(2 * kLeaves, leaf);
+}
+
+void UsageIndex::MaxTree::set(int slot, int32_t value) {
+    int node = kLeaves + slot;
+    values[node] = value;
+    for (node >>= 1; node > 0; node >>= 1) {
+        values[node] = std::max(values[2 * node], values[2 * node + 1]);
+    }
+}
+
+int UsageIndex::MaxTree::cover(int first, int last, int* nodes) const {
+    int count = 0;
+    int left = kLeaves + first;
+    int right = kLeaves + last + 1;
+    while (left < right) {
+        if (left & 1) nodes[count++] = left++;
+        if (right & 1) nodes[count++] = --right;
+        left >>= 1;
+        right >>= 1;
+    }
+    return count;
+}
+
+void UsageIndex::add(const Event& event) {
+    apply(event, 1);
+}
+
+void UsageIndex::remove(const Event& event) {
+    apply(event, -1);
+}
+
+void UsageIndex::apply(const Event& event, int delta) {
+    MEMORY_SCOPE(MEM_INDEXES);
+    int slot = daySlot(event.day, event.month, event.year);
+    if (slot < 0) return;
+    YearUsage& usage = years_[event.year];
+    if (usage.tree.empty()) {
+        usage.tree.assign(367, Totals());
+        usage.occupancy.assign(366 * kWindowSlots, 0);
+        usage.booked.init(0);
+        usage.free.init(kWindowMinutes);
+    }
+
+    Totals change = Totals();
+    change.events = delta;
+    bool timed = !event.isAllDay && event.hourStart >= 0 && event.hourStart <= 23;
+    int startMinutes = timed ? event.hourStart * 60 + event.minuteStart : 0;
+    int endMinutes = event.hourEnd != -1 ? event.hourEnd * 60 + event.minuteEnd : startMinutes + 60;
+    if (endMinutes > 24 * 60) endMinutes = 24 * 60;
+    if (timed && endMinutes > startMinutes) {
+        int minutes = endMinutes - startMinutes;
+        change.bookedMinutes = delta * minutes;
+        change.weekdayMinutes[CalendarLogic::getDayOfWeek(event.day, event.month, event.year)] = delta * minutes;
+        for (int hour = startMinutes / 60; hour * 60 < endMinutes; hour++) {
+            int overlap = std::min(endMinutes, hour * 60 + 60) - std::max(startMinutes, hour * 60);
+            change.hourMinutes[hour] = delta * overlap;
+        }
+
+        int from = std::max(startMinutes, kWindowStartMinute);
+        int to = std::min(endMinutes, kWindowEndMinute);
+        if (from < to) {
+            uint16_t* slots = &usage.occupancy[slot * kWindowSlots];
+            int firstSlot = (from - kWindowStartMinute) / kSlotMinutes;
+            int lastSlot = (to - 1 - kWindowStartMinute) / kSlotMinutes;
+            for (int i = firstSlot; i <= lastSlot; i++) slots[i] += delta;
+            int start;
+            usage.free.set(slot, freeRun(slots, start));
+        }
+        usage.booked.set(slot, usage.booked.values[MaxTree::kLeaves + slot] + delta * minutes);
+    }
+
+    for (int node = slot + 1; node <= 366; node += node & -node) {
+        addTotals(usage.tree[node], change, 1);
+    }
+}
+
+int UsageIndex::freeRun(const uint16_t* slots, int& startMinute) {
+    int best = 0;
+    int bestStart = -1;
+    int run = 0;
+    for (int i = 0; i < kWindowSlots; i++) {
+        run = slots[i] == 0 ? run + 1 : 0;
+        if (run > best) {
+            best = run;
+            bestStart = i - run + 1;
+        }
+    }
+    startMinute = bestStart < 0 ? -1 : kWindowStartMinute + bestStart * kSlotMinutes;
+    return best * kSlotMinutes;
+}
+
+void UsageIndex::totals(int firstDay, int lastDay, Totals& out) const {
+    out = Totals();
+    forEachYear(firstDay, lastDay, [&](int year, int, int first, int last) {
+        auto it = years_.find(year);
+        if (it == years_.end()) return;
+        const std::vector<Totals>& tree = it->second.tree;
+        for (int node = last + 1; node > 0; node -= node & -node) addTotals(out, tree[node], 1);
+        for (int node = first; node > 0; node -= node & -node) addTotals(out, tree[node], -1);
+    });
+}
+
+int UsageIndex::busiestDays(int firstDay, int lastDay, DayValue* out, int count) const {
+    return best(true, firstDay, lastDay, out, count);
+}
+
+UsageIndex::DayValue UsageIndex::longestFreeBlock(int firstDay, int lastDay) const {
+    DayValue block = {-1, 0, -1};
+    if (best(false, firstDay, lastDay, &block, 1) == 0) return block;
+    // The trees keep lengths only; find where the winning block starts
+    int day, month, year;
+    CalendarLogic::fromDayNumber(block.dayNumber, day, month, year);
+    auto it = years_.find(year);
+    if (it == years_.end()) {
+        block.startMinute = kWindowStartMinute;
+    } else {
+        int slot = block.dayNumber - CalendarLogic::toDayNumber(1, 0, year);
+        freeRun(&it->second.occupancy[slot * kWindowSlots], block.startMinute);
+    }
+    return block;
+}
+
+int UsageIndex::best(bool busiest, int firstDay, int lastDay, DayValue* out, int count) const {
+    // Covering nodes of every year go into one max-heap; popping a node
+    // pushes its children until count leaves have come out on top
+    auto worse = [](const Candidate& a, const Candidate& b) {
+        return a.value != b.value ? a.value < b.value : a.firstDay > b.firstDay;
+    };
+    auto leftmost = [](int node) {
+        while (node < MaxTree::kLeaves) node <<= 1;
+        return node - MaxTree::kLeaves;
+    };
+
+    // Each year adds its cover and each popped node one more entry; the
+    // buffer keeps its capacity between calls, so only a wider range grows it
+    MEMORY_SCOPE(MEM_INDEXES);
+    std::vector<Candidate>& heap = heap_;
+    heap.clear();
+    heap.reserve((size_t)((lastDay - firstDay) / 365 + 2) * MaxTree::kMaxCover + (size_t)count * 10);
+    int nodes[MaxTree::kMaxCover];
+    forEachYear(firstDay, lastDay, [&](int year, int yearStart, int first, int last) {
+        auto it = years_.find(year);
+        if (it == years_.end()) {
+            // Nothing booked all year: free all day, busy never
+            if (!busiest) heap.push_back({kWindowMinutes, yearStart + first, yearStart, nullptr, 0});
+            return;
+        }
+        const MaxTree& tree = busiest ? it->second.booked : it->second.free;
+        int covered = tree.cover(first, last, nodes);
+        for (int i = 0; i < covered; i++) {
+            int node = nodes[i];
+            heap.push_back({tree.values[node], yearStart + leftmost(node), yearStart, &tree, node});
+        }
+    });
+    std::make_heap(heap.begin(), heap.end(), worse);
+
+    int found = 0;
+    while (found < count && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        Candidate top = heap.back();
+        heap.pop_back();
+        if (busiest && top.value <= 0) break;
+        if (!top.tree || top.node >= MaxTree::kLeaves) {
+            out[found++] = {top.firstDay, top.value, -1};
+            continue;
+        }
+        for (int child = 2 * top.node; child <= 2 * top.node + 1; child++) {
+            heap.push_back({top.tree->values[child], top.yearStart + leftmost(child), top.yearStart, top.tree, child});
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    }
+    return found;
+}
+
+} // namespace calendar
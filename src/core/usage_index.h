@@ -0,0 +1,94 @@
+#ifndef USAGE_INDEX_H
+#define USAGE_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace calendar {
+
+struct Event;
+
+// Booked time per day, kept up to date by EventManager on every mutation
+// like DayIndex. Each year holds a Fenwick tree of per-day totals, so the
+// sums for any range of days cost O(log n) per year it touches, and max
+// trees over the days for the busiest day and the longest free block, so
+// those are O(log n) too. Only timed events book time; overlapping events
+// each count in full.
+class UsageIndex {
+public:
+    // Free time is looked for within this part of each day
+    static constexpr int kWindowStartMinute = 8 * 60;
+    static constexpr int kWindowEndMinute = 20 * 60;
+    static constexpr int kSlotMinutes = 15;   // free blocks are found to the quarter hour
+
+    struct Totals {
+        int32_t bookedMinutes;
+        int32_t events;              // all-day ones included
+        int32_t weekdayMinutes[7];   // Monday first
+        int32_t hourMinutes[24];     // the part of each event within each hour
+    };
+
+    struct DayValue {
+        int dayNumber;     // -1 if there is none
+        int minutes;
+        int startMinute;   // longestFreeBlock() only
+    };
+
+    void add(const Event& event);
+    void remove(const Event& event);
+    void clear() { years_.clear(); }
+
+    // Ranges are inclusive day numbers (CalendarLogic::toDayNumber)
+    void totals(int firstDay, int lastDay, Totals& out) const;
+    // Up to count days with booked time, busiest first; returns how many
+    int busiestDays(int firstDay, int lastDay, DayValue* out, int count) const;
+    // The longest stretch of the window without events on any day of the
+    // range, earliest day first among equals
+    DayValue longestFreeBlock(int firstDay, int lastDay) const;
+
+private:
+    // Max over the days of a year, in heap layout with the leaves at
+    // kLeaves + day of year
+    struct MaxTree {
+        static const int kLeaves = 512;
+        static const int kMaxCover = 18;   // two nodes per level at most
+        std::vector<int32_t> values;
+
+        void init(int32_t leaf);
+        void set(int slot, int32_t value);
+        // The nodes that exactly cover slots [first, last]; returns how many
+        int cover(int first, int last, int* nodes) const;
+    };
+
+    struct YearUsage {
+        std::vector<Totals> tree;          // Fenwick, 1-based, one node per day of year
+        std::vector<uint16_t> occupancy;   // events per window slot, day-major
+        MaxTree booked;
+        MaxTree free;
+    };
+
+    // A node of one year's max tree waiting in best()'s heap
+    struct Candidate {
+        int32_t value;
+        int firstDay;        // leftmost day under the node, for ties
+        int yearStart;
+        const MaxTree* tree; // null for a day of a year without events
+        int node;
+    };
+
+    void apply(const Event& event, int delta);
+    // The longest free stretch of a day's window, and where it starts
+    static int freeRun(const uint16_t* slots, int& startMinute);
+    // Best nodes from the per-year covers of [firstDay, lastDay], best first
+    int best(bool busiest, int firstDay, int lastDay, DayValue* out, int count) const;
+
+    std::unordered_map<int, YearUsage> years_;
+    // best()'s heap, cleared rather than freed so the stats panel does not
+    // allocate every frame
+    mutable std::vector<Candidate> heap_;
+};
+
+} // namespace calendar
+
+#endif // USAGE_INDEX_H
@@ -7,8 +7,25 @@
 #include <emscripten/html5.h>
 
 #include "ui/ui.h"
+#include "ui/block_renderer.h"
+#include "core/clock.h"
 #include "core/event.h"
+#include "core/file_io.h"
 #include "core/storage.h"
+#include "core/frame_arena.h"
+#include "core/frame_pacer.h"
+#include "core/memory_tracker.h"
+#include "core/notifier.h"
+#include "core/persistence_worker.h"
+#include "core/profiler.h"
+#include "core/reminder_scheduler.h"
+#include "core/sync_engine.h"
+#include "core/tab_sync.h"
+#include "core/task_scheduler.h"
+#include "ui/profiler_hud.h"
+#include "ui/trace_session.h"
+#include <algorithm>
+#include <cstdio>
 
 using namespace calendar;
 
@@ -18,11 +35,153 @@ SDL_GLContext g_GLContext = nullptr;
 CalendarState* g_State = nullptr;
 EventManager* g_EventManager = nullptr;
 CalendarUI* g_UI = nullptr;
+TraceSession* g_Trace = nullptr;
+TabSync* g_TabSync = nullptr;
+HttpSyncTransport* g_SyncTransport = nullptr;
+SyncEngine* g_Sync = nullptr;    // only when the page names a sync endpoint
+ReminderScheduler* g_Reminders = nullptr;
+std::vector<Reminder> g_DueReminders;
+double g_NextReminderPollMs = 0.0;
+int g_ReminderWakeGeneration = 0;   // the one pending wake-up timer that counts
+int64_t g_ReminderWakeAt = -1;      // Clock::localMs() it is set for, -1 if none
+FramePacer g_Pacer;
+ProfilerHUD g_ProfilerHUD;
+BlockRenderer g_Blocks;   // instanced time grid blocks, WebGL2 only
+uint64_t g_LastRevision = 0;
+
+// ImGui allocates through its own hooks rather than operator new
+static void* imguiAlloc(size_t size, void*) {
+    return MemoryTracker::allocate(size, MEM_IMGUI);
+}
+
+static void imguiFree(void* ptr, void*) {
+    MemoryTracker::release(ptr);
+}
+
+// Keeps rendering while ImGui has something in motion that no further
+// input event would report (held buttons, active widgets, text caret).
+static bool imguiNeedsAnotherFrame() {
+    ImGuiIO& io = ImGui::GetIO();
+    for (int i = 0; i < 5; i++) {
+        if (io.MouseDown[i]) return true;
+    }
+    return ImGui::IsAnyItemActive() || io.WantTextInput;
+}
+
+static void renderFrameCounter() {
+    // Vertex count is from the previous rendered frame
+    char counter[200];
+    int length = snprintf(counter, sizeof(counter), "FRAMES %llu / SKIPPED %llu / VTX %d / GRID REBUILDS %d",
+            (unsigned long long)g_Pacer.framesRendered(), (unsigned long long)g_Pacer.framesSkipped(),
+            ImGui::GetIO().MetricsRenderVertices, g_UI->getGridCache().rebuildCount());
+    if (g_Sync) {
+        length += snprintf(counter + length, sizeof(counter) - length, " / SYNC %s %zu PENDING",
+                           g_Sync->online() ? "ONLINE" : "OFFLINE", g_Sync->pendingCount());
+    }
+    if (g_Blocks.enabled()) {
+        snprintf(counter + length, sizeof(counter) - length, " / GPU BLOCKS %d (%d UPLOADS)",
+                 g_Blocks.blockCount(), g_Blocks.uploadCount());
+    }
+    ImVec2 size = ImGui::CalcTextSize(counter);
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    ImGui::GetForegroundDrawList()->AddText(
+        ImVec2(display.x - size.x - 8.0f, display.y - size.y - 4.0f),
+        ImGui::GetColorU32(ImGuiCol_TextDisabled), counter);
+}
+
+// Fresh UI state for the start and end of a trace recording or replay, so
+// both sides begin from the same view, scroll and caches
+static void resetUI() {
+    delete g_UI;
+    delete g_State;
+    g_State = new CalendarState();
+    g_UI = new CalendarUI(*g_State, *g_EventManager);
+    g_UI->setBlockRenderer(&g_Blocks);
+    // The tag filter is view state too, though the manager holds it
+    g_EventManager->setTagFilter(0);
+}
+
+// With the persistence worker running the parse and index build happen off
+// the UI thread and the calendar is swapped in by a later poll()
+static void loadStoredEvents() {
+    if (PersistenceWorker::instance().loadFromStorage(*g_EventManager)) return;
+    // Built aside and swapped in, so other tabs are not sent the whole load
+    EventManager loaded;
+    StorageManager::loadEventsFromStorage(loaded);
+    g_EventManager->replaceWith(loaded);
+}
+
+static void finishReplay() {
+    std::string results;
+    g_Trace->writeResultsJSON(results);
+    FileIO::downloadFile("calendar-replay.json", "application/json", results);
+    g_Trace->finishReplay();
+
+    // The replay may have swapped in a synthetic calendar
+    loadStoredEvents();
+}
+
+static const double kReminderPollMs = 1000.0;
+// Also caps the wake-up timer, so a changed clock or time zone is noticed
+static const int64_t kMaxReminderWakeMs = 60000;
+
+static void reminderWake(void* generation);
+
+// Checked once a second from the main loop, and by a timer set for the
+// next reminder, since browsers stop calling the loop in hidden tabs
+static void pollReminders() {
+    // Recorded and replayed traces pin the clock; a stored calendar that is
+    // still loading would fire whatever the placeholder holds
+    if (Clock::pinned() || PersistenceWorker::instance().loading()) return;
+    int64_t nowMs = Clock::localMs();
+    g_DueReminders.clear();
+    if (g_Reminders->poll(nowMs, g_DueReminders)) {
+        for (const Reminder& reminder : g_DueReminders) {
+            g_UI->showReminder(reminder);
+            char title[64];
+            char tag[64];
+            if (reminder.hourStart < 0) {
+                snprintf(title, sizeof(title), "%s %d", CalendarLogic::getMonthName(reminder.month), reminder.day);
+            } else {
+                snprintf(title, sizeof(title), "%02d:%02d %s %d", reminder.hourStart, reminder.minuteStart,
+                         CalendarLogic::getMonthName(reminder.month), reminder.day);
+            }
+            snprintf(tag, sizeof(tag), "remind-%llx-%d-%d-%d", (unsigned long long)reminder.uid, reminder.year,
+                     reminder.month, reminder.day);
+            Notifier::show(title, reminder.text.c_str(), tag);
+        }
+        g_Pacer.requestFrames();
+    }
+
+    int64_t next = g_Reminders->nextDueMs();
+    if (next < 0) return;
+    int64_t wakeAt = std::min(next, nowMs + kMaxReminderWakeMs);
+    if (g_ReminderWakeAt >= 0 && g_ReminderWakeAt <= wakeAt) return;
+    g_ReminderWakeAt = wakeAt;
+    g_ReminderWakeGeneration++;
+    emscripten_async_call(reminderWake, (void*)(intptr_t)g_ReminderWakeGeneration,
+                          (int)std::max<int64_t>(wakeAt - nowMs, 0));
+}
+
+static void reminderWake(void* generation) {
+    // Superseded by an earlier timer
+    if ((intptr_t)generation != g_ReminderWakeGeneration) return;
+    g_ReminderWakeAt = -1;
+    pollReminders();
+}
 
 void main_loop() {
+    double loopStartMs = Profiler::nowMs();
+
+    // Nothing allocated from the frame arena survives into the next frame
+    FrameArena::frame().reset();
+
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
-        ImGui_ImplSDL2_ProcessEvent(&event);
+        // A replay owns the input stream; real input is drained and dropped
+        if (!g_Trace->replaying()) ImGui_ImplSDL2_ProcessEvent(&event);
+        g_Pacer.requestFrames();
+        TaskScheduler::instance().wakeWaiting();
         
         // Handle window resize
         if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
@@ -32,6 +191,35 @@ void main_loop() {
         }
     }
 
+    // Finished saves are written and loaded calendars swapped in even on
+    // loop iterations that skip rendering
+    PersistenceWorker::instance().poll(*g_EventManager);
+    g_TabSync->poll();
+    if (g_Sync) g_Sync->poll(loopStartMs);
+    if (loopStartMs >= g_NextReminderPollMs) {
+        g_NextReminderPollMs = loopStartMs + kReminderPollMs;
+        pollReminders();
+    }
+
+    if (g_EventManager->getRevision() != g_LastRevision) {
+        g_LastRevision = g_EventManager->getRevision();
+        g_Pacer.requestFrames();
+    }
+
+    // Tasks waiting on a file picker render nothing until it is answered
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    scheduler.pollWaiting();
+    if (g_Trace->replaying() || scheduler.hasRunnableTasks()) {
+        g_Pacer.requestFrames(1);
+    }
+
+    // Nothing changed: leave the last presented frame on the canvas
+    if (!g_Pacer.shouldRender(emscripten_get_now())) {
+        return;
+    }
+
+    Profiler::instance().beginFrame();
+
     // Get current window size for viewport
     int display_w, display_h;
     SDL_GetWindowSize(g_Window, &display_w, &display_h);
@@ -39,19 +227,56 @@ void main_loop() {
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
+    if (g_Trace->takeResetRequest()) {
+        resetUI();
+    }
+    g_Trace->beforeNewFrame();
     ImGui::NewFrame();
+    g_Trace->afterNewFrame();
+
+    // F8 switches the time grid blocks between ImGui and the instanced pass
+    if (ImGui::IsKeyPressed(ImGuiKey_F8, false) && g_Blocks.available()) {
+        g_Blocks.setEnabled(!g_Blocks.enabled());
+    }
 
     // Render the calendar UI
     g_UI->render();
+    renderFrameCounter();
+    g_ProfilerHUD.render(g_EventManager->getEventCount());
+    g_Trace->update();
+
+    if (imguiNeedsAnotherFrame() || g_UI->wantsAnotherFrame()) {
+        g_Pacer.requestFrames(1);
+    }
+    // The current-time line and "today" change on the minute; localMs()
+    // rounds down to the second, so the wake-up is never early
+    g_Pacer.requestFrameAt(emscripten_get_now() + (double)(60000 - Clock::localMs() % 60000));
 
     // Rendering
-    ImGui::Render();
-    SDL_GL_MakeCurrent(g_Window, g_GLContext);
-    glViewport(0, 0, display_w, display_h);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    SDL_GL_SwapWindow(g_Window);
+    {
+        PROFILE_SCOPE("imgui.render");
+        ImGui::Render();
+    }
+    g_Trace->endFrame();
+    {
+        PROFILE_SCOPE("gl.render");
+        SDL_GL_MakeCurrent(g_Window, g_GLContext);
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        SDL_GL_SwapWindow(g_Window);
+    }
+
+    // Long-running tasks get what is left of the frame once input, UI and
+    // rendering are done
+    scheduler.noteFrameWork(Profiler::nowMs() - loopStartMs);
+    scheduler.runSlice(Profiler::nowMs());
+    Profiler::instance().endFrame();
+
+    if (g_Trace->replayDone()) {
+        finishReplay();
+    }
 }
 
 int main(int, char**) {
@@ -60,8 +285,9 @@ int main(int, char**) {
         return -1;
     }
 
-    // GL ES 2.0
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+    // GL ES 3.0 (WebGL2) for the instanced block pass; ImGui itself only
+    // needs GL ES 2.0 (WebGL 1), which is the fallback
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
@@ -73,11 +299,16 @@ int main(int, char**) {
         SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     
     g_GLContext = SDL_GL_CreateContext(g_Window);
+    if (!g_GLContext) {
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+        g_GLContext = SDL_GL_CreateContext(g_Window);
+    }
     SDL_GL_MakeCurrent(g_Window, g_GLContext);
     SDL_GL_SetSwapInterval(1);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree);
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.IniFilename = nullptr;
@@ -85,26 +316,50 @@ int main(int, char**) {
     // Setup Platform/Renderer backends
     ImGui_ImplSDL2_InitForOpenGL(g_Window, g_GLContext);
     ImGui_ImplOpenGL3_Init("#version 100");
+    g_Blocks.init();
 
     // Initialize application state
     g_State = new CalendarState();
     g_EventManager = new EventManager();
     g_UI = new CalendarUI(*g_State, *g_EventManager);
+    g_UI->setBlockRenderer(&g_Blocks);
+    g_Trace = new TraceSession(*g_EventManager);
+    g_TabSync = new TabSync(*g_EventManager);
+    g_TabSync->start();
+    g_Reminders = new ReminderScheduler(*g_EventManager);
+    g_Reminders->start(Clock::localMs());
+    std::string syncUrl;
+    if (HttpSyncTransport::configuredUrl(syncUrl)) {
+        g_SyncTransport = new HttpSyncTransport(syncUrl);
+        g_Sync = new SyncEngine(*g_EventManager, *g_SyncTransport);
+        g_Sync->start();
+    }
     
     // Setup terminal style
     g_UI->setupTerminalStyle();
     
-    // Load events from localStorage
-    StorageManager::loadEventsFromStorage(g_EventManager->getAllEvents());
+    // Threaded builds move persistence off the UI thread; elsewhere start()
+    // fails and everything stays inline
+    PersistenceWorker::instance().start();
+
+    // Load tag names and events from localStorage
+    StorageManager::loadTags(g_EventManager->getTags());
+    loadStoredEvents();
 
     // Main loop
     emscripten_set_main_loop(main_loop, 0, 1);
 
     // Cleanup
+    delete g_Sync;
+    delete g_SyncTransport;
+    delete g_Reminders;
+    delete g_TabSync;
+    delete g_Trace;
     delete g_UI;
     delete g_EventManager;
     delete g_State;
     
+    g_Blocks.shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,42 @@
+#include "block_renderer.h"
+#include "../core/memory_tracker.h"
+
+namespace calendar {
+
+BlockRenderer::BlockRenderer()
+    : enabled_(false), valid_(false), dirty_(false), layout_(), origin_(0.0f, 0.0f), uploadCount_(0),
+      program_(0), vertexArray_(0), instanceBuffer_(0), bufferCapacity_(0), originLocation_(-1),
+      scaleLocation_(-1) {}
+
+BlockRenderer::~BlockRenderer() {
+    shutdown();
+}
+
+bool BlockRenderer::update(const BlockLayout& layout) {
+    if (valid_ && layout == layout_) {
+        return false;
+    }
+    layout_ = layout;
+    valid_ = true;
+    return true;
+}
+
+void BlockRenderer::add(const Block& block) {
+    MEMORY_SCOPE(MEM_UI_CACHES);
+    blocks_.push_back(block);
+}
+
+void BlockRenderer::draw(ImDrawList* drawList, const ImVec2& origin) {
+    if (blocks_.empty()) return;
+    origin_ = origin;
+    drawList->AddCallback(renderCallback, this);
+    // ImGui's backend sets up its own program and buffers again before the
+    // next command
+    drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void BlockRenderer::renderCallback(const ImDrawList*, const ImDrawCmd* cmd) {
+    static_cast<BlockRenderer*>(cmd->UserCallbackData)->render(cmd);
+}
+
+} // namespace calendar
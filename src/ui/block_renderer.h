@@ -0,0 +1,97 @@
+#ifndef BLOCK_RENDERER_H
+#define BLOCK_RENDERER_H
+
+#include "imgui.h"
+#include "grid_cache.h"
+#include "../core/event.h"
+#include <cstdint>
+#include <vector>
+
+namespace calendar {
+
+// Everything that decides which blocks the time grid shows and where,
+// relative to the grid origin. The blocks are rebuilt and re-uploaded only
+// when one of these changes, not on frames that only scroll or hover.
+struct BlockLayout {
+    GridLayout grid;
+    int firstDayNumber;
+    int fromMinute;             // visible minutes of the day
+    int toMinute;
+    uint64_t revision;          // EventManager::getRevision()
+    uint64_t tagFilter;
+    const Event* dragged;       // drawn as ImGui's preview instead
+
+    bool operator==(const BlockLayout& other) const {
+        return grid == other.grid && firstDayNumber == other.firstDayNumber &&
+               fromMinute == other.fromMinute && toMinute == other.toMinute &&
+               revision == other.revision && tagFilter == other.tagFilter && dragged == other.dragged;
+    }
+    bool operator!=(const BlockLayout& other) const { return !(*this == other); }
+};
+
+// Draws the time grid's event rectangles as instanced quads (WebGL2 /
+// OpenGL ES 3) from one buffer with an entry per block, in place of an
+// AddRectFilled and AddRect per block in the window draw list. Labels and
+// everything else stay with ImGui, which draws them over the blocks.
+//
+// The browser build links block_renderer_gl.cpp; native builds link it
+// when EGL and GLES are found (ui_bench --renderer gpu, headless on Mesa)
+// and block_renderer_none.cpp otherwise, where it is never available.
+class BlockRenderer {
+public:
+    struct Block {
+        float left, top, right, bottom;     // relative to the grid origin
+        ImU32 fill;
+        ImU32 border;                       // the fill again for unbordered ticks
+    };
+
+    BlockRenderer();
+    ~BlockRenderer();
+
+    // Needs the GL context current; false on WebGL 1 / GLES 2 contexts and
+    // in builds without GL, and the renderer then stays unavailable
+    bool init();
+    void shutdown();
+
+    bool available() const { return program_ != 0; }
+    // Off by default; the time grid draws with ImGui unless it is on
+    bool enabled() const { return enabled_ && available(); }
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    // True if the blocks must be laid out again with clear() and add()
+    bool update(const BlockLayout& layout);
+    void clear() { blocks_.clear(); dirty_ = true; }
+    void add(const Block& block);
+    // Queues the draw of every block at this point of drawList, with the
+    // grid origin where it is this frame. The buffer is uploaded there too
+    // if the blocks changed.
+    void draw(ImDrawList* drawList, const ImVec2& origin);
+
+    int blockCount() const { return (int)blocks_.size(); }
+    int uploadCount() const { return uploadCount_; }
+
+private:
+    static void renderCallback(const ImDrawList* drawList, const ImDrawCmd* cmd);
+    // GL side, at ImGui_ImplOpenGL3_RenderDrawData time
+    void render(const ImDrawCmd* cmd);
+    void upload();
+
+    bool enabled_;
+    bool valid_;
+    bool dirty_;        // blocks_ changed since the last upload
+    BlockLayout layout_;
+    ImVec2 origin_;
+    std::vector<Block> blocks_;
+    int uploadCount_;
+
+    unsigned int program_;
+    unsigned int vertexArray_;
+    unsigned int instanceBuffer_;
+    size_t bufferCapacity_;     // bytes
+    int originLocation_;
+    int scaleLocation_;
+};
+
+} // namespace calendar
+
+#endif // BLOCK_RENDERER_H
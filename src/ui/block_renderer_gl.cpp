@@ -0,0 +1,165 @@
+#include "block_renderer.h"
+#include "../core/profiler.h"
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstring>
+
+namespace calendar {
+
+namespace {
+
+// Each instance is one block; the four corners of its quad come from
+// gl_VertexID, so there is no per-vertex buffer at all
+const char* const kVertexShader =
+    "#version 300 es\n"
+    "layout(location = 0) in vec4 rect;\n"
+    "layout(location = 1) in vec4 fillColor;\n"
+    "layout(location = 2) in vec4 borderColor;\n"
+    "uniform vec2 origin;\n"    // grid origin, relative to the display
+    "uniform vec2 scale;\n"     // 2 / display size
+    "out vec2 local;\n"
+    "flat out vec2 size;\n"
+    "flat out vec4 fill;\n"
+    "flat out vec4 border;\n"
+    "void main() {\n"
+    "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+    "    size = rect.zw - rect.xy;\n"
+    "    local = corner * size;\n"
+    "    fill = fillColor;\n"
+    "    border = borderColor;\n"
+    "    vec2 pos = origin + rect.xy + local;\n"
+    "    gl_Position = vec4(pos.x * scale.x - 1.0, 1.0 - pos.y * scale.y, 0.0, 1.0);\n"
+    "}\n";
+
+// The border is the outermost pixel all round, where AddRect strokes it
+const char* const kFragmentShader =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "in vec2 local;\n"
+    "flat in vec2 size;\n"
+    "flat in vec4 fill;\n"
+    "flat in vec4 border;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "    vec2 edge = min(local, size - local);\n"
+    "    color = min(edge.x, edge.y) < 1.0 ? border : fill;\n"
+    "}\n";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+bool BlockRenderer::init() {
+    if (program_) return true;
+    // WebGL2 reports "OpenGL ES 3.0 (WebGL 2.0)"; a WebGL 1 context has
+    // neither instancing nor GLSL ES 3.00
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (!version || !strstr(version, "OpenGL ES") || strstr(version, "OpenGL ES 2")) return false;
+
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, kVertexShader);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+    GLuint program = vertex && fragment ? glCreateProgram() : 0;
+    if (program) {
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vertex) glDeleteShader(vertex);
+    if (fragment) glDeleteShader(fragment);
+    if (!program) return false;
+    program_ = program;
+    originLocation_ = glGetUniformLocation(program_, "origin");
+    scaleLocation_ = glGetUniformLocation(program_, "scale");
+
+    // The vertex array keeps the instanced attribute setup, so drawing only
+    // binds it
+    glGenVertexArrays(1, &vertexArray_);
+    glGenBuffers(1, &instanceBuffer_);
+    glBindVertexArray(vertexArray_);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Block), (void*)offsetof(Block, left));
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Block), (void*)offsetof(Block, fill));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Block), (void*)offsetof(Block, border));
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bufferCapacity_ = 0;
+    dirty_ = true;
+    return true;
+}
+
+void BlockRenderer::shutdown() {
+    if (!program_) return;
+    glDeleteBuffers(1, &instanceBuffer_);
+    glDeleteVertexArrays(1, &vertexArray_);
+    glDeleteProgram(program_);
+    program_ = 0;
+    vertexArray_ = 0;
+    instanceBuffer_ = 0;
+    bufferCapacity_ = 0;
+}
+
+void BlockRenderer::upload() {
+    // Grows by reallocating, otherwise overwrites in place
+    size_t bytes = blocks_.size() * sizeof(Block);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    if (bytes > bufferCapacity_) {
+        bufferCapacity_ = bytes + bytes / 2;
+        glBufferData(GL_ARRAY_BUFFER, bufferCapacity_, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, blocks_.data());
+    dirty_ = false;
+    uploadCount_++;
+    PROFILE_COUNT("gl.uploads", 1);
+}
+
+void BlockRenderer::render(const ImDrawCmd* cmd) {
+    PROFILE_SCOPE("gl.blocks");
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    // The backend applies clip rectangles to draw commands only, so the
+    // callback scissors itself to its window
+    ImVec2 clipOffset = drawData->DisplayPos;
+    ImVec2 clipScale = drawData->FramebufferScale;
+    float framebufferHeight = drawData->DisplaySize.y * clipScale.y;
+    float clipLeft = (cmd->ClipRect.x - clipOffset.x) * clipScale.x;
+    float clipTop = (cmd->ClipRect.y - clipOffset.y) * clipScale.y;
+    float clipRight = (cmd->ClipRect.z - clipOffset.x) * clipScale.x;
+    float clipBottom = (cmd->ClipRect.w - clipOffset.y) * clipScale.y;
+    if (clipRight <= clipLeft || clipBottom <= clipTop) return;
+    glScissor((GLint)clipLeft, (GLint)(framebufferHeight - clipBottom),
+              (GLsizei)(clipRight - clipLeft), (GLsizei)(clipBottom - clipTop));
+
+    glUseProgram(program_);
+    glUniform2f(originLocation_, origin_.x - clipOffset.x, origin_.y - clipOffset.y);
+    glUniform2f(scaleLocation_, 2.0f / drawData->DisplaySize.x, 2.0f / drawData->DisplaySize.y);
+    glBindVertexArray(vertexArray_);
+    if (dirty_) upload();
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)blocks_.size());
+    // The GLES 2 backend sets its attributes on whatever array is bound
+    glBindVertexArray(0);
+    PROFILE_COUNT("gl.instances", (int)blocks_.size());
+}
+
+} // namespace calendar
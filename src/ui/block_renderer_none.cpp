@@ -0,0 +1,15 @@
+#include "block_renderer.h"
+
+namespace calendar {
+
+bool BlockRenderer::init() {
+    return false;
+}
+
+void BlockRenderer::shutdown() {}
+
+void BlockRenderer::upload() {}
+
+void BlockRenderer::render(const ImDrawCmd*) {}
+
+} // namespace calendar
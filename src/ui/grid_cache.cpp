@@ -0,0 +1,101 @@
+#include "grid_cache.h"
+#include "../core/memory_tracker.h"
+
+namespace calendar {
+
+namespace {
+
+const char* const kHourLabels[24] = {
+    "00:00", "01:00", "02:00", "03:00", "04:00", "05:00", "06:00", "07:00",
+    "08:00", "09:00", "10:00", "11:00", "12:00", "13:00", "14:00", "15:00",
+    "16:00", "17:00", "18:00", "19:00", "20:00", "21:00", "22:00", "23:00"
+};
+
+} // namespace
+
+GridCache::GridCache() : layout_(), valid_(false), rebuildCount_(0) {}
+
+bool GridCache::update(const GridLayout& layout) {
+    if (valid_ && layout == layout_) {
+        return false;
+    }
+    layout_ = layout;
+    rebuild();
+    valid_ = true;
+    return true;
+}
+
+void GridCache::rebuild() {
+    MEMORY_SCOPE(MEM_UI_CACHES);
+    // Record into a scratch list so lines and text get ImGui's own tessellation
+    ImDrawList scratch(ImGui::GetDrawListSharedData());
+    scratch._ResetForNewFrame();
+    scratch.PushTextureID(ImGui::GetIO().Fonts->TexID);
+    scratch.PushClipRect(ImVec2(-16384.0f, -16384.0f), ImVec2(16384.0f, 16384.0f));
+
+    ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+    ImU32 lineColor = ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.5f, 0.3f, 0.5f));
+
+    int totalHours = layout_.endHour - layout_.startHour;
+    float gridRight = layout_.timeColumnWidth + layout_.columnWidth * layout_.numDays;
+    hourVertexStart_.resize(totalHours + 1);
+    hourIndexStart_.resize(totalHours + 1);
+    for (int i = 0; i < totalHours; i++) {
+        float y = i * layout_.hourHeight;
+        hourVertexStart_[i] = scratch.VtxBuffer.Size;
+        hourIndexStart_[i] = scratch.IdxBuffer.Size;
+        scratch.AddText(ImVec2(0.0f, y), textColor, kHourLabels[(layout_.startHour + i) % 24]);
+        scratch.AddLine(ImVec2(layout_.timeColumnWidth, y), ImVec2(gridRight, y), lineColor);
+    }
+    hourVertexStart_[totalHours] = scratch.VtxBuffer.Size;
+    hourIndexStart_[totalHours] = scratch.IdxBuffer.Size;
+    for (int i = 0; i <= layout_.numDays; i++) {
+        float x = layout_.timeColumnWidth + i * layout_.columnWidth;
+        scratch.AddLine(ImVec2(x, 0.0f), ImVec2(x, totalHours * layout_.hourHeight), lineColor);
+    }
+
+    vertices_.assign(scratch.VtxBuffer.begin(), scratch.VtxBuffer.end());
+    indices_.assign(scratch.IdxBuffer.begin(), scratch.IdxBuffer.end());
+    rebuildCount_++;
+}
+
+void GridCache::replay(ImDrawList* drawList, const ImVec2& origin, int firstHour, int lastHour) const {
+    if (vertices_.empty()) return;
+
+    int totalHours = layout_.endHour - layout_.startHour;
+    int first = firstHour - layout_.startHour;
+    int last = lastHour - layout_.startHour;
+    if (first < 0) first = 0;
+    if (last > totalHours) last = totalHours;
+    if (first < last) {
+        copyRange(drawList, origin, hourVertexStart_[first], hourVertexStart_[last],
+                  hourIndexStart_[first], hourIndexStart_[last]);
+    }
+    copyRange(drawList, origin, hourVertexStart_[totalHours], (int)vertices_.size(),
+              hourIndexStart_[totalHours], (int)indices_.size());
+}
+
+void GridCache::copyRange(ImDrawList* drawList, const ImVec2& origin,
+                          int vtxBegin, int vtxEnd, int idxBegin, int idxEnd) const {
+    if (idxBegin >= idxEnd) return;
+
+    drawList->PrimReserve(idxEnd - idxBegin, vtxEnd - vtxBegin);
+    // Read after PrimReserve, which may start a new vertex offset block
+    unsigned int base = drawList->_VtxCurrentIdx;
+    ImDrawVert* vtx = drawList->_VtxWritePtr;
+    for (int i = vtxBegin; i < vtxEnd; i++) {
+        *vtx = vertices_[i];
+        vtx->pos.x += origin.x;
+        vtx->pos.y += origin.y;
+        vtx++;
+    }
+    ImDrawIdx* idx = drawList->_IdxWritePtr;
+    for (int i = idxBegin; i < idxEnd; i++) {
+        *idx++ = (ImDrawIdx)(base + indices_[i] - vtxBegin);
+    }
+    drawList->_VtxWritePtr = vtx;
+    drawList->_IdxWritePtr = idx;
+    drawList->_VtxCurrentIdx += (unsigned int)(vtxEnd - vtxBegin);
+}
+
+} // namespace calendar
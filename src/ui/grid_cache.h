@@ -0,0 +1,58 @@
+#ifndef GRID_CACHE_H
+#define GRID_CACHE_H
+
+#include "imgui.h"
+#include <vector>
+
+namespace calendar {
+
+// Everything that shapes the static time grid. Geometry is rebuilt only when
+// one of these changes (resize, view span or zoom), never per frame.
+struct GridLayout {
+    float timeColumnWidth;
+    float columnWidth;
+    float hourHeight;
+    int numDays;
+    int startHour;
+    int endHour;
+
+    bool operator==(const GridLayout& other) const {
+        return timeColumnWidth == other.timeColumnWidth && columnWidth == other.columnWidth &&
+               hourHeight == other.hourHeight && numDays == other.numDays &&
+               startHour == other.startHour && endHour == other.endHour;
+    }
+    bool operator!=(const GridLayout& other) const { return !(*this == other); }
+};
+
+// Hour labels and grid lines recorded once into origin-relative vertex and
+// index buffers, then copied into the window draw list with a translation.
+class GridCache {
+public:
+    GridCache();
+
+    // Rebuilds the geometry if the layout changed; returns true if it did
+    bool update(const GridLayout& layout);
+    // Copies the rows for hours [firstHour, lastHour) plus the column lines
+    void replay(ImDrawList* drawList, const ImVec2& origin, int firstHour, int lastHour) const;
+
+    int vertexCount() const { return (int)vertices_.size(); }
+    int rebuildCount() const { return rebuildCount_; }
+
+private:
+    void rebuild();
+    void copyRange(ImDrawList* drawList, const ImVec2& origin,
+                   int vtxBegin, int vtxEnd, int idxBegin, int idxEnd) const;
+
+    GridLayout layout_;
+    bool valid_;
+    std::vector<ImDrawVert> vertices_;
+    std::vector<ImDrawIdx> indices_;
+    // Buffer offsets where each hour row starts; entry [hours] starts the column lines
+    std::vector<int> hourVertexStart_;
+    std::vector<int> hourIndexStart_;
+    int rebuildCount_;
+};
+
+} // namespace calendar
+
+#endif // GRID_CACHE_H
@@ -0,0 +1,116 @@
+#include "hit_index.h"
+#include "../core/memory_tracker.h"
+#include <algorithm>
+
+namespace calendar {
+
+HitIndex::HitIndex()
+    : origin_(0.0f, 0.0f), columnWidth_(0.0f), hourHeight_(0.0f), numColumns_(0), startHour_(0),
+      endHour_(0), added_(ArenaAllocator<Hit>(FrameArena::frame())), sorted_(nullptr),
+      columnStart_(nullptr), maxBottom_(nullptr) {}
+
+void HitIndex::reset(const ImVec2& origin, float columnWidth, int numColumns,
+                     float hourHeight, int startHour, int endHour) {
+    MEMORY_SCOPE(MEM_UI_FRAME);
+    origin_ = origin;
+    columnWidth_ = columnWidth;
+    hourHeight_ = hourHeight;
+    numColumns_ = numColumns;
+    startHour_ = startHour;
+    endHour_ = endHour;
+
+    // Last frame's storage went with the arena's reset; start a new vector
+    // rather than clearing one that points into it
+    FrameArena& arena = FrameArena::frame();
+    added_ = FrameVector<Hit>(ArenaAllocator<Hit>(arena));
+    sorted_ = nullptr;
+    maxBottom_ = nullptr;
+    columnStart_ = arena.allocateArray<uint32_t>(numColumns + 1);
+    for (int i = 0; i <= numColumns; i++) columnStart_[i] = 0;
+}
+
+void HitIndex::add(int column, float top, float bottom, Event* event) {
+    MEMORY_SCOPE(MEM_UI_FRAME);
+    added_.push_back({event, column, top, bottom});
+}
+
+void HitIndex::finalize() {
+    MEMORY_SCOPE(MEM_UI_FRAME);
+    FrameArena& arena = FrameArena::frame();
+    size_t count = added_.size();
+    sorted_ = arena.allocateArray<Hit>(count);
+    maxBottom_ = arena.allocateArray<float>(count);
+
+    // Bucket by column, keeping add() order within each
+    for (const Hit& hit : added_) columnStart_[hit.column + 1]++;
+    for (int i = 0; i < numColumns_; i++) columnStart_[i + 1] += columnStart_[i];
+    uint32_t* next = arena.allocateArray<uint32_t>(numColumns_);
+    for (int i = 0; i < numColumns_; i++) next[i] = columnStart_[i];
+    for (const Hit& hit : added_) sorted_[next[hit.column]++] = hit;
+
+    for (int i = 0; i < numColumns_; i++) {
+        Hit* blocks = sorted_ + columnStart_[i];
+        size_t size = columnStart_[i + 1] - columnStart_[i];
+        // Blocks arrive in start-time order, so this insertion sort is a
+        // linear pass; it is stable (equal tops keep draw order) and, unlike
+        // std::stable_sort, needs no temporary buffer.
+        for (size_t j = 1; j < size; j++) {
+            Hit hit = blocks[j];
+            size_t k = j;
+            while (k > 0 && blocks[k - 1].top > hit.top) {
+                blocks[k] = blocks[k - 1];
+                k--;
+            }
+            blocks[k] = hit;
+        }
+        float runningMax = -1e30f;
+        float* maxBottom = maxBottom_ + columnStart_[i];
+        for (size_t j = 0; j < size; j++) {
+            if (blocks[j].bottom > runningMax) runningMax = blocks[j].bottom;
+            maxBottom[j] = runningMax;
+        }
+    }
+}
+
+bool HitIndex::query(const ImVec2& pos, Hit& out) const {
+    int column = columnAt(pos.x);
+    if (column < 0) return false;
+
+    const Hit* blocks = sorted_ + columnStart_[column];
+    const Hit* blocksEnd = sorted_ + columnStart_[column + 1];
+    const float* maxBottom = maxBottom_ + columnStart_[column];
+
+    // Last block starting at or above pos.y; it was drawn last, so it is on top
+    const Hit* it = std::upper_bound(blocks, blocksEnd, pos.y, [](float y, const Hit& hit) {
+        return y < hit.top;
+    });
+    for (int i = (int)(it - blocks) - 1; i >= 0; i--) {
+        if (maxBottom[i] < pos.y) break;   // nothing earlier reaches down to pos
+        if (blocks[i].bottom >= pos.y) {
+            out = blocks[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HitIndex::containsPoint(const ImVec2& pos) const {
+    return pos.x >= origin_.x && pos.x < origin_.x + columnWidth_ * numColumns_ &&
+           pos.y >= origin_.y && pos.y < origin_.y + (endHour_ - startHour_) * hourHeight_;
+}
+
+int HitIndex::columnAt(float x) const {
+    if (x < origin_.x || columnWidth_ <= 0.0f) return -1;
+    int column = (int)((x - origin_.x) / columnWidth_);
+    return column < numColumns_ ? column : -1;
+}
+
+int HitIndex::minutesAt(float y) const {
+    return startHour_ * 60 + (int)(((y - origin_.y) / hourHeight_) * 60.0f);
+}
+
+float HitIndex::yForMinutes(int minutes) const {
+    return origin_.y + (minutes - startHour_ * 60) * hourHeight_ / 60.0f;
+}
+
+} // namespace calendar
@@ -0,0 +1,73 @@
+#ifndef HIT_INDEX_H
+#define HIT_INDEX_H
+
+#include "imgui.h"
+#include "../core/event.h"
+#include "../core/frame_arena.h"
+#include <cstdint>
+
+namespace calendar {
+
+// Event block rectangles of the time grid, bucketed per day column and
+// sorted by top edge. Rebuilt once per frame from the layout pass, it is the
+// single source for drawing, hover, click, drag-start and drop targeting.
+// Everything it holds comes from the frame arena, so it may only be queried
+// in the frame that built it.
+class HitIndex {
+public:
+    struct Hit {
+        Event* event;
+        int column;
+        float top;
+        float bottom;
+    };
+
+    // The blocks of one column, for range-for
+    struct Blocks {
+        const Hit* first;
+        const Hit* last;
+        const Hit* begin() const { return first; }
+        const Hit* end() const { return last; }
+    };
+
+    HitIndex();
+
+    void reset(const ImVec2& origin, float columnWidth, int numColumns,
+               float hourHeight, int startHour, int endHour);
+    void add(int column, float top, float bottom, Event* event);
+    // Sorts the columns; call once after the last add() and before queries
+    void finalize();
+
+    // Topmost block under pos. O(1) to find the column, then a binary search
+    // on top edges; overlapping blocks only extend the walk by the overlap depth.
+    bool query(const ImVec2& pos, Hit& out) const;
+
+    // Grid geometry shared by every interaction
+    bool containsPoint(const ImVec2& pos) const;
+    int columnAt(float x) const;                // -1 outside the grid
+    int minutesAt(float y) const;               // minute of day, not clamped
+    float yForMinutes(int minutes) const;
+    float columnLeft(int column) const { return origin_.x + column * columnWidth_; }
+    float columnWidth() const { return columnWidth_; }
+
+    int columnCount() const { return numColumns_; }
+    Blocks blocks(int column) const {
+        return {sorted_ + columnStart_[column], sorted_ + columnStart_[column + 1]};
+    }
+
+private:
+    ImVec2 origin_;
+    float columnWidth_;
+    float hourHeight_;
+    int numColumns_;
+    int startHour_;
+    int endHour_;
+    FrameVector<Hit> added_;    // in add() order
+    Hit* sorted_;               // by column, then top edge
+    uint32_t* columnStart_;     // column c is sorted_[columnStart_[c], columnStart_[c + 1])
+    float* maxBottom_;          // running max of bottom edges within each column
+};
+
+} // namespace calendar
+
+#endif // HIT_INDEX_H
@@ -0,0 +1,73 @@
+#include "label_cache.h"
+#include "imgui.h"
+#include "../core/memory_tracker.h"
+#include "../core/profiler.h"
+#include <cstring>
+
+namespace calendar {
+
+const char* LabelCache::get(const Event& event, float maxWidth) {
+    auto it = entries_.find(event.id);
+    if (it != entries_.end() && it->second.version == event.version && it->second.width == maxWidth) {
+        return it->second.text.c_str();
+    }
+
+    PROFILE_COUNT("labels.formatted", 1);
+    MEMORY_SCOPE(MEM_TEXT);
+    Entry& entry = entries_[event.id];
+    entry.version = event.version;
+    entry.width = maxWidth;
+    entry.text.clear();
+    format(event, maxWidth, entry.text);
+    return entry.text.c_str();
+}
+
+void LabelCache::trim(size_t liveEvents) {
+    if (entries_.size() > liveEvents * 2 + 64) {
+        entries_.clear();
+    }
+}
+
+void LabelCache::format(const Event& event, float maxWidth, std::string& out) const {
+    char timeStr[32];
+    EventManager::formatEventTime(&event, timeStr, sizeof(timeStr));
+
+    if (style_ == STYLE_LIST) {
+        out += '[';
+        out += timeStr;
+        out += "] ";
+        out += event.text;
+        return;
+    }
+
+    // All-day banners show the description only
+    if (!event.isAllDay) {
+        appendFitted(timeStr, maxWidth, out);
+        out += '\n';
+    }
+    appendFitted(event.text.c_str(), maxWidth, out);
+}
+
+void LabelCache::appendFitted(const char* text, float maxWidth, std::string& out) {
+    size_t len = strlen(text);
+    if (maxWidth <= 0.0f || ImGui::CalcTextSize(text, text + len).x <= maxWidth) {
+        out.append(text, len);
+        return;
+    }
+
+    // Longest prefix that still fits with the ellipsis, on a UTF-8 boundary
+    const char* ellipsis = "...";
+    float budget = maxWidth - ImGui::CalcTextSize(ellipsis).x;
+    size_t lo = 0;
+    size_t hi = len;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (ImGui::CalcTextSize(text, text + mid).x <= budget) lo = mid;
+        else hi = mid - 1;
+    }
+    while (lo > 0 && (static_cast<unsigned char>(text[lo]) & 0xC0) == 0x80) lo--;
+    out.append(text, lo);
+    out += ellipsis;
+}
+
+} // namespace calendar
@@ -0,0 +1,43 @@
+#ifndef LABEL_CACHE_H
+#define LABEL_CACHE_H
+
+#include "../core/event.h"
+#include <string>
+#include <unordered_map>
+
+namespace calendar {
+
+// Formatted event labels kept across frames. An entry is rebuilt only when
+// its event's version or the available width changes, so steady-state
+// frames neither format nor allocate.
+class LabelCache {
+public:
+    enum Style {
+        STYLE_BLOCK,    // "09:00 - 10:00\nText", each line fitted to the width
+        STYLE_LIST      // "[09:00 - 10:00] Text"
+    };
+
+    explicit LabelCache(Style style) : style_(style) {}
+
+    // maxWidth <= 0 disables truncation
+    const char* get(const Event& event, float maxWidth);
+    // Drops stale entries once the cache is well past the live event count
+    void trim(size_t liveEvents);
+
+private:
+    struct Entry {
+        uint32_t version;
+        float width;
+        std::string text;
+    };
+
+    void format(const Event& event, float maxWidth, std::string& out) const;
+    static void appendFitted(const char* text, float maxWidth, std::string& out);
+
+    Style style_;
+    std::unordered_map<uint32_t, Entry> entries_;
+};
+
+} // namespace calendar
+
+#endif // LABEL_CACHE_H
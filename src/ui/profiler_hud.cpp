@@ -0,0 +1,178 @@
+#include "profiler_hud.h"
+#include "imgui.h"
+#include "../core/file_io.h"
+#include "../core/frame_arena.h"
+#include "../core/memory_tracker.h"
+#include <algorithm>
+#include <string>
+
+namespace calendar {
+
+float ProfilerHUD::percentile(float* values, int count, float fraction) {
+    if (count == 0) return 0.0f;
+    int k = (int)(fraction * (count - 1) + 0.5f);
+    std::nth_element(values, values + k, values + count);
+    return values[k];
+}
+
+void ProfilerHUD::dumpTrace() {
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string json;
+    Profiler::instance().writeChromeTrace(json);
+    FileIO::downloadFile("calendar-trace.json", "application/json", json);
+}
+
+void ProfilerHUD::dumpMemory(size_t eventCount) {
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string json;
+    MemoryTracker::writeJSON(json, eventCount);
+    FileIO::downloadFile("calendar-memory.json", "application/json", json);
+}
+
+void ProfilerHUD::renderMemory(size_t eventCount) {
+    const float kb = 1.0f / 1024.0f;
+    const float mb = kb * kb;
+    int64_t eventBytes = MemoryTracker::stats(MEM_EVENTS).liveBytes + MemoryTracker::stats(MEM_TEXT).liveBytes +
+                         MemoryTracker::stats(MEM_INDEXES).liveBytes;
+    ImGui::Text("WASM HEAP %.1f MB   TRACKED %.1f MB", MemoryTracker::heapSize() * mb,
+                MemoryTracker::liveBytes() * mb);
+    if (eventCount > 0) {
+        ImGui::Text("BYTES / EVENT %.0f   (%zu EVENTS)", (double)eventBytes / eventCount, eventCount);
+    }
+    const FrameArena& arena = FrameArena::frame();
+    ImGui::Text("FRAME ARENA %.1f / %.1f KB   HIGH WATER %.1f KB", arena.bytesUsed() * kb,
+                arena.capacity() * kb, arena.highWater() * kb);
+
+    if (ImGui::BeginTable("memory", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("SUBSYSTEM");
+        ImGui::TableSetupColumn("LIVE KB");
+        ImGui::TableSetupColumn("PEAK KB");
+        ImGui::TableSetupColumn("BLOCKS");
+        ImGui::TableSetupColumn("ALLOCS");
+        ImGui::TableHeadersRow();
+        for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+            MemoryTracker::TagStats stats = MemoryTracker::stats((MemoryTag)tag);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(MemoryTracker::tagName((MemoryTag)tag));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.liveBytes * kb);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.peakBytes * kb);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", (long long)stats.liveAllocations);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)stats.totalAllocations);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ProfilerHUD::render(size_t eventCount) {
+    Profiler& profiler = Profiler::instance();
+    if (ImGui::IsKeyPressed(ImGuiKey_F2, false)) {
+        visible_ = !visible_;
+        profiler.setEnabled(visible_);
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false) && profiler.enabled()) {
+        dumpTrace();
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_F4, false)) {
+        dumpMemory(eventCount);
+    }
+    if (!visible_) return;
+
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(display.x - 430.0f, 10.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(420.0f, 0.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    ImGui::Begin("PROFILER", nullptr,
+                 ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
+                 ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoSavedSettings);
+
+    int frames = profiler.historySize();
+    if (frames == 0) {
+        ImGui::TextDisabled("Recording... (F2 off, F3 dump trace)");
+        renderMemory(eventCount);
+        ImGui::End();
+        return;
+    }
+
+    // Frame times
+    float allocTotal = 0.0f;
+    for (int i = 0; i < frames; i++) {
+        plot_[i] = scratch_[i] = profiler.history(i).frameMs;
+        allocTotal += (float)profiler.history(i).frameAllocs;
+    }
+    float p50 = percentile(scratch_, frames, 0.50f);
+    float p95 = percentile(scratch_, frames, 0.95f);
+    float p99 = percentile(scratch_, frames, 0.99f);
+    float worst = *std::max_element(scratch_, scratch_ + frames);
+    ImGui::Text("FRAME MS  P50 %.2f  P95 %.2f  P99 %.2f  MAX %.2f", p50, p95, p99, worst);
+    ImGui::Text("ALLOCS / FRAME %.1f   (%d FRAMES)", allocTotal / frames, frames);
+    ImGui::PlotLines("##frame_ms", plot_, frames, 0, nullptr, 0.0f, p99 > 16.7f ? p99 : 16.7f,
+                     ImVec2(-1.0f, 60.0f));
+
+    // Sections
+    if (ImGui::BeginTable("sections", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("SECTION");
+        ImGui::TableSetupColumn("AVG MS");
+        ImGui::TableSetupColumn("P95 MS");
+        ImGui::TableSetupColumn("CALLS/F");
+        ImGui::TableSetupColumn("ALLOC/F");
+        ImGui::TableHeadersRow();
+        for (int id = 0; id < profiler.sectionCount(); id++) {
+            float totalMs = 0.0f;
+            uint64_t calls = 0;
+            uint64_t allocs = 0;
+            for (int i = 0; i < frames; i++) {
+                const Profiler::FrameRecord& frame = profiler.history(i);
+                scratch_[i] = frame.sectionMs[id];
+                totalMs += frame.sectionMs[id];
+                calls += frame.sectionCalls[id];
+                allocs += frame.sectionAllocs[id];
+            }
+            if (calls == 0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(profiler.sectionName(id));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", totalMs / frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentile(scratch_, frames, 0.95f));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (float)calls / frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (float)allocs / frames);
+        }
+        ImGui::EndTable();
+    }
+
+    // Counters, as of the last frame and averaged
+    if (profiler.counterCount() > 0 &&
+        ImGui::BeginTable("counters", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("COUNTER");
+        ImGui::TableSetupColumn("LAST");
+        ImGui::TableSetupColumn("AVG/F");
+        ImGui::TableHeadersRow();
+        const Profiler::FrameRecord& last = profiler.history(frames - 1);
+        for (int id = 0; id < profiler.counterCount(); id++) {
+            int64_t total = 0;
+            for (int i = 0; i < frames; i++) total += profiler.history(i).counters[id];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(profiler.counterName(id));
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", (long long)last.counters[id]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (float)total / frames);
+        }
+        ImGui::EndTable();
+    }
+
+    renderMemory(eventCount);
+    ImGui::TextDisabled("F2 HIDE   F3 CHROME TRACE   F4 MEMORY REPORT");
+    ImGui::End();
+}
+
+} // namespace calendar
@@ -0,0 +1,32 @@
+#ifndef PROFILER_HUD_H
+#define PROFILER_HUD_H
+
+#include "../core/profiler.h"
+
+namespace calendar {
+
+// Overlay for the frame profiler and memory accounting. F2 toggles
+// profiling and the overlay; F3 downloads the recorded scopes as a Chrome
+// trace and F4 the per-subsystem memory report.
+class ProfilerHUD {
+public:
+    ProfilerHUD() : visible_(false) {}
+
+    void render(size_t eventCount);
+    bool visible() const { return visible_; }
+
+private:
+    void dumpTrace();
+    void dumpMemory(size_t eventCount);
+    void renderMemory(size_t eventCount);
+    // Partially sorts values in place and returns the given percentile
+    static float percentile(float* values, int count, float fraction);
+
+    bool visible_;
+    float scratch_[Profiler::kHistoryFrames];
+    float plot_[Profiler::kHistoryFrames];
+};
+
+} // namespace calendar
+
+#endif // PROFILER_HUD_H
@@ -0,0 +1,229 @@
+#include "trace_session.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "../core/clock.h"
+#include "../core/file_io.h"
+#include "../core/memory_tracker.h"
+#include "../core/profiler.h"
+#include "../core/storage.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace calendar {
+
+namespace {
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t k = (size_t)(fraction * (double)(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// Converts one of ImGui's queued input events; false for kinds a trace
+// does not carry (viewport changes)
+bool toTraceInput(const ImGuiInputEvent& event, TraceInput& out) {
+    out = TraceInput();
+    switch (event.Type) {
+        case ImGuiInputEventType_MousePos:
+            out.type = TraceInput::MOUSE_POS;
+            out.x = event.MousePos.PosX;
+            out.y = event.MousePos.PosY;
+            return true;
+        case ImGuiInputEventType_MouseButton:
+            out.type = TraceInput::MOUSE_BUTTON;
+            out.code = event.MouseButton.Button;
+            out.down = event.MouseButton.Down;
+            return true;
+        case ImGuiInputEventType_MouseWheel:
+            out.type = TraceInput::MOUSE_WHEEL;
+            out.x = event.MouseWheel.WheelX;
+            out.y = event.MouseWheel.WheelY;
+            return true;
+        case ImGuiInputEventType_Key:
+            out.type = TraceInput::KEY;
+            out.code = (int)event.Key.Key;
+            out.down = event.Key.Down;
+            return true;
+        case ImGuiInputEventType_Text:
+            out.type = TraceInput::CHAR;
+            out.code = (int)event.Text.Char;
+            return true;
+        case ImGuiInputEventType_Focus:
+            out.type = TraceInput::FOCUS;
+            out.down = event.AppFocused.Focused;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void feedInput(ImGuiIO& io, const TraceInput& input) {
+    switch (input.type) {
+        case TraceInput::MOUSE_POS: io.AddMousePosEvent(input.x, input.y); break;
+        case TraceInput::MOUSE_BUTTON: io.AddMouseButtonEvent(input.code, input.down); break;
+        case TraceInput::MOUSE_WHEEL: io.AddMouseWheelEvent(input.x, input.y); break;
+        case TraceInput::KEY: io.AddKeyEvent((ImGuiKey)input.code, input.down); break;
+        case TraceInput::CHAR: io.AddInputCharacter((unsigned int)input.code); break;
+        case TraceInput::FOCUS: io.AddFocusEvent(input.down); break;
+    }
+}
+
+} // namespace
+
+TraceSession::TraceSession(EventManager& eventManager)
+    : eventManager_(eventManager), mode_(MODE_IDLE), resetRequested_(false),
+      pendingInputs_(0), frame_(0), frameStartMs_(0.0), frameStartAllocs_(0) {}
+
+void TraceSession::startRecording() {
+    tm now;
+    Clock::localNow(now);
+    Clock::pin(now.tm_year + 1900, now.tm_mon, now.tm_mday, now.tm_hour, now.tm_min);
+    trace_.clear();
+    trace_.setClock(now.tm_year + 1900, now.tm_mon, now.tm_mday, now.tm_hour, now.tm_min);
+    mode_ = MODE_RECORDING;
+    resetRequested_ = true;
+}
+
+void TraceSession::stopRecording() {
+    if (mode_ != MODE_RECORDING) return;
+    Clock::unpin();
+    mode_ = MODE_IDLE;
+
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string text;
+    trace_.serialize(text);
+    FileIO::downloadFile("calendar.trace", "text/plain", text);
+    trace_.clear();
+}
+
+void TraceSession::startReplay(const InputTrace& trace) {
+    trace_ = trace;
+    Clock::pin(trace_.clockYear(), trace_.clockMonth(), trace_.clockDay(), trace_.clockHour(),
+               trace_.clockMinute());
+    StorageManager::setPersistenceEnabled(false);
+    if (trace_.hasDataset()) {
+        std::vector<Event> events;
+        generateEvents(trace_.dataset(), events);
+        eventManager_.clear();
+        eventManager_.addEvents(events);
+    }
+
+    // Real input queued before the replay would otherwise leak into frame 0
+    GImGui->InputEventsQueue.resize(0);
+    pendingInputs_ = 0;
+    frame_ = 0;
+    timings_.clear();
+    timings_.reserve(trace_.frameCount());
+    mode_ = MODE_REPLAYING;
+    resetRequested_ = true;
+}
+
+void TraceSession::finishReplay() {
+    if (mode_ != MODE_REPLAYING) return;
+    Clock::unpin();
+    StorageManager::setPersistenceEnabled(true);
+    mode_ = MODE_IDLE;
+    resetRequested_ = true;
+}
+
+bool TraceSession::takeResetRequest() {
+    bool requested = resetRequested_;
+    resetRequested_ = false;
+    return requested;
+}
+
+void TraceSession::beforeNewFrame() {
+    ImGuiIO& io = ImGui::GetIO();
+    if (mode_ == MODE_RECORDING) {
+        trace_.addFrame(io.DeltaTime * 1000.0f, io.DisplaySize.x, io.DisplaySize.y);
+        const ImVector<ImGuiInputEvent>& queue = GImGui->InputEventsQueue;
+        for (int i = pendingInputs_; i < queue.Size; i++) {
+            TraceInput input;
+            if (toTraceInput(queue[i], input)) trace_.addInput(input);
+        }
+    } else if (mode_ == MODE_REPLAYING && frame_ < trace_.frameCount()) {
+        const InputTrace::Frame& frame = trace_.frame(frame_);
+        io.DeltaTime = frame.deltaMs > 0.0f ? frame.deltaMs / 1000.0f : 1.0f / 60.0f;
+        io.DisplaySize = ImVec2(frame.displayWidth, frame.displayHeight);
+        for (uint32_t i = frame.firstInput; i < frame.firstInput + frame.inputCount; i++) {
+            feedInput(io, trace_.input(i));
+        }
+        frameStartMs_ = Profiler::nowMs();
+        frameStartAllocs_ = MemoryTracker::totalAllocations();
+    }
+}
+
+void TraceSession::afterNewFrame() {
+    // NewFrame may trickle some inputs over to the next frame; those were
+    // already recorded with this one
+    pendingInputs_ = GImGui->InputEventsQueue.Size;
+}
+
+void TraceSession::endFrame() {
+    if (mode_ != MODE_REPLAYING || frame_ >= trace_.frameCount()) return;
+    FrameTiming timing;
+    timing.cpuMs = (float)(Profiler::nowMs() - frameStartMs_);
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    timing.vertices = drawData ? (uint32_t)drawData->TotalVtxCount : 0;
+    timing.indices = drawData ? (uint32_t)drawData->TotalIdxCount : 0;
+    timing.allocations = (uint32_t)(MemoryTracker::totalAllocations() - frameStartAllocs_);
+    timings_.push_back(timing);
+    frame_++;
+}
+
+void TraceSession::update() {
+    if (mode_ == MODE_LOADING) {
+        loadPickedFile();
+        return;
+    }
+    if (mode_ == MODE_REPLAYING) return;
+    if (ImGui::IsKeyPressed(ImGuiKey_F6, false)) {
+        if (mode_ == MODE_RECORDING) stopRecording();
+        else startRecording();
+    } else if (ImGui::IsKeyPressed(ImGuiKey_F7, false) && mode_ == MODE_IDLE) {
+        FileIO::requestFile(".trace");
+        mode_ = MODE_LOADING;
+    }
+}
+
+void TraceSession::loadPickedFile() {
+    if (!FileIO::isFileReady()) return;
+
+    MEMORY_SCOPE(MEM_STORAGE);
+    std::string text(FileIO::fileSize(), '\0');
+    size_t read = text.empty() ? 0 : FileIO::readChunk(0, &text[0], text.size());
+    text.resize(read);
+    FileIO::releaseFile();
+
+    mode_ = MODE_IDLE;
+    InputTrace trace;
+    if (!trace.parse(text)) {
+        printf("Not a calendar input trace\n");
+        return;
+    }
+    startReplay(trace);
+}
+
+void TraceSession::writeResultsJSON(std::string& out) const {
+    std::vector<double> cpuMs;
+    cpuMs.reserve(timings_.size());
+    for (const FrameTiming& timing : timings_) cpuMs.push_back(timing.cpuMs);
+    double maxMs = cpuMs.empty() ? 0.0 : *std::max_element(cpuMs.begin(), cpuMs.end());
+    double p50 = percentile(cpuMs, 0.50);
+    double p99 = percentile(cpuMs, 0.99);
+
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), "{\"frames\":%zu,\"p50Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,\"timings\":[",
+             timings_.size(), p50, p99, maxMs);
+    out += buffer;
+    for (size_t i = 0; i < timings_.size(); i++) {
+        const FrameTiming& timing = timings_[i];
+        snprintf(buffer, sizeof(buffer), "%s[%.4f,%u,%u,%u]", i > 0 ? "," : "", timing.cpuMs,
+                 timing.vertices, timing.indices, timing.allocations);
+        out += buffer;
+    }
+    out += "]}";
+}
+
+} // namespace calendar
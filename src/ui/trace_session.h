@@ -0,0 +1,82 @@
+#ifndef TRACE_SESSION_H
+#define TRACE_SESSION_H
+
+#include "../core/event.h"
+#include "../core/input_trace.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace calendar {
+
+// Records the input ImGui receives into an InputTrace, and replays a trace
+// by feeding its inputs back one frame at a time while timing every frame.
+// The host calls beforeNewFrame() after the platform backend's NewFrame,
+// afterNewFrame() right after ImGui::NewFrame and endFrame() after
+// ImGui::Render. F6 starts and stops a recording (downloaded as
+// calendar.trace); F7 picks a trace file to replay.
+class TraceSession {
+public:
+    struct FrameTiming {
+        float cpuMs;            // NewFrame to Render
+        uint32_t vertices;
+        uint32_t indices;
+        uint32_t allocations;
+    };
+
+    explicit TraceSession(EventManager& eventManager);
+
+    bool recording() const { return mode_ == MODE_RECORDING; }
+    bool replaying() const { return mode_ == MODE_REPLAYING; }
+
+    // Pins the clock at the current time until the recording stops
+    void startRecording();
+    void stopRecording();
+
+    // Pins the clock to the trace's, turns persistence off and, if the trace
+    // names a dataset, replaces the loaded events with it
+    void startReplay(const InputTrace& trace);
+    bool replayDone() const { return replaying() && frame_ >= trace_.frameCount(); }
+    // Unpins the clock and turns persistence back on; the host reloads the
+    // user's events
+    void finishReplay();
+
+    // Set when a recording or replay starts or a replay ends. The host then
+    // rebuilds its CalendarState and CalendarUI, so recording and replay
+    // both begin from the same UI state.
+    bool takeResetRequest();
+
+    void beforeNewFrame();
+    void afterNewFrame();
+    void endFrame();
+    // Hotkeys and the F7 file picker; call between NewFrame and Render
+    void update();
+
+    const std::vector<FrameTiming>& timings() const { return timings_; }
+    // {"frames":..,"p50Ms":..,"p99Ms":..,"maxMs":..,"timings":[[ms,vtx,idx,allocs],...]}
+    void writeResultsJSON(std::string& out) const;
+
+private:
+    enum Mode {
+        MODE_IDLE,
+        MODE_RECORDING,
+        MODE_LOADING,       // waiting for the picked trace file
+        MODE_REPLAYING
+    };
+
+    void loadPickedFile();
+
+    EventManager& eventManager_;
+    Mode mode_;
+    bool resetRequested_;
+    InputTrace trace_;
+    int pendingInputs_;     // inputs ImGui left queued for the next frame
+    size_t frame_;          // next frame to replay
+    double frameStartMs_;
+    uint64_t frameStartAllocs_;
+    std::vector<FrameTiming> timings_;
+};
+
+} // namespace calendar
+
+#endif // TRACE_SESSION_H
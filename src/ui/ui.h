@@ -3,13 +3,38 @@
 
 #include "../core/event.h"
 #include "../core/calendar.h"
+#include "../core/reminder_scheduler.h"
+#include "../core/task_scheduler.h"
+#include "grid_cache.h"
+#include "hit_index.h"
+#include "label_cache.h"
+#include <string>
+#include <vector>
 
 namespace calendar {
 
+class BlockRenderer;
+
 enum ViewMode {
     VIEW_MONTH,
     VIEW_WEEK,
-    VIEW_DAY
+    VIEW_DAY,
+    VIEW_YEAR,
+    VIEW_AGENDA,
+    VIEW_TIMELINE
+};
+
+// What the stats panel covers, around the selected date
+enum StatsRange {
+    STATS_WEEK,
+    STATS_MONTH,
+    STATS_YEAR
+};
+
+enum DragMode {
+    DRAG_MOVE,
+    DRAG_RESIZE_TOP,
+    DRAG_RESIZE_BOTTOM
 };
 
 struct CalendarState {
@@ -24,12 +49,23 @@ struct CalendarState {
     int eventHourEnd;
     int eventMinuteEnd;
     bool eventIsAllDay;
+    int eventReminder;      // minutes before the start, -1 for none
+    uint64_t eventTags;     // Event::tags for the next added event
     char eventInput[256];
+    char tagInput[32];      // name typed into the filter bar
     
     // Drag and drop state
     bool isDragging;
-    Event* draggedEvent;
+    uint64_t draggedUid;    // Dragged event, found again by uid every frame
     int dragOffsetMinutes;  // Offset from event start to where user grabbed
+    DragMode dragMode;
+    
+    float pixelsPerHour;    // time grid zoom
+    int timelineDays;       // 14, 30 or 90
+    int timelineStart;      // day number of the first timeline column
+    
+    bool showStats;
+    StatsRange statsRange;
     
     CalendarState();
     void initCurrentDate();
@@ -38,9 +74,22 @@ struct CalendarState {
 class CalendarUI {
 public:
     CalendarUI(CalendarState& state, EventManager& eventManager);
+    // Cancels an import or export still running for this UI
+    ~CalendarUI();
     
     void render();
     void setupTerminalStyle();
+    
+    // True while work is in flight that must advance even without input
+    bool wantsAnotherFrame() const;
+    // Adds an on-screen toast for a reminder that came due; the oldest
+    // go once more than kMaxToasts are up
+    void showReminder(const Reminder& reminder);
+    const GridCache& getGridCache() const { return gridCache_; }
+    // Time grid blocks go through renderer while it is enabled; it belongs
+    // to whoever owns the GL context and outlives this UI. Null draws
+    // everything with ImGui.
+    void setBlockRenderer(BlockRenderer* renderer) { blockRenderer_ = renderer; }
 
 private:
     void renderViewSelector();
@@ -49,9 +98,31 @@ private:
     void renderDayView();
     void renderWeekView();
     void renderMonthView();
+    void renderYearView();
+    void renderAgendaView();
+    void renderTimelineView();
     void renderAddEventDialog();
+    void renderReminderPicker();
+    void renderReminderToasts();
     
-    void renderTimeGrid(int startDay, int numDays);
+    // Tag filter bar, the add dialog's tag checkboxes and tag colours (ui_tags.cpp)
+    void renderTagFilterBar();
+    void renderTagPicker();
+    static ImU32 tagColor(int bit, float alpha);
+    // The colour of the event's first tag the filter shows, or untagged
+    ImU32 eventColor(const Event& event, float alpha, ImU32 untagged) const;
+    
+    // Time-usage panel (ui_stats.cpp)
+    void renderStatsPanel();
+    void statsRange(int& firstDay, int& lastDay) const;
+    
+    // iCalendar import/export, run as TaskScheduler tasks (ui_transfer.cpp)
+    void startImport();
+    void startExport();
+    bool transferActive() const;
+    void renderTransferProgress();
+    
+    void renderTimeGrid(int firstDayNumber, int numDays);
     void renderEventBlock(Event* event, float x, float y, float width, float height);
     void renderAllDayEvents(const std::vector<Event*>& events, float x, float y, float width);
     float getEventYPosition(int hour, int minute);
@@ -59,6 +130,35 @@ private:
     
     CalendarState& state_;
     EventManager& eventManager_;
+    
+    TaskId transferTask_;    // import or export in flight, 0 if none
+    
+    static const size_t kMaxToasts = 5;
+    static const int kStatsBusiestDays = 5;
+    std::vector<Reminder> toasts_;  // oldest first
+    
+    int agendaAnchorDay_;    // day number the agenda was last scrolled to
+    int gridScrollAnchor_;   // first day and column count the grid was scrolled for
+    float gridScrollY_;      // time grid scroll and zoom as of the last frame
+    float gridHourHeight_;
+    
+    // How much of each time grid column is drawn
+    enum GridDetail {
+        DETAIL_BLOCKS,      // labelled, bordered blocks
+        DETAIL_TICKS,       // unlabelled marks, still draggable
+        DETAIL_DENSITY      // per-hour shading from the day summary
+    };
+    struct GridDay {
+        int day, month, year;
+        size_t allDayCount;     // shown by the tag filter
+        GridDetail detail;
+    };
+    std::vector<GridDay> gridDays_;  // reused across frames
+    GridCache gridCache_;
+    LabelCache blockLabels_;
+    LabelCache listLabels_;
+    HitIndex hitIndex_;
+    BlockRenderer* blockRenderer_;
 };
 
 } // namespace calendar
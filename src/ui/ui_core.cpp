@@ -1,6 +1,9 @@
 #include "ui.h"
 #include "imgui.h"
-#include <ctime>
+#include "../core/clock.h"
+#include "../core/memory_tracker.h"
+#include "../core/profiler.h"
+#include <climits>
 
 namespace calendar {
 
@@ -8,24 +11,41 @@ CalendarState::CalendarState()
     : currentMonth(0), currentYear(0), selectedDay(0),
       showAddEvent(false), viewMode(VIEW_MONTH), weekStartDay(1),
       eventHourStart(9), eventMinuteStart(0),
-      eventHourEnd(10), eventMinuteEnd(0), eventIsAllDay(false),
-      isDragging(false), draggedEvent(nullptr), dragOffsetMinutes(0) {
+      eventHourEnd(10), eventMinuteEnd(0), eventIsAllDay(false), eventReminder(-1), eventTags(0),
+      isDragging(false), draggedUid(0), dragOffsetMinutes(0), dragMode(DRAG_MOVE),
+      pixelsPerHour(48.0f), timelineDays(30), timelineStart(0),
+      showStats(false), statsRange(STATS_WEEK) {
     eventInput[0] = '\0';
+    tagInput[0] = '\0';
     initCurrentDate();
+    timelineStart = CalendarLogic::toDayNumber(selectedDay, currentMonth, currentYear);
 }
 
 void CalendarState::initCurrentDate() {
-    time_t now = time(nullptr);
-    tm* timeinfo = localtime(&now);
-    currentMonth = timeinfo->tm_mon;
-    currentYear = timeinfo->tm_year + 1900;
-    selectedDay = timeinfo->tm_mday;
+    tm now;
+    Clock::localNow(now);
+    currentMonth = now.tm_mon;
+    currentYear = now.tm_year + 1900;
+    selectedDay = now.tm_mday;
 }
 
 CalendarUI::CalendarUI(CalendarState& state, EventManager& eventManager)
-    : state_(state), eventManager_(eventManager) {}
+    : state_(state), eventManager_(eventManager),
+      transferTask_(0),
+      agendaAnchorDay_(INT_MIN), gridScrollAnchor_(INT_MIN), gridScrollY_(0.0f), gridHourHeight_(0.0f),
+      blockLabels_(LabelCache::STYLE_BLOCK), listLabels_(LabelCache::STYLE_LIST), blockRenderer_(nullptr) {}
+
+CalendarUI::~CalendarUI() {
+    // The import task holds a reference to state_
+    TaskScheduler::instance().cancel(transferTask_);
+}
 
 void CalendarUI::render() {
+    PROFILE_SCOPE("ui.render");
+    MEMORY_SCOPE(MEM_UI_FRAME);
+    blockLabels_.trim(eventManager_.getEventCount());
+    listLabels_.trim(eventManager_.getEventCount());
+    
     // Use actual display size for responsive layout
     ImGuiIO& io = ImGui::GetIO();
     ImVec2 displaySize = io.DisplaySize;
@@ -47,6 +67,8 @@ void CalendarUI::render() {
     ImGui::Spacing();
 
     renderActionButtons();
+    renderTransferProgress();
+    renderTagFilterBar();
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Spacing();
@@ -61,9 +83,25 @@ void CalendarUI::render() {
         case VIEW_MONTH:
             renderMonthView();
             break;
+        case VIEW_YEAR:
+            renderYearView();
+            break;
+        case VIEW_AGENDA:
+            renderAgendaView();
+            break;
+        case VIEW_TIMELINE:
+            renderTimelineView();
+            break;
     }
 
     ImGui::End();
+    renderStatsPanel();
+    renderReminderToasts();
+}
+
+bool CalendarUI::wantsAnotherFrame() const {
+    // Not while an import only waits for its file to be picked
+    return (transferActive() && TaskScheduler::instance().hasRunnableTasks()) || state_.isDragging;
 }
 
 void CalendarUI::renderViewSelector() {
@@ -85,6 +123,25 @@ void CalendarUI::renderViewSelector() {
     if (ImGui::Button("MONTH")) {
         state_.viewMode = VIEW_MONTH;
     }
+    ImGui::SameLine();
+    if (ImGui::Button("YEAR")) {
+        state_.viewMode = VIEW_YEAR;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("AGENDA")) {
+        state_.viewMode = VIEW_AGENDA;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("TIMELINE")) {
+        state_.viewMode = VIEW_TIMELINE;
+        if (state_.selectedDay > 0) {
+            // Start on the Monday of the selected week
+            int mondayDay, mondayMonth, mondayYear;
+            CalendarLogic::getMondayOfWeek(state_.selectedDay, state_.currentMonth, state_.currentYear,
+                                          mondayDay, mondayMonth, mondayYear);
+            state_.timelineStart = CalendarLogic::toDayNumber(mondayDay, mondayMonth, mondayYear);
+        }
+    }
     
     ImGui::PopStyleVar();
 }
@@ -105,6 +162,10 @@ void CalendarUI::renderNavigation() {
             }
         } else if (state_.viewMode == VIEW_WEEK) {
             CalendarLogic::advanceWeek(state_.weekStartDay, state_.currentMonth, state_.currentYear, -1);
+        } else if (state_.viewMode == VIEW_YEAR) {
+            state_.currentYear--;
+        } else if (state_.viewMode == VIEW_TIMELINE) {
+            state_.timelineStart -= state_.timelineDays;
         } else {
             state_.currentMonth--;
             if (state_.currentMonth < 0) {
@@ -133,6 +194,15 @@ void CalendarUI::renderNavigation() {
         snprintf(title, sizeof(title), "%s %d-%d, %d", 
                 CalendarLogic::getMonthName(state_.currentMonth), 
                 state_.weekStartDay, lastValid, state_.currentYear);
+    } else if (state_.viewMode == VIEW_YEAR) {
+        snprintf(title, sizeof(title), "%d", state_.currentYear);
+    } else if (state_.viewMode == VIEW_TIMELINE) {
+        int firstDay, firstMonth, firstYear, lastDay, lastMonth, lastYear;
+        CalendarLogic::fromDayNumber(state_.timelineStart, firstDay, firstMonth, firstYear);
+        CalendarLogic::fromDayNumber(state_.timelineStart + state_.timelineDays - 1, lastDay, lastMonth, lastYear);
+        snprintf(title, sizeof(title), "%s %d - %s %d, %d",
+                CalendarLogic::getMonthName(firstMonth), firstDay,
+                CalendarLogic::getMonthName(lastMonth), lastDay, lastYear);
     } else {
         snprintf(title, sizeof(title), "%s %d", 
                 CalendarLogic::getMonthName(state_.currentMonth), state_.currentYear);
@@ -156,6 +226,10 @@ void CalendarUI::renderNavigation() {
             }
         } else if (state_.viewMode == VIEW_WEEK) {
             CalendarLogic::advanceWeek(state_.weekStartDay, state_.currentMonth, state_.currentYear, 1);
+        } else if (state_.viewMode == VIEW_YEAR) {
+            state_.currentYear++;
+        } else if (state_.viewMode == VIEW_TIMELINE) {
+            state_.timelineStart += state_.timelineDays;
         } else {
             state_.currentMonth++;
             if (state_.currentMonth > 11) {
@@ -174,12 +248,29 @@ void CalendarUI::renderActionButtons() {
             // Always start week on Monday
             CalendarLogic::getMondayOfWeek(state_.selectedDay, state_.currentMonth, state_.currentYear,
                                           state_.weekStartDay, state_.currentMonth, state_.currentYear);
+        } else if (state_.viewMode == VIEW_TIMELINE) {
+            int mondayDay, mondayMonth, mondayYear;
+            CalendarLogic::getMondayOfWeek(state_.selectedDay, state_.currentMonth, state_.currentYear,
+                                          mondayDay, mondayMonth, mondayYear);
+            state_.timelineStart = CalendarLogic::toDayNumber(mondayDay, mondayMonth, mondayYear);
         }
     }
     ImGui::SameLine();
     if (state_.selectedDay > 0 && ImGui::Button("ADD EVENT")) {
         state_.showAddEvent = !state_.showAddEvent;
     }
+    ImGui::SameLine();
+    if (ImGui::Button("IMPORT .ICS") && !transferActive()) {
+        startImport();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("EXPORT .ICS") && !transferActive()) {
+        startExport();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("STATS")) {
+        state_.showStats = !state_.showStats;
+    }
 }
 
 void CalendarUI::setupTerminalStyle() {
@@ -1,11 +1,71 @@
 #include "ui.h"
 #include "imgui.h"
+#include "../core/notifier.h"
 #include "../core/storage.h"
 #include <cstring>
 #include <cstdio>
 
 namespace calendar {
 
+namespace {
+
+const int kReminderChoices[] = {-1, 0, 5, 10, 15, 30, 60, 1440};
+const char* const kReminderLabels[] = {"NONE", "AT START", "5 MIN", "10 MIN", "15 MIN", "30 MIN", "1 HOUR", "1 DAY"};
+const int kReminderChoiceCount = sizeof(kReminderChoices) / sizeof(kReminderChoices[0]);
+
+} // namespace
+
+void CalendarUI::renderReminderPicker() {
+    int selected = 0;
+    for (int i = 0; i < kReminderChoiceCount; i++) {
+        if (kReminderChoices[i] == state_.eventReminder) selected = i;
+    }
+    ImGui::Text("REMIND:");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::Combo("##remind", &selected, kReminderLabels, kReminderChoiceCount)) {
+        state_.eventReminder = kReminderChoices[selected];
+        // Browsers only ask on a user gesture, and this is the first one
+        // that shows notifications are wanted
+        if (state_.eventReminder >= 0) Notifier::requestPermission();
+    }
+}
+
+void CalendarUI::showReminder(const Reminder& reminder) {
+    if (toasts_.size() >= kMaxToasts) toasts_.erase(toasts_.begin());
+    toasts_.push_back(reminder);
+}
+
+void CalendarUI::renderReminderToasts() {
+    if (toasts_.empty()) return;
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - 16.0f, io.DisplaySize.y - 16.0f), ImGuiCond_Always,
+                            ImVec2(1.0f, 1.0f));
+    ImGui::SetNextWindowSize(ImVec2(320.0f, 0.0f), ImGuiCond_Always);
+    ImGui::Begin("REMINDERS", nullptr,
+                 ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
+                 ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+
+    size_t dismissed = toasts_.size();
+    for (size_t i = 0; i < toasts_.size(); i++) {
+        const Reminder& reminder = toasts_[i];
+        ImGui::PushID((int)i);
+        if (reminder.hourStart < 0) {
+            ImGui::Text("%s %d: ALL DAY", CalendarLogic::getMonthName(reminder.month), reminder.day);
+        } else {
+            ImGui::Text("%s %d: %02d:%02d", CalendarLogic::getMonthName(reminder.month), reminder.day,
+                        reminder.hourStart, reminder.minuteStart);
+        }
+        ImGui::TextWrapped("%s", reminder.text.c_str());
+        if (ImGui::SmallButton("DISMISS")) dismissed = i;
+        ImGui::Separator();
+        ImGui::PopID();
+    }
+    if (dismissed < toasts_.size()) toasts_.erase(toasts_.begin() + dismissed);
+
+    ImGui::End();
+}
+
 void CalendarUI::renderAddEventDialog() {
     // Show as popup when triggered by right-click
     if (ImGui::BeginPopup("AddEventPopup")) {
@@ -45,6 +105,9 @@ void CalendarUI::renderAddEventDialog() {
             if (state_.eventMinuteEnd > 59) state_.eventMinuteEnd = 59;
         }
         
+        renderReminderPicker();
+        renderTagPicker();
+        
         ImGui::Text("DESCRIPTION:");
         ImGui::SetNextItemWidth(300);
         ImGui::InputText("##event", state_.eventInput, sizeof(state_.eventInput));
@@ -58,6 +121,10 @@ void CalendarUI::renderAddEventDialog() {
             evt.month = state_.currentMonth;
             evt.year = state_.currentYear;
             evt.isAllDay = state_.eventIsAllDay;
+            evt.reminderMinutes = state_.eventReminder;
+            evt.tags = state_.eventTags;
+            // Untagged, it would vanish under the current filter
+            if (!evt.tags && eventManager_.getTagFilter()) evt.tags = 1ull << firstTag(eventManager_.getTagFilter());
             
             if (state_.eventIsAllDay) {
                 evt.hourStart = -1;
@@ -128,6 +195,9 @@ void CalendarUI::renderAddEventDialog() {
             if (state_.eventMinuteEnd > 59) state_.eventMinuteEnd = 59;
         }
         
+        renderReminderPicker();
+        renderTagPicker();
+        
         ImGui::Text("DESCRIPTION:");
         ImGui::SetNextItemWidth(600);
         ImGui::InputText("##event", state_.eventInput, sizeof(state_.eventInput));
@@ -139,6 +209,10 @@ void CalendarUI::renderAddEventDialog() {
             evt.month = state_.currentMonth;
             evt.year = state_.currentYear;
             evt.isAllDay = state_.eventIsAllDay;
+            evt.reminderMinutes = state_.eventReminder;
+            evt.tags = state_.eventTags;
+            // Untagged, it would vanish under the current filter
+            if (!evt.tags && eventManager_.getTagFilter()) evt.tags = 1ull << firstTag(eventManager_.getTagFilter());
             
             if (state_.eventIsAllDay) {
                 evt.hourStart = -1;
@@ -0,0 +1,126 @@
+#include "ui.h"
+#include "imgui.h"
+#include "../core/profiler.h"
+#include <cfloat>
+#include <cstdio>
+
+namespace calendar {
+
+namespace {
+
+// "7H 05M"
+void formatHours(int minutes, char* buffer, size_t size) {
+    snprintf(buffer, size, "%dH %02dM", minutes / 60, minutes % 60);
+}
+
+// "Mar 4"
+void formatDay(int dayNumber, char* buffer, size_t size) {
+    int day, month, year;
+    CalendarLogic::fromDayNumber(dayNumber, day, month, year);
+    snprintf(buffer, size, "%.3s %d", CalendarLogic::getMonthName(month), day);
+}
+
+} // namespace
+
+void CalendarUI::statsRange(int& firstDay, int& lastDay) const {
+    int day = state_.selectedDay > 0 ? state_.selectedDay : 1;
+    switch (state_.statsRange) {
+        case STATS_WEEK: {
+            int mondayDay, mondayMonth, mondayYear;
+            CalendarLogic::getMondayOfWeek(day, state_.currentMonth, state_.currentYear,
+                                           mondayDay, mondayMonth, mondayYear);
+            firstDay = CalendarLogic::toDayNumber(mondayDay, mondayMonth, mondayYear);
+            lastDay = firstDay + 6;
+            break;
+        }
+        case STATS_MONTH:
+            firstDay = CalendarLogic::toDayNumber(1, state_.currentMonth, state_.currentYear);
+            lastDay = firstDay + CalendarLogic::getDaysInMonth(state_.currentMonth, state_.currentYear) - 1;
+            break;
+        case STATS_YEAR:
+            firstDay = CalendarLogic::toDayNumber(1, 0, state_.currentYear);
+            lastDay = CalendarLogic::toDayNumber(1, 0, state_.currentYear + 1) - 1;
+            break;
+    }
+}
+
+void CalendarUI::renderStatsPanel() {
+    if (!state_.showStats) return;
+    PROFILE_SCOPE("ui.stats");
+
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(10.0f, display.y * 0.25f), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(380.0f, 0.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.92f);
+    ImGui::Begin("STATS", &state_.showStats,
+                 ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
+                 ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoSavedSettings);
+
+    if (ImGui::RadioButton("WEEK", state_.statsRange == STATS_WEEK)) state_.statsRange = STATS_WEEK;
+    ImGui::SameLine();
+    if (ImGui::RadioButton("MONTH", state_.statsRange == STATS_MONTH)) state_.statsRange = STATS_MONTH;
+    ImGui::SameLine();
+    if (ImGui::RadioButton("YEAR", state_.statsRange == STATS_YEAR)) state_.statsRange = STATS_YEAR;
+
+    // Every figure below is an O(log n) lookup in the usage index, so the
+    // panel is simply recomputed each frame it is drawn
+    int firstDay, lastDay;
+    statsRange(firstDay, lastDay);
+    const UsageIndex& usage = eventManager_.getUsageIndex();
+    UsageIndex::Totals totals;
+    usage.totals(firstDay, lastDay, totals);
+
+    char first[16], last[16], hours[24];
+    formatDay(firstDay, first, sizeof(first));
+    formatDay(lastDay, last, sizeof(last));
+    ImGui::Text("%s - %s", first, last);
+    ImGui::Separator();
+
+    formatHours(totals.bookedMinutes, hours, sizeof(hours));
+    ImGui::Text("BOOKED %s IN %d EVENTS", hours, totals.events);
+    formatHours(totals.bookedMinutes / (lastDay - firstDay + 1), hours, sizeof(hours));
+    ImGui::Text("AVERAGE %s / DAY", hours);
+
+    float weekdayHours[7];
+    for (int i = 0; i < 7; i++) weekdayHours[i] = totals.weekdayMinutes[i] / 60.0f;
+    ImGui::Spacing();
+    ImGui::Text("HOURS BY WEEKDAY (MON-SUN)");
+    ImGui::PlotHistogram("##weekday", weekdayHours, 7, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, 50.0f));
+
+    float hourHours[24];
+    for (int i = 0; i < 24; i++) hourHours[i] = totals.hourMinutes[i] / 60.0f;
+    ImGui::Text("HOURS BY TIME OF DAY (00-23)");
+    ImGui::PlotHistogram("##hour", hourHours, 24, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, 50.0f));
+
+    ImGui::Spacing();
+    UsageIndex::DayValue block = usage.longestFreeBlock(firstDay, lastDay);
+    if (block.dayNumber >= 0 && block.minutes > 0) {
+        char day[16];
+        formatDay(block.dayNumber, day, sizeof(day));
+        formatHours(block.minutes, hours, sizeof(hours));
+        int end = block.startMinute + block.minutes;
+        ImGui::Text("LONGEST FREE BLOCK %s", hours);
+        ImGui::TextDisabled("%s %02d:%02d-%02d:%02d (WITHIN %02d:00-%02d:00)", day, block.startMinute / 60,
+                            block.startMinute % 60, end / 60, end % 60, UsageIndex::kWindowStartMinute / 60,
+                            UsageIndex::kWindowEndMinute / 60);
+    } else {
+        ImGui::Text("NO FREE BLOCK BETWEEN %02d:00 AND %02d:00", UsageIndex::kWindowStartMinute / 60,
+                    UsageIndex::kWindowEndMinute / 60);
+    }
+
+    ImGui::Spacing();
+    UsageIndex::DayValue busiest[kStatsBusiestDays];
+    int count = usage.busiestDays(firstDay, lastDay, busiest, kStatsBusiestDays);
+    ImGui::Text("BUSIEST DAYS");
+    if (count == 0) ImGui::TextDisabled("NOTHING BOOKED");
+    for (int i = 0; i < count; i++) {
+        char day[16];
+        formatDay(busiest[i].dayNumber, day, sizeof(day));
+        formatHours(busiest[i].minutes, hours, sizeof(hours));
+        ImGui::Text("%-8s %s", day, hours);
+    }
+
+    ImGui::End();
+}
+
+} // namespace calendar
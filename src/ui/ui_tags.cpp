@@ -0,0 +1,98 @@
+#include "ui.h"
+#include "imgui.h"
+#include "../core/storage.h"
+
+namespace calendar {
+
+namespace {
+
+const int kPickerColumns = 4;
+
+// Keeps a run of SameLine() items inside the window, starting a new line
+// when the next one of the given width would not fit
+void sameLineOrWrap(float width) {
+    ImGui::SameLine();
+    if (ImGui::GetContentRegionAvail().x < width) ImGui::NewLine();
+}
+
+} // namespace
+
+ImU32 CalendarUI::tagColor(int bit, float alpha) {
+    // Hues a golden-ratio turn apart, so neighbouring tags never look
+    // alike; converted once and recoloured per alpha with a mask
+    static ImU32 palette[TagTable::kMaxTags];
+    static bool ready = false;
+    if (!ready) {
+        for (int i = 0; i < TagTable::kMaxTags; i++) {
+            float hue = i * 0.618034f;
+            hue -= (int)hue;
+            float r, g, b;
+            ImGui::ColorConvertHSVtoRGB(hue, 0.55f, 0.9f, r, g, b);
+            palette[i] = ImGui::ColorConvertFloat4ToU32(ImVec4(r, g, b, 1.0f));
+        }
+        ready = true;
+    }
+    return (palette[bit] & ~IM_COL32_A_MASK) | ((ImU32)(alpha * 255.0f) << IM_COL32_A_SHIFT);
+}
+
+ImU32 CalendarUI::eventColor(const Event& event, float alpha, ImU32 untagged) const {
+    uint64_t filter = eventManager_.getTagFilter();
+    uint64_t shown = filter ? event.tags & filter : event.tags;
+    return shown ? tagColor(firstTag(shown), alpha) : untagged;
+}
+
+void CalendarUI::renderTagFilterBar() {
+    TagTable& tags = eventManager_.getTags();
+    uint64_t filter = eventManager_.getTagFilter();
+    static const ImU32 chipText = ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
+    float padding = ImGui::GetStyle().FramePadding.x * 2.0f;
+
+    // Toggling a chip only swaps the filter mask; the views apply it in
+    // their next queries, and nothing here allocates
+    ImGui::Text("SHOW:");
+    ImGui::SameLine();
+    if (ImGui::SmallButton(filter ? "ALL" : "[ALL]")) eventManager_.setTagFilter(0);
+    for (int bit = 0; bit < TagTable::kMaxTags; bit++) {
+        if (!tags.defined(bit)) continue;
+        const char* name = tags.name(bit).c_str();
+        uint64_t flag = 1ull << bit;
+        bool active = (filter & flag) != 0;
+        sameLineOrWrap(ImGui::CalcTextSize(name).x + padding);
+        ImGui::PushID(bit);
+        ImGui::PushStyleColor(ImGuiCol_Button, tagColor(bit, active ? 1.0f : 0.25f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, tagColor(bit, active ? 0.85f : 0.45f));
+        ImGui::PushStyleColor(ImGuiCol_Text, active ? chipText : tagColor(bit, 1.0f));
+        if (ImGui::SmallButton(name)) eventManager_.setTagFilter(filter ^ flag);
+        ImGui::PopStyleColor(3);
+        ImGui::PopID();
+    }
+
+    if (tags.definedMask() == ~0ull) return;
+    sameLineOrWrap(160.0f);
+    ImGui::SetNextItemWidth(100.0f);
+    ImGui::InputText("##newTag", state_.tagInput, sizeof(state_.tagInput));
+    ImGui::SameLine();
+    if (ImGui::SmallButton("+ TAG") && state_.tagInput[0] != '\0') {
+        if (tags.intern(state_.tagInput) >= 0) StorageManager::saveTags(tags);
+        state_.tagInput[0] = '\0';
+    }
+}
+
+void CalendarUI::renderTagPicker() {
+    const TagTable& tags = eventManager_.getTags();
+    ImGui::Text("TAGS:");
+    int shown = 0;
+    for (int bit = 0; bit < TagTable::kMaxTags; bit++) {
+        if (!tags.defined(bit)) continue;
+        uint64_t flag = 1ull << bit;
+        bool checked = (state_.eventTags & flag) != 0;
+        if (shown++ % kPickerColumns != 0) ImGui::SameLine();
+        ImGui::PushID(bit);
+        ImGui::PushStyleColor(ImGuiCol_CheckMark, tagColor(bit, 1.0f));
+        if (ImGui::Checkbox(tags.name(bit).c_str(), &checked)) state_.eventTags ^= flag;
+        ImGui::PopStyleColor();
+        ImGui::PopID();
+    }
+}
+
+} // namespace calendar
@@ -1,52 +1,74 @@
 #include "ui.h"
+#include "block_renderer.h"
 #include "imgui.h"
+#include "../core/clock.h"
+#include "../core/profiler.h"
 #include "../core/storage.h"
 #include <cstdio>
 #include <vector>
 
 namespace calendar {
 
-void CalendarUI::renderTimeGrid(int startDay, int numDays) {
-    ImGuiStyle& style = ImGui::GetStyle();
+namespace {
+
+const float kMinPixelsPerHour = 20.0f;
+const float kMaxPixelsPerHour = 240.0f;
+const int kWorkdayStartHour = 8;    // scrolled to when today is not shown
+
+// Level of detail is chosen per column from the pixels each event would get
+// in the busiest visible hour. Below these, labels and then individual
+// blocks stop being readable and only cost draw calls.
+const float kLabelMinWidth = 48.0f;
+const float kLabelPixelsPerEvent = 1200.0f;
+const float kTickPixelsPerEvent = 24.0f;
+const size_t kMaxAllDayRows = 3;
+const int kHeatLevels = 8;
+
+} // namespace
+
+void CalendarUI::renderTimeGrid(int firstDayNumber, int numDays) {
+    PROFILE_SCOPE("ui.timeGrid");
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     
+    // Block colours are constant; convert them once rather than per event.
+    // Tagged events take their tag's colour instead (tagColor is a lookup).
+    static const ImU32 blockFill = ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.6f, 0.3f, 0.7f));
+    static const ImU32 blockBorder = ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.95f, 0.5f, 1.0f));
+    static const ImU32 dragFill = ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.6f, 0.3f, 0.5f));
+    static const ImU32 dragBorder = ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.95f, 0.5f, 0.8f));
+    static const ImU32 allDayFill = ImGui::ColorConvertFloat4ToU32(ImVec4(0.3f, 0.7f, 0.4f, 0.6f));
+    static const ImU32 allDayBorder = ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.9f, 0.5f, 0.8f));
+    static const ImU32 blockText = ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
+    
+    static const ImU32 nowLine = ImGui::ColorConvertFloat4ToU32(ImVec4(1.0f, 0.35f, 0.3f, 1.0f));
+    
+    ImGuiIO& io = ImGui::GetIO();
+    
+    // Zoom; Ctrl+wheel over the grid does the same as the slider
+    ImGui::SetNextItemWidth(200.0f);
+    ImGui::SliderFloat("ZOOM", &state_.pixelsPerHour, kMinPixelsPerHour, kMaxPixelsPerHour, "%.0f PX/H");
+    
     ImVec2 canvas_size = ImGui::GetContentRegionAvail();
     
-    const int startHour = 7;   // Start at 7:00 AM
-    const int endHour = 24;    // End at midnight (23:59)
+    const int startHour = 0;
+    const int endHour = 24;
     int totalHours = endHour - startHour;
     
-    // Calculate responsive dimensions based on available space
+    // Calculate responsive dimensions based on available space; the grid
+    // scrolls vertically, so leave room for its scrollbar
     float timeColumnWidth = canvas_size.x * 0.05f;  // 5% for time labels
-    float remainingWidth = canvas_size.x - timeColumnWidth;
+    float remainingWidth = canvas_size.x - timeColumnWidth - ImGui::GetStyle().ScrollbarSize;
     float columnWidth = remainingWidth / numDays;
     float headerHeight = canvas_size.y * 0.04f;     // 4% for header
     
-    // Calculate hourHeight to fill all available space
-    float availableHeight = canvas_size.y - headerHeight - 10.0f; // Small margin
-    float hourHeight = availableHeight / totalHours;
-    
-    // Calculate day info first
-    int dayInfos[7][3]; // [day][month][year]
+    // Resolve the dates of every column once
+    gridDays_.resize(numDays);
     for (int i = 0; i < numDays; i++) {
-        int day = startDay + i;
-        int month = state_.currentMonth;
-        int year = state_.currentYear;
-        
-        int daysInMonth = CalendarLogic::getDaysInMonth(month, year);
-        while (day > daysInMonth) {
-            day -= daysInMonth;
-            month++;
-            if (month > 11) {
-                month = 0;
-                year++;
-            }
-            daysInMonth = CalendarLogic::getDaysInMonth(month, year);
-        }
-        dayInfos[i][0] = day;
-        dayInfos[i][1] = month;
-        dayInfos[i][2] = year;
+        GridDay& column = gridDays_[i];
+        CalendarLogic::fromDayNumber(firstDayNumber + i, column.day, column.month, column.year);
+        column.detail = DETAIL_BLOCKS;
     }
+    bool labelled = columnWidth >= kLabelMinWidth;
     
     // Draw day headers OUTSIDE the scroll area - aligned with grid
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
@@ -56,26 +78,31 @@ void CalendarUI::renderTimeGrid(int startDay, int numDays) {
     ImGui::SameLine();
     
     for (int i = 0; i < numDays; i++) {
-        int day = dayInfos[i][0];
-        int month = dayInfos[i][1];
-        int firstDay = CalendarLogic::getFirstDayOfMonth(month, state_.currentYear);
-        int dayOfWeek = (firstDay + day - 1) % 7;
+        int day = gridDays_[i].day;
+        int month = gridDays_[i].month;
+        int dayOfWeek = CalendarLogic::getDayOfWeek(day, month, gridDays_[i].year);
         
+        // Narrow columns only have room for the date
         char header[32];
-        snprintf(header, sizeof(header), "%s %d", 
-                CalendarLogic::getDayName(dayOfWeek), day);
+        if (labelled) {
+            snprintf(header, sizeof(header), "%s %d", CalendarLogic::getDayName(dayOfWeek), day);
+        } else {
+            snprintf(header, sizeof(header), "%d", day);
+        }
         
         bool isToday = (day == state_.selectedDay && month == state_.currentMonth);
         if (isToday) {
             ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.7f, 0.3f, 1.0f));
         }
         
+        ImGui::PushID(i);
         if (ImGui::Button(header, ImVec2(columnWidth, headerHeight))) {
             state_.selectedDay = day;
             state_.currentMonth = month;
-            state_.currentYear = dayInfos[i][2];
+            state_.currentYear = gridDays_[i].year;
             state_.showAddEvent = false;
         }
+        ImGui::PopID();
         
         if (isToday) {
             ImGui::PopStyleColor();
@@ -87,93 +114,210 @@ void CalendarUI::renderTimeGrid(int startDay, int numDays) {
     
     ImGui::Spacing();
     
-    // Draw the time grid directly (no scrolling)
+    // All-day strip between the headers and the scrolling grid, sized for
+    // the busiest column. These are not draggable, and narrow columns get
+    // thin unlabelled bars.
+    size_t maxAllDay = 0;
+    for (GridDay& column : gridDays_) {
+        column.allDayCount = eventManager_.getAllDayEvents(column.day, column.month, column.year).size();
+        if (column.allDayCount > maxAllDay) maxAllDay = column.allDayCount;
+    }
+    if (maxAllDay > 0) {
+        size_t stripRows = maxAllDay < kMaxAllDayRows ? maxAllDay : kMaxAllDayRows;
+        float rowHeight = labelled ? 25.0f : 8.0f;
+        ImVec2 strip_start = ImGui::GetCursorScreenPos();
+        for (int i = 0; i < numDays; i++) {
+            const GridDay& column = gridDays_[i];
+            size_t count = column.allDayCount;
+            size_t shown = count < stripRows ? count : stripRows;
+            // Keep the last row for the overflow count when labelled
+            if (labelled && count > stripRows) shown--;
+            float eventX = strip_start.x + timeColumnWidth + i * columnWidth;
+            float eventY = strip_start.y;
+            size_t drawn = 0;
+            for (Event* evt : eventManager_.getAllDayEvents(column.day, column.month, column.year)) {
+                if (drawn++ == shown) break;
+                ImVec2 block_min(eventX + 2, eventY);
+                ImVec2 block_max(eventX + columnWidth - 2, eventY + rowHeight - 2);
+                draw_list->AddRectFilled(block_min, block_max, eventColor(*evt, 0.6f, allDayFill));
+                if (labelled) {
+                    draw_list->AddRect(block_min, block_max, eventColor(*evt, 0.8f, allDayBorder));
+                    draw_list->AddText(ImVec2(block_min.x + 4, block_min.y + 4), blockText,
+                                       blockLabels_.get(*evt, columnWidth - 12.0f));
+                }
+                eventY += rowHeight;
+            }
+            if (shown < count && labelled) {
+                char more[24];
+                snprintf(more, sizeof(more), "+%d MORE", (int)(count - shown));
+                draw_list->AddText(ImVec2(eventX + 6, eventY + 4), allDayBorder, more);
+            }
+        }
+        ImGui::Dummy(ImVec2(timeColumnWidth + columnWidth * numDays, stripRows * rowHeight));
+    }
+    
+    // Zoom and scroll are decided before the grid window begins, so the
+    // frame is laid out with the scroll position it is displayed at
+    ImVec2 view_min = ImGui::GetCursorScreenPos();
+    float viewHeight = ImGui::GetContentRegionAvail().y;
+    ImVec2 view_max(view_min.x + canvas_size.x, view_min.y + viewHeight);
+    float zoomAnchorY = viewHeight * 0.5f;
+    if (io.KeyCtrl && io.MouseWheel != 0.0f && ImGui::IsMouseHoveringRect(view_min, view_max)) {
+        float zoomed = state_.pixelsPerHour * (io.MouseWheel > 0.0f ? 1.15f : 1.0f / 1.15f);
+        if (zoomed < kMinPixelsPerHour) zoomed = kMinPixelsPerHour;
+        if (zoomed > kMaxPixelsPerHour) zoomed = kMaxPixelsPerHour;
+        state_.pixelsPerHour = zoomed;
+        zoomAnchorY = ImGui::GetMousePos().y - view_min.y;
+    }
+    float hourHeight = state_.pixelsPerHour;
+    
+    // Today's column, if it is on screen
+    tm nowTm;
+    Clock::localNow(nowTm);
+    int nowMinutes = nowTm.tm_hour * 60 + nowTm.tm_min;
+    int todayColumn = -1;
+    for (int i = 0; i < numDays; i++) {
+        if (gridDays_[i].day == nowTm.tm_mday && gridDays_[i].month == nowTm.tm_mon &&
+            gridDays_[i].year == nowTm.tm_year + 1900) {
+            todayColumn = i;
+        }
+    }
+    
+    int scrollAnchor = firstDayNumber * 128 + numDays;
+    if (scrollAnchor != gridScrollAnchor_) {
+        // New range of days: bring now or the start of the working day into view
+        int focusMinutes = todayColumn >= 0 ? nowMinutes : kWorkdayStartHour * 60;
+        float target = focusMinutes * hourHeight / 60.0f - viewHeight / 3.0f;
+        ImGui::SetNextWindowScroll(ImVec2(-1.0f, target > 0.0f ? target : 0.0f));
+        gridScrollAnchor_ = scrollAnchor;
+    } else if (hourHeight != gridHourHeight_) {
+        // Zoom about the mouse (wheel) or the middle of the view (slider)
+        float minutes = (gridScrollY_ + zoomAnchorY) * 60.0f / gridHourHeight_;
+        float target = minutes * hourHeight / 60.0f - zoomAnchorY;
+        ImGui::SetNextWindowScroll(ImVec2(-1.0f, target > 0.0f ? target : 0.0f));
+    }
+    gridHourHeight_ = hourHeight;
+    
+    ImGui::SetNextWindowContentSize(ImVec2(0.0f, totalHours * hourHeight));
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+    ImGui::BeginChild("time_grid", ImVec2(0, 0), ImGuiChildFlags_None,
+                      io.KeyCtrl ? ImGuiWindowFlags_NoScrollWithMouse : ImGuiWindowFlags_None);
+    ImGui::PopStyleVar();
+    draw_list = ImGui::GetWindowDrawList();
+    gridScrollY_ = ImGui::GetScrollY();
+    
+    // Only the rows inside the scroll window are replayed or laid out
+    float visibleTop = gridScrollY_;
+    float visibleBottom = gridScrollY_ + ImGui::GetWindowHeight();
+    int fromMinute = (int)(visibleTop * 60.0f / hourHeight);
+    int toMinute = (int)(visibleBottom * 60.0f / hourHeight) + 1;
+    int firstHour = fromMinute / 60;
+    int lastHour = (toMinute + 59) / 60;
+    
+    // The static part of the grid is cached geometry, rebuilt only when the
+    // layout changes
     ImVec2 grid_start = ImGui::GetCursorScreenPos();
-    for (int i = 0; i < totalHours; i++) {
-        int hour = startHour + i;
-        ImVec2 time_pos(grid_start.x, grid_start.y + i * hourHeight);
+    GridLayout layout = {timeColumnWidth, columnWidth, hourHeight, numDays, startHour, endHour};
+    gridCache_.update(layout);
+    gridCache_.replay(draw_list, grid_start, firstHour, lastHour);
+    
+    // Lay out every visible block once. The same rectangles are drawn and
+    // hit-tested, so hover, drag-start, drop and right-click all agree on the
+    // geometry. Candidates come from the chronological index, so events
+    // outside the visible minutes are never touched.
+    hitIndex_.reset(ImVec2(grid_start.x + timeColumnWidth, grid_start.y), columnWidth, numDays,
+                    hourHeight, startHour, endHour);
+    // Detail and density follow the tag filter like the blocks themselves
+    const DayIndex& dayIndex = eventManager_.getShownDayIndex();
+    for (int dayOffset = 0; dayOffset < numDays; dayOffset++) {
+        GridDay& column = gridDays_[dayOffset];
         
-        // Time label
-        char timeLabel[8];
-        snprintf(timeLabel, sizeof(timeLabel), "%02d:00", hour);
-        draw_list->AddText(time_pos, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_Text]), timeLabel);
+        // Pixels per event in the busiest visible hour, from the day summary
+        const int* hours = dayIndex.hourCounts(column.day, column.month, column.year);
+        if (!hours) continue;
+        int peak = 0;
+        for (int hour = firstHour; hour < lastHour && hour < 24; hour++) {
+            if (hours[hour] > peak) peak = hours[hour];
+        }
+        if (peak == 0) continue;
+        float pixelsPerEvent = columnWidth * hourHeight / peak;
+        if (labelled && pixelsPerEvent >= kLabelPixelsPerEvent) column.detail = DETAIL_BLOCKS;
+        else if (pixelsPerEvent >= kTickPixelsPerEvent) column.detail = DETAIL_TICKS;
+        else column.detail = DETAIL_DENSITY;
+        // Density columns are drawn from the summary alone
+        if (column.detail == DETAIL_DENSITY) continue;
         
-        // Horizontal line
-        ImVec2 line_start(grid_start.x + timeColumnWidth, time_pos.y);
-        ImVec2 line_end(grid_start.x + timeColumnWidth + (columnWidth * numDays), time_pos.y);
-        draw_list->AddLine(line_start, line_end, 
-                          ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.5f, 0.3f, 0.5f)));
-    }
-    
-    // Draw vertical column separators
-    for (int i = 0; i <= numDays; i++) {
-        float x = grid_start.x + timeColumnWidth + (i * columnWidth);
-        draw_list->AddLine(
-            ImVec2(x, grid_start.y),
-            ImVec2(x, grid_start.y + totalHours * hourHeight),
-            ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.5f, 0.3f, 0.5f))
-        );
+        for (Event* evt : eventManager_.getTimedEvents(column.day, column.month, column.year, fromMinute, toMinute)) {
+            int startMinutes = evt->hourStart * 60 + evt->minuteStart;
+            int endMinutes = evt->hourEnd != -1 ? evt->hourEnd * 60 + evt->minuteEnd
+                                                : startMinutes + 60; // Default 1 hour
+            if (endMinutes <= fromMinute) continue;
+            hitIndex_.add(dayOffset, hitIndex_.yForMinutes(startMinutes),
+                          hitIndex_.yForMinutes(endMinutes) - 2, evt);
+            PROFILE_COUNT("grid.blocks", 1);
+        }
     }
+    hitIndex_.finalize();
     
-    // Handle drag and drop
     ImVec2 mouse_pos = ImGui::GetMousePos();
+    bool gridHovered = ImGui::IsWindowHovered() && hitIndex_.containsPoint(mouse_pos);
+    bool openAddEvent = false;
+    const float resizeHandle = 5.0f;
     
-    // If we're currently dragging
-    if (state_.isDragging && state_.draggedEvent) {
+    // Found again by uid every frame: a sync, another tab or an import may
+    // have moved the event since the drag started, or removed it
+    Event* draggedEvent = state_.isDragging ? eventManager_.findByUid(state_.draggedUid) : nullptr;
+    if (state_.isDragging && !draggedEvent) {
+        state_.isDragging = false;
+        state_.draggedUid = 0;
+    }
+    
+    if (draggedEvent) {
         // Show dragging visual feedback
-        ImGui::SetMouseCursor(ImGuiMouseCursor_Hand);
+        ImGui::SetMouseCursor(state_.dragMode == DRAG_MOVE ? ImGuiMouseCursor_Hand : ImGuiMouseCursor_ResizeNS);
         
         // If mouse released, drop the event
         if (!ImGui::IsMouseDown(0)) {
-            // Calculate drop position
-            float gridLeft = grid_start.x + timeColumnWidth;
-            float gridRight = grid_start.x + timeColumnWidth + (columnWidth * numDays);
-            float gridTop = grid_start.y;
-            float gridBottom = grid_start.y + (totalHours * hourHeight);
+            int dropColumn = hitIndex_.columnAt(mouse_pos.x);
+            Event* evt = draggedEvent;
+            int startMinutes = evt->hourStart * 60 + evt->minuteStart;
+            int endMinutes = evt->hourEnd != -1 ? evt->hourEnd * 60 + evt->minuteEnd : startMinutes + 60;
             
-            if (mouse_pos.x >= gridLeft && mouse_pos.x < gridRight &&
-                mouse_pos.y >= gridTop && mouse_pos.y < gridBottom) {
-                
-                // Calculate new time and day
-                int dropDayOffset = (int)((mouse_pos.x - gridLeft) / columnWidth);
-                int dropMinutesFromTop = (int)(((mouse_pos.y - gridTop) / hourHeight) * 60.0f);
+            if (gridHovered && dropColumn >= 0) {
+                int mouseMinutes = hitIndex_.minutesAt(mouse_pos.y);
                 
-                // Adjust for drag offset
-                dropMinutesFromTop -= state_.dragOffsetMinutes;
-                if (dropMinutesFromTop < 0) dropMinutesFromTop = 0;
-                
-                int dropHour = startHour + (dropMinutesFromTop / 60);
-                int dropMinute = dropMinutesFromTop % 60;
+                if (state_.dragMode == DRAG_MOVE) {
+                    int duration = endMinutes - startMinutes;
+                    startMinutes = mouseMinutes - state_.dragOffsetMinutes;
+                    if (startMinutes < startHour * 60) startMinutes = startHour * 60;
+                    endMinutes = startMinutes + duration;
+                } else {
+                    // Resizing snaps to 5 minutes and keeps at least 5 minutes of event
+                    int snapped = (mouseMinutes + 2) / 5 * 5;
+                    if (state_.dragMode == DRAG_RESIZE_TOP) {
+                        startMinutes = snapped < endMinutes - 5 ? snapped : endMinutes - 5;
+                    } else {
+                        endMinutes = snapped > startMinutes + 5 ? snapped : startMinutes + 5;
+                    }
+                }
                 
-                if (dropDayOffset >= 0 && dropDayOffset < numDays &&
-                    dropHour >= startHour && dropHour < endHour) {
-                    
-                    // Calculate duration
-                    int durationMinutes = 60; // Default 1 hour
-                    if (state_.draggedEvent->hourEnd != -1) {
-                        int startMinutes = state_.draggedEvent->hourStart * 60 + state_.draggedEvent->minuteStart;
-                        int endMinutes = state_.draggedEvent->hourEnd * 60 + state_.draggedEvent->minuteEnd;
-                        durationMinutes = endMinutes - startMinutes;
+                if (startMinutes < endHour * 60) {
+                    if (endMinutes >= 24 * 60) {
+                        endMinutes = 23 * 60 + 59;
                     }
                     
-                    // Update event
-                    state_.draggedEvent->day = dayInfos[dropDayOffset][0];
-                    state_.draggedEvent->month = dayInfos[dropDayOffset][1];
-                    state_.draggedEvent->year = dayInfos[dropDayOffset][2];
-                    state_.draggedEvent->hourStart = dropHour;
-                    state_.draggedEvent->minuteStart = dropMinute;
-                    state_.draggedEvent->hourEnd = dropHour + (durationMinutes / 60);
-                    state_.draggedEvent->minuteEnd = (dropMinute + durationMinutes) % 60;
-                    
-                    // Handle hour overflow
-                    if (state_.draggedEvent->minuteEnd >= 60) {
-                        state_.draggedEvent->hourEnd++;
-                        state_.draggedEvent->minuteEnd -= 60;
-                    }
-                    if (state_.draggedEvent->hourEnd >= 24) {
-                        state_.draggedEvent->hourEnd = 23;
-                        state_.draggedEvent->minuteEnd = 59;
+                    // Update event; resizing keeps the day, moving takes the drop column
+                    Event moved = *evt;
+                    if (state_.dragMode == DRAG_MOVE) {
+                        moved.day = gridDays_[dropColumn].day;
+                        moved.month = gridDays_[dropColumn].month;
+                        moved.year = gridDays_[dropColumn].year;
                     }
+                    moved.hourStart = startMinutes / 60;
+                    moved.minuteStart = startMinutes % 60;
+                    moved.hourEnd = endMinutes / 60;
+                    moved.minuteEnd = endMinutes % 60;
+                    eventManager_.updateEvent(evt, moved);
                     
                     // Save to storage
                     StorageManager::saveEventsToStorage(eventManager_.getAllEvents());
@@ -182,159 +326,188 @@ void CalendarUI::renderTimeGrid(int startDay, int numDays) {
             
             // End dragging
             state_.isDragging = false;
-            state_.draggedEvent = nullptr;
+            state_.draggedUid = 0;
+            draggedEvent = nullptr;
+        }
+    } else if (gridHovered) {
+        HitIndex::Hit hit;
+        if (hitIndex_.query(mouse_pos, hit)) {
+            DragMode mode = DRAG_MOVE;
+            if (mouse_pos.y - hit.top < resizeHandle) mode = DRAG_RESIZE_TOP;
+            else if (hit.bottom - mouse_pos.y < resizeHandle) mode = DRAG_RESIZE_BOTTOM;
+            ImGui::SetMouseCursor(mode == DRAG_MOVE ? ImGuiMouseCursor_Hand : ImGuiMouseCursor_ResizeNS);
+            
+            if (ImGui::IsMouseClicked(0)) { // Left click
+                state_.isDragging = true;
+                state_.draggedUid = hit.event->uid;
+                draggedEvent = hit.event;
+                state_.dragMode = mode;
+                // Offset from event start to where user clicked
+                int eventStartMinutes = hit.event->hourStart * 60 + hit.event->minuteStart;
+                state_.dragOffsetMinutes = hitIndex_.minutesAt(mouse_pos.y) - eventStartMinutes;
+            } else {
+                ImGui::SetTooltip("%s", listLabels_.get(*hit.event, 0.0f));
+            }
+        } else {
+            int column = hitIndex_.columnAt(mouse_pos.x);
+            int hour = hitIndex_.minutesAt(mouse_pos.y) / 60;
+            if (column >= 0 && gridDays_[column].detail == DETAIL_DENSITY && hour >= 0 && hour < 24) {
+                const GridDay& day = gridDays_[column];
+                const int* hours = dayIndex.hourCounts(day.day, day.month, day.year);
+                ImGui::SetTooltip("%02d:00  %d EVENTS", hour, hours ? hours[hour] : 0);
+            }
         }
     }
     
     // Check for RIGHT-CLICKS on the time grid to create events
-    bool rightClicked = ImGui::IsMouseClicked(1); // Right mouse button
-    
-    if (rightClicked && !state_.isDragging) {
-        // Check if click is within grid bounds
-        float gridLeft = grid_start.x + timeColumnWidth;
-        float gridRight = grid_start.x + timeColumnWidth + (columnWidth * numDays);
-        float gridTop = grid_start.y;
-        float gridBottom = grid_start.y + (totalHours * hourHeight);
+    if (ImGui::IsMouseClicked(1) && !state_.isDragging && gridHovered) {
+        int clickedDayOffset = hitIndex_.columnAt(mouse_pos.x);
+        int clickedHour = hitIndex_.minutesAt(mouse_pos.y) / 60;
         
-        if (mouse_pos.x >= gridLeft && mouse_pos.x < gridRight &&
-            mouse_pos.y >= gridTop && mouse_pos.y < gridBottom) {
-            
-            // Calculate which day and hour was clicked
-            int clickedDayOffset = (int)((mouse_pos.x - gridLeft) / columnWidth);
-            int clickedHourIndex = (int)((mouse_pos.y - gridTop) / hourHeight);
-            int clickedHour = startHour + clickedHourIndex;
-            
-            if (clickedDayOffset >= 0 && clickedDayOffset < numDays &&
-                clickedHour >= startHour && clickedHour < endHour) {
-                
-                // Set the clicked day and time
-                state_.selectedDay = dayInfos[clickedDayOffset][0];
-                state_.currentMonth = dayInfos[clickedDayOffset][1];
-                state_.currentYear = dayInfos[clickedDayOffset][2];
-                state_.eventHourStart = clickedHour;
-                state_.eventMinuteStart = 0;
-                state_.eventHourEnd = (clickedHour + 1) % 24;
-                state_.eventMinuteEnd = 0;
-                state_.eventIsAllDay = false;
-                state_.showAddEvent = true;
-                
-                // Open popup at mouse position
-                ImGui::OpenPopup("AddEventPopup");
-            }
+        if (clickedDayOffset >= 0 && clickedHour >= startHour && clickedHour < endHour) {
+            // Set the clicked day and time
+            state_.selectedDay = gridDays_[clickedDayOffset].day;
+            state_.currentMonth = gridDays_[clickedDayOffset].month;
+            state_.currentYear = gridDays_[clickedDayOffset].year;
+            state_.eventHourStart = clickedHour;
+            state_.eventMinuteStart = 0;
+            state_.eventHourEnd = (clickedHour + 1) % 24;
+            state_.eventMinuteEnd = 0;
+            state_.eventIsAllDay = false;
+            state_.showAddEvent = true;
+            openAddEvent = true;
         }
     }
     
-    // Render events and collect data
-    for (int dayOffset = 0; dayOffset < numDays; dayOffset++) {
-        // Use pre-calculated day info
-        int day = dayInfos[dayOffset][0];
-        int month = dayInfos[dayOffset][1];
-        int year = dayInfos[dayOffset][2];
-        
-        // Get events for this day
-        auto dayEvents = eventManager_.getEventsForDate(day, month, year);
-        
-        // Render all-day events at the top
-        std::vector<Event*> allDayEvents;
-        std::vector<Event*> timedEvents;
-        for (auto evt : dayEvents) {
-            if (evt->isAllDay) {
-                allDayEvents.push_back(evt);
-            } else {
-                timedEvents.push_back(evt);
-            }
+    // Density columns: one shaded bar per visible hour, from the day summary
+    ImU32 heatColors[kHeatLevels];
+    for (int i = 0; i < kHeatLevels; i++) {
+        float t = (float)(i + 1) / kHeatLevels;
+        heatColors[i] = ImGui::ColorConvertFloat4ToU32(ImVec4(0.1f + 0.3f * t, 0.3f + 0.65f * t, 0.15f + 0.35f * t, 0.35f + 0.65f * t));
+    }
+    for (int column = 0; column < numDays; column++) {
+        const GridDay& day = gridDays_[column];
+        if (day.detail != DETAIL_DENSITY) continue;
+        const int* hours = dayIndex.hourCounts(day.day, day.month, day.year);
+        float eventX = hitIndex_.columnLeft(column);
+        for (int hour = firstHour; hour < lastHour && hour < 24; hour++) {
+            if (hours[hour] == 0) continue;
+            int level = (hours[hour] < kHeatLevels ? hours[hour] : kHeatLevels) - 1;
+            draw_list->AddRectFilled(ImVec2(eventX + 1, hitIndex_.yForMinutes(hour * 60) + 1),
+                                     ImVec2(eventX + columnWidth - 1, hitIndex_.yForMinutes(hour * 60 + 60) - 1),
+                                     heatColors[level]);
         }
-        
-        // Render timed events in the grid (only if within visible hours)
-        for (auto evt : timedEvents) {
-            if (evt->hourStart >= startHour && evt->hourStart < endHour) {
-                // Skip rendering if this is the event being dragged (we'll draw it separately)
-                bool isBeingDragged = (state_.isDragging && state_.draggedEvent == evt);
-                
-                // Calculate Y position relative to start hour
-                float eventY = ((evt->hourStart - startHour) * hourHeight) + (evt->minuteStart * hourHeight / 60.0f);
-                float eventHeight;
-                if (evt->hourEnd != -1) {
-                    float endY = ((evt->hourEnd - startHour) * hourHeight) + (evt->minuteEnd * hourHeight / 60.0f);
-                    eventHeight = endY - eventY;
-                } else {
-                    eventHeight = hourHeight; // Default 1 hour
-                }
-                float eventX = grid_start.x + timeColumnWidth + (dayOffset * columnWidth);
-                
-                // Draw event block
-                ImVec2 block_min(eventX + 2, grid_start.y + eventY);
-                ImVec2 block_max(eventX + columnWidth - 2, grid_start.y + eventY + eventHeight - 2);
-                
-                // If being dragged, draw at mouse position with transparency
-                if (isBeingDragged) {
-                    float dragY = mouse_pos.y - (state_.dragOffsetMinutes * hourHeight / 60.0f);
-                    block_min.y = dragY;
-                    block_max.y = dragY + eventHeight - 2;
-                    
-                    // Semi-transparent while dragging
-                    draw_list->AddRectFilled(block_min, block_max,
-                        ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.6f, 0.3f, 0.5f)));
-                    draw_list->AddRect(block_min, block_max,
-                        ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.95f, 0.5f, 0.8f)), 0.0f, 0, 2.0f);
-                } else {
-                    // Normal rendering
-                    draw_list->AddRectFilled(block_min, block_max,
-                        ImGui::ColorConvertFloat4ToU32(ImVec4(0.2f, 0.6f, 0.3f, 0.7f)));
-                    draw_list->AddRect(block_min, block_max,
-                        ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.95f, 0.5f, 1.0f)));
-                }
-                
-                // Event text
-                std::string timeStr = eventManager_.formatEventTime(evt);
-                char eventLabel[256];
-                snprintf(eventLabel, sizeof(eventLabel), "%s\n%s", 
-                        timeStr.c_str(), evt->text.c_str());
-                
-                ImVec2 text_pos(block_min.x + 4, block_min.y + 2);
-                draw_list->AddText(text_pos, 
-                    ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.0f, 0.0f, 1.0f)), 
-                    eventLabel);
-                
-                // Detect mouse down on event to start dragging
-                if (!state_.isDragging && !isBeingDragged) {
-                    if (mouse_pos.x >= block_min.x && mouse_pos.x <= block_max.x &&
-                        mouse_pos.y >= block_min.y && mouse_pos.y <= block_max.y) {
-                        
-                        if (ImGui::IsMouseClicked(0)) { // Left click
-                            state_.isDragging = true;
-                            state_.draggedEvent = evt;
-                            // Calculate offset from event start to where user clicked
-                            int eventStartMinutes = (evt->hourStart - startHour) * 60 + evt->minuteStart;
-                            int clickMinutes = (int)(((mouse_pos.y - grid_start.y) / hourHeight) * 60.0f);
-                            state_.dragOffsetMinutes = clickMinutes - eventStartMinutes;
-                        }
+    }
+    
+    // With the GPU pass on, block rectangles go to the block renderer's
+    // buffer, laid out again only when what is shown changes; this frame
+    // only queues its draw, and ImGui adds the labels on top
+    bool gpuBlocks = blockRenderer_ && blockRenderer_->enabled();
+    const Event* dragged = draggedEvent;
+    if (gpuBlocks) {
+        BlockLayout blockLayout = {layout, firstDayNumber, fromMinute, toMinute, eventManager_.getRevision(),
+                                   eventManager_.getTagFilter(), dragged};
+        if (blockRenderer_->update(blockLayout)) {
+            blockRenderer_->clear();
+            for (int column = 0; column < hitIndex_.columnCount(); column++) {
+                bool ticks = gridDays_[column].detail == DETAIL_TICKS;
+                float left = hitIndex_.columnLeft(column) - grid_start.x;
+                for (const HitIndex::Hit& hit : hitIndex_.blocks(column)) {
+                    if (hit.event == dragged) continue;
+                    float top = hit.top - grid_start.y;
+                    float bottom = hit.bottom - grid_start.y;
+                    if (ticks) {
+                        ImU32 color = eventColor(*hit.event, 1.0f, blockBorder);
+                        blockRenderer_->add({left + 1, top, left + columnWidth - 1,
+                                             bottom > top + 2.0f ? bottom : top + 2.0f, color, color});
+                    } else {
+                        blockRenderer_->add({left + 2, top, left + columnWidth - 2, bottom,
+                                             eventColor(*hit.event, 0.7f, blockFill),
+                                             eventColor(*hit.event, 1.0f, blockBorder)});
                     }
                 }
             }
         }
-        
-        // Draw all-day events banner at the top if any
-        if (!allDayEvents.empty()) {
-            for (size_t i = 0; i < allDayEvents.size(); i++) {
-                float eventX = grid_start.x + timeColumnWidth + (dayOffset * columnWidth);
-                ImVec2 block_min(eventX + 2, grid_start.y - 30 + (i * 25));
-                ImVec2 block_max(eventX + columnWidth - 2, grid_start.y - 30 + (i * 25) + 23);
-                
-                draw_list->AddRectFilled(block_min, block_max,
-                    ImGui::ColorConvertFloat4ToU32(ImVec4(0.3f, 0.7f, 0.4f, 0.6f)));
-                draw_list->AddRect(block_min, block_max,
-                    ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.9f, 0.5f, 0.8f)));
-                
-                draw_list->AddText(ImVec2(block_min.x + 4, block_min.y + 4),
-                    ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.0f, 0.0f, 1.0f)),
-                    allDayEvents[i]->text.c_str());
+        blockRenderer_->draw(draw_list, grid_start);
+    }
+    
+    // Draw timed events from the index
+    const HitIndex::Hit* draggedHit = nullptr;
+    for (int column = 0; column < hitIndex_.columnCount(); column++) {
+        bool ticks = gridDays_[column].detail == DETAIL_TICKS;
+        // Ticks have no labels, so the GPU pass leaves nothing to do here
+        // unless one of them is being dragged
+        if (gpuBlocks && ticks && !dragged) continue;
+        for (const HitIndex::Hit& hit : hitIndex_.blocks(column)) {
+            // The block being dragged is drawn separately as a preview
+            if (hit.event == dragged) {
+                draggedHit = &hit;
+                continue;
             }
+            if (gpuBlocks) {
+                if (!ticks) {
+                    draw_list->AddText(ImVec2(hitIndex_.columnLeft(column) + 6, hit.top + 2), blockText,
+                                       blockLabels_.get(*hit.event, columnWidth - 12.0f));
+                }
+                continue;
+            }
+            float eventX = hitIndex_.columnLeft(column);
+            if (ticks) {
+                // Unlabelled mark, at least a line tall
+                float bottom = hit.bottom > hit.top + 2.0f ? hit.bottom : hit.top + 2.0f;
+                draw_list->AddRectFilled(ImVec2(eventX + 1, hit.top), ImVec2(eventX + columnWidth - 1, bottom),
+                                         eventColor(*hit.event, 1.0f, blockBorder));
+                continue;
+            }
+            ImVec2 block_min(eventX + 2, hit.top);
+            ImVec2 block_max(eventX + columnWidth - 2, hit.bottom);
+            draw_list->AddRectFilled(block_min, block_max, eventColor(*hit.event, 0.7f, blockFill));
+            draw_list->AddRect(block_min, block_max, eventColor(*hit.event, 1.0f, blockBorder));
+            
+            // Event text, formatted and fitted once per event version and width
+            draw_list->AddText(ImVec2(block_min.x + 4, block_min.y + 2), blockText,
+                               blockLabels_.get(*hit.event, columnWidth - 12.0f));
         }
     }
     
+    if (draggedHit) {
+        // Semi-transparent preview that follows the mouse
+        float top = draggedHit->top;
+        float bottom = draggedHit->bottom;
+        int column = draggedHit->column;
+        if (state_.dragMode == DRAG_MOVE) {
+            top = mouse_pos.y - (state_.dragOffsetMinutes * hourHeight / 60.0f);
+            bottom = top + (draggedHit->bottom - draggedHit->top);
+            int hoverColumn = hitIndex_.columnAt(mouse_pos.x);
+            if (hoverColumn >= 0) column = hoverColumn;
+        } else if (state_.dragMode == DRAG_RESIZE_TOP) {
+            top = mouse_pos.y < bottom - 4 ? mouse_pos.y : bottom - 4;
+        } else {
+            bottom = mouse_pos.y > top + 4 ? mouse_pos.y : top + 4;
+        }
+        float eventX = hitIndex_.columnLeft(column);
+        ImVec2 block_min(eventX + 2, top);
+        ImVec2 block_max(eventX + columnWidth - 2, bottom);
+        draw_list->AddRectFilled(block_min, block_max, dragFill);
+        draw_list->AddRect(block_min, block_max, dragBorder, 0.0f, 0, 2.0f);
+        if (labelled) draw_list->AddText(ImVec2(block_min.x + 4, block_min.y + 2), blockText,
+                           blockLabels_.get(*draggedHit->event, columnWidth - 12.0f));
+    }
+    
+    if (todayColumn >= 0 && nowMinutes >= fromMinute && nowMinutes < toMinute) {
+        float y = hitIndex_.yForMinutes(nowMinutes);
+        float x = hitIndex_.columnLeft(todayColumn);
+        draw_list->AddLine(ImVec2(x, y), ImVec2(x + columnWidth, y), nowLine, 2.0f);
+    }
+    
     // Reserve space for the full grid
     ImGui::Dummy(ImVec2(timeColumnWidth + (columnWidth * numDays), totalHours * hourHeight));
+    ImGui::EndChild();
+    
+    // Opened from the parent window so the ID matches renderAddEventDialog
+    if (openAddEvent) {
+        ImGui::OpenPopup("AddEventPopup");
+    }
 }
 
 } // namespace calendar
@@ -0,0 +1,244 @@
+#include "ui.h"
+#include "imgui.h"
+#include "../core/file_io.h"
+#include "../core/ical.h"
+#include "../core/memory_tracker.h"
+#include "../core/profiler.h"
+#include "../core/storage.h"
+#include <cstdio>
+#include <memory>
+
+namespace calendar {
+
+namespace {
+
+// Slices end on the scheduler's deadline rather than after a fixed amount of
+// input, so a 50k-event file never pushes a frame past 16 ms, whatever the
+// machine.
+const size_t kImportChunkSize = 16 * 1024;
+const size_t kExportEventsPerCheck = 256;
+const size_t kSaveEventsPerCheck = 256;
+
+// The fields an .ics round trip carries
+bool sameContent(const Event& a, const Event& b) {
+    return a.text == b.text && a.day == b.day && a.month == b.month && a.year == b.year &&
+           a.hourStart == b.hourStart && a.minuteStart == b.minuteStart && a.hourEnd == b.hourEnd &&
+           a.minuteEnd == b.minuteEnd && a.isAllDay == b.isAllDay && a.recurrence == b.recurrence &&
+           a.reminderMinutes == b.reminderMinutes && a.tags == b.tags;
+}
+
+// Saves the calendar the way StorageManager::saveEventsToStorage does, but
+// serialised a slice at a time so a 50k-event import does not end in one
+// long frame. An edit between slices starts it over, so what is written is
+// always one consistent calendar.
+class SaveTask : public Task {
+public:
+    explicit SaveTask(const EventManager& eventManager)
+        : eventManager_(eventManager), written_(0), revision_(eventManager.getRevision()) {
+        MEMORY_SCOPE(MEM_STORAGE);
+        StorageManager::beginJSON(json_);
+    }
+
+    TaskStatus step(double deadlineMs) override {
+        MEMORY_SCOPE(MEM_STORAGE);
+        PROFILE_SCOPE("storage.save");
+        if (eventManager_.getRevision() != revision_) {
+            revision_ = eventManager_.getRevision();
+            written_ = 0;
+            json_.clear();
+            StorageManager::beginJSON(json_);
+        }
+        const auto& events = eventManager_.getAllEvents();
+        while (Profiler::nowMs() < deadlineMs) {
+            size_t end = written_ + kSaveEventsPerCheck;
+            if (end > events.size()) end = events.size();
+            for (; written_ < end; written_++) {
+                StorageManager::appendEventJSON(events[written_], json_);
+            }
+            if (written_ >= events.size()) {
+                StorageManager::endJSON(json_);
+                StorageManager::saveSerialized(json_);
+                return TASK_DONE;
+            }
+        }
+        return TASK_YIELD;
+    }
+
+    float progress() const override {
+        size_t total = eventManager_.getEventCount();
+        return total > 0 ? (float)written_ / (float)total : 1.0f;
+    }
+
+    void describe(char* buffer, size_t size) const override {
+        snprintf(buffer, size, "SAVING: %zu / %zu EVENTS", written_, eventManager_.getEventCount());
+    }
+
+private:
+    const EventManager& eventManager_;
+    std::string json_;
+    size_t written_;
+    uint64_t revision_;     // calendar the payload so far was taken from
+};
+
+class ImportTask : public Task {
+public:
+    explicit ImportTask(EventManager& eventManager)
+        : eventManager_(eventManager), reader_(&eventManager.getTags()), chunk_(kImportChunkSize),
+          opened_(false), offset_(0), total_(0) {}
+
+    TaskStatus step(double deadlineMs) override {
+        MEMORY_SCOPE(MEM_STORAGE);
+        if (!opened_) {
+            if (!FileIO::isFileReady()) {
+                // Closing the picker without a file ends the import
+                return FileIO::isPickDismissed() ? TASK_DONE : TASK_WAITING;
+            }
+            total_ = FileIO::fileSize();
+            opened_ = true;
+        }
+        while (Profiler::nowMs() < deadlineMs) {
+            size_t read = FileIO::readChunk(offset_, chunk_.data(), chunk_.size());
+            if (read == 0) {
+                reader_.finish(batch_);
+                addBatch();
+                FileIO::releaseFile();
+                save();
+                return TASK_DONE;
+            }
+            offset_ += read;
+            reader_.feed(chunk_.data(), read, batch_);
+            addBatch();
+        }
+        return TASK_YIELD;
+    }
+
+    // Events already read stay in the calendar and are saved
+    void cancelled() override {
+        FileIO::releaseFile();
+        if (offset_ > 0) save();
+    }
+
+    bool ready() const override {
+        return FileIO::isFileReady() || FileIO::isPickDismissed();
+    }
+
+    float progress() const override {
+        if (!opened_) return -1.0f;
+        return total_ > 0 ? (float)offset_ / (float)total_ : 0.0f;
+    }
+
+    void describe(char* buffer, size_t size) const override {
+        if (!opened_) snprintf(buffer, size, "WAITING FOR FILE...");
+        else snprintf(buffer, size, "IMPORTING: %zu EVENTS", reader_.eventsRead());
+    }
+
+private:
+    // The calendar is saved by a task of its own, in slices like the import
+    void save() {
+        TaskScheduler::instance().submit(std::unique_ptr<Task>(new SaveTask(eventManager_)));
+        // CATEGORIES may have named new tags
+        StorageManager::saveTags(eventManager_.getTags());
+    }
+
+    // Events from one of our own exports carry their uid; one still in the
+    // calendar is updated in place (if it changed) rather than added again
+    void addBatch() {
+        size_t kept = 0;
+        for (size_t i = 0; i < batch_.size(); i++) {
+            Event& evt = batch_[i];
+            Event* existing = evt.uid != 0 ? eventManager_.findByUid(evt.uid) : nullptr;
+            if (existing) {
+                if (!sameContent(*existing, evt)) eventManager_.updateEvent(existing, evt);
+                continue;
+            }
+            if (kept != i) batch_[kept] = std::move(evt);
+            kept++;
+        }
+        batch_.resize(kept);
+        eventManager_.addEvents(batch_);
+    }
+
+    EventManager& eventManager_;
+    ICalReader reader_;
+    std::vector<Event> batch_;
+    std::vector<char> chunk_;
+    bool opened_;
+    size_t offset_;     // bytes read
+    size_t total_;
+};
+
+class ExportTask : public Task {
+public:
+    explicit ExportTask(const EventManager& eventManager)
+        : eventManager_(eventManager), writer_(&eventManager.getTags()), written_(0),
+          total_(eventManager.getEventCount()) {
+        MEMORY_SCOPE(MEM_STORAGE);
+        writer_.writeHeader(buffer_);
+    }
+
+    TaskStatus step(double deadlineMs) override {
+        MEMORY_SCOPE(MEM_STORAGE);
+        // Imports and edits can land between slices; export what exists now
+        const auto& events = eventManager_.getAllEvents();
+        while (Profiler::nowMs() < deadlineMs) {
+            size_t end = written_ + kExportEventsPerCheck;
+            if (end > events.size()) end = events.size();
+            for (; written_ < end; written_++) {
+                writer_.writeEvent(events[written_], buffer_);
+            }
+            if (written_ >= events.size()) {
+                writer_.writeFooter(buffer_);
+                FileIO::downloadFile("calendar.ics", "text/calendar", buffer_);
+                return TASK_DONE;
+            }
+        }
+        return TASK_YIELD;
+    }
+
+    float progress() const override {
+        return total_ > 0 ? (float)written_ / (float)total_ : 1.0f;
+    }
+
+    void describe(char* buffer, size_t size) const override {
+        snprintf(buffer, size, "EXPORTING: %zu / %zu EVENTS", written_, total_);
+    }
+
+private:
+    const EventManager& eventManager_;
+    ICalWriter writer_;
+    std::string buffer_;
+    size_t written_;
+    size_t total_;
+};
+
+} // namespace
+
+bool CalendarUI::transferActive() const {
+    return TaskScheduler::instance().find(transferTask_) != nullptr;
+}
+
+void CalendarUI::startImport() {
+    FileIO::requestFile(".ics,text/calendar");
+    transferTask_ = TaskScheduler::instance().submit(
+        std::unique_ptr<Task>(new ImportTask(eventManager_)));
+}
+
+void CalendarUI::startExport() {
+    transferTask_ = TaskScheduler::instance().submit(std::unique_ptr<Task>(new ExportTask(eventManager_)));
+}
+
+void CalendarUI::renderTransferProgress() {
+    const Task* task = TaskScheduler::instance().find(transferTask_);
+    if (!task) return;
+
+    char overlay[64];
+    task->describe(overlay, sizeof(overlay));
+    float fraction = task->progress();
+    ImGui::ProgressBar(fraction < 0.0f ? 0.0f : fraction, ImVec2(-90.0f, 0.0f), overlay);
+    ImGui::SameLine();
+    if (ImGui::Button("CANCEL")) {
+        TaskScheduler::instance().cancel(transferTask_);
+    }
+}
+
+} // namespace calendar
@@ -1,12 +1,14 @@
 #include "ui.h"
 #include "imgui.h"
+#include "../core/profiler.h"
 #include "../core/storage.h"
 #include <cstdio>
 
 namespace calendar {
 
 void CalendarUI::renderDayView() {
-    renderTimeGrid(state_.selectedDay, 1);
+    PROFILE_SCOPE("ui.dayView");
+    renderTimeGrid(CalendarLogic::toDayNumber(state_.selectedDay, state_.currentMonth, state_.currentYear), 1);
     
     if (state_.showAddEvent && state_.selectedDay > 0) {
         renderAddEventDialog();
@@ -14,6 +16,7 @@ void CalendarUI::renderDayView() {
 }
 
 void CalendarUI::renderWeekView() {
+    PROFILE_SCOPE("ui.weekView");
     // Ensure we start on Monday
     int mondayDay, mondayMonth, mondayYear;
     CalendarLogic::getMondayOfWeek(state_.weekStartDay, state_.currentMonth, state_.currentYear,
@@ -24,7 +27,26 @@ void CalendarUI::renderWeekView() {
     state_.currentMonth = mondayMonth;
     state_.currentYear = mondayYear;
     
-    renderTimeGrid(mondayDay, 7);
+    renderTimeGrid(CalendarLogic::toDayNumber(mondayDay, mondayMonth, mondayYear), 7);
+    
+    if (state_.showAddEvent && state_.selectedDay > 0) {
+        renderAddEventDialog();
+    }
+}
+
+void CalendarUI::renderTimelineView() {
+    PROFILE_SCOPE("ui.timelineView");
+    static const int spans[] = {14, 30, 90};
+    for (int span : spans) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d DAYS", span);
+        if (ImGui::RadioButton(label, state_.timelineDays == span)) {
+            state_.timelineDays = span;
+        }
+        ImGui::SameLine();
+    }
+    
+    renderTimeGrid(state_.timelineStart, state_.timelineDays);
     
     if (state_.showAddEvent && state_.selectedDay > 0) {
         renderAddEventDialog();
@@ -32,6 +54,7 @@ void CalendarUI::renderWeekView() {
 }
 
 void CalendarUI::renderMonthView() {
+    PROFILE_SCOPE("ui.monthView");
     // Calculate responsive cell dimensions
     float availableWidth = ImGui::GetContentRegionAvail().x;
     float itemSpacing = 4.0f;
@@ -52,6 +75,8 @@ void CalendarUI::renderMonthView() {
     int firstDay = CalendarLogic::getFirstDayOfMonth(state_.currentMonth, state_.currentYear);
     int daysInMonth = CalendarLogic::getDaysInMonth(state_.currentMonth, state_.currentYear);
     int day = 1;
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    float dotSize = cellWidth * 0.06f > 3.0f ? cellWidth * 0.06f : 3.0f;
 
     float framePadding = cellWidth * 0.11f;  // Proportional padding
     ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(framePadding, framePadding));
@@ -65,9 +90,11 @@ void CalendarUI::renderMonthView() {
                 ImGui::InvisibleButton(emptyId, ImVec2(cellWidth, cellHeight));
             } else if (day <= daysInMonth) {
                 char buttonLabel[32];
-                auto dayEvents = eventManager_.getEventsForDate(day, state_.currentMonth, state_.currentYear);
+                // Only events the tag filter shows are counted
+                int eventCount = eventManager_.getShownDayIndex().countForDate(day, state_.currentMonth,
+                                                                               state_.currentYear);
                 
-                if (dayEvents.size() > 0) {
+                if (eventCount > 0) {
                     snprintf(buttonLabel, sizeof(buttonLabel), "%d*", day);
                 } else {
                     snprintf(buttonLabel, sizeof(buttonLabel), "%d", day);
@@ -91,6 +118,21 @@ void CalendarUI::renderMonthView() {
                     ImGui::PopStyleColor(4);
                 }
                 
+                // A dot per tag on the day, in the tag's colour
+                uint64_t dayTags = eventCount > 0
+                    ? eventManager_.getTagsForDate(day, state_.currentMonth, state_.currentYear) : 0;
+                if (dayTags) {
+                    ImVec2 cell_min = ImGui::GetItemRectMin();
+                    ImVec2 cell_max = ImGui::GetItemRectMax();
+                    float x = cell_min.x + dotSize;
+                    float y = cell_max.y - dotSize * 2.0f;
+                    for (; dayTags && x + dotSize < cell_max.x - dotSize; dayTags &= dayTags - 1) {
+                        draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + dotSize, y + dotSize),
+                                                 tagColor(firstTag(dayTags), 1.0f));
+                        x += dotSize * 1.6f;
+                    }
+                }
+                
                 day++;
             } else {
                 char emptyId[32];
@@ -113,22 +155,25 @@ void CalendarUI::renderMonthView() {
                    CalendarLogic::getMonthName(state_.currentMonth), 
                    state_.selectedDay, state_.currentYear);
         
-        auto dayEvents = eventManager_.getEventsForDate(state_.selectedDay, state_.currentMonth, state_.currentYear);
-        if (dayEvents.size() > 0) {
+        EventManager::EventRange dayEvents =
+            eventManager_.getEventsForDate(state_.selectedDay, state_.currentMonth, state_.currentYear);
+        if (!dayEvents.empty()) {
             ImGui::Spacing();
             ImGui::Text("EVENTS:");
-            for (size_t i = 0; i < dayEvents.size(); i++) {
-                std::string timeStr = eventManager_.formatEventTime(dayEvents[i]);
-                if (!timeStr.empty()) {
-                    ImGui::BulletText("[%s] %s", timeStr.c_str(), dayEvents[i]->text.c_str());
-                } else {
-                    ImGui::BulletText("%s", dayEvents[i]->text.c_str());
-                }
+            ImU32 untagged = ImGui::GetColorU32(ImGuiCol_Text);
+            int i = 0;
+            for (Event* evt : dayEvents) {
+                ImGui::PushStyleColor(ImGuiCol_Text, eventColor(*evt, 1.0f, untagged));
+                ImGui::BulletText("%s", listLabels_.get(*evt, 0.0f));
+                ImGui::PopStyleColor();
                 ImGui::SameLine();
-                ImGui::PushID((int)(1000 + i));
+                ImGui::PushID(1000 + i++);
                 if (ImGui::SmallButton("[DEL]")) {
-                    eventManager_.removeEvent(dayEvents[i]);
+                    eventManager_.removeEvent(evt);
                     StorageManager::saveEventsToStorage(eventManager_.getAllEvents());
+                    // Removal moves another event into the freed slot; the range is stale
+                    ImGui::PopID();
+                    break;
                 }
                 ImGui::PopID();
             }
@@ -140,5 +185,189 @@ void CalendarUI::renderMonthView() {
     }
 }
 
+void CalendarUI::renderYearView() {
+    PROFILE_SCOPE("ui.yearView");
+    static const char* dayLabels[32] = {
+        "", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16",
+        "17", "18", "19", "20", "21", "22", "23", "24", "25", "26", "27", "28", "29", "30", "31"
+    };
+    const int heatLevels = 8;
+    const int columns = 4;
+    const int rows = 3;
+    const float gap = 12.0f;
+    
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    
+    float monthWidth = (avail.x - gap * (columns - 1)) / columns;
+    float monthHeight = (avail.y - gap * (rows - 1)) / rows;
+    float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+    float cellSize = monthWidth / 7.0f;
+    if ((monthHeight - lineHeight * 2) / 6.0f < cellSize) {
+        cellSize = (monthHeight - lineHeight * 2) / 6.0f;
+    }
+    bool showDayNumbers = cellSize >= ImGui::GetFontSize() * 1.4f;
+    
+    // The whole year is 366 precomputed counts of the events the tag filter
+    // shows; no event is visited here
+    int year = state_.currentYear;
+    const int* counts = eventManager_.getShownDayIndex().yearCounts(year);
+    int maxCount = 1;
+    if (counts) {
+        for (int i = 0; i < 366; i++) {
+            if (counts[i] > maxCount) maxCount = counts[i];
+        }
+    }
+    
+    ImU32 heatColors[heatLevels];
+    for (int i = 0; i < heatLevels; i++) {
+        float t = (float)(i + 1) / heatLevels;
+        heatColors[i] = ImGui::ColorConvertFloat4ToU32(ImVec4(0.1f + 0.3f * t, 0.3f + 0.65f * t, 0.15f + 0.35f * t, 0.35f + 0.65f * t));
+    }
+    ImU32 emptyColor = ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.15f, 0.0f, 0.54f));
+    ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+    ImU32 dimTextColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+    ImU32 cellTextColor = ImGui::ColorConvertFloat4ToU32(ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
+    ImU32 selectedColor = ImGui::ColorConvertFloat4ToU32(ImVec4(0.4f, 0.95f, 0.5f, 1.0f));
+    
+    ImVec2 mouse_pos = ImGui::GetMousePos();
+    int hoveredDay = 0;
+    int hoveredMonth = -1;
+    int hoveredCount = 0;
+    
+    int dayOfYear = 0;
+    for (int month = 0; month < 12; month++) {
+        ImVec2 base(origin.x + (month % columns) * (monthWidth + gap),
+                    origin.y + (month / columns) * (monthHeight + gap));
+        
+        draw_list->AddText(base, textColor, CalendarLogic::getMonthName(month));
+        for (int dow = 0; dow < 7; dow++) {
+            const char* name = CalendarLogic::getDayName(dow);
+            draw_list->AddText(ImVec2(base.x + dow * cellSize + 2, base.y + lineHeight), dimTextColor, name, name + 1);
+        }
+        
+        int firstDay = CalendarLogic::getFirstDayOfMonth(month, year);
+        int daysInMonth = CalendarLogic::getDaysInMonth(month, year);
+        for (int day = 1; day <= daysInMonth; day++, dayOfYear++) {
+            int slot = firstDay + day - 1;
+            ImVec2 cell_min(base.x + (slot % 7) * cellSize, base.y + lineHeight * 2 + (slot / 7) * cellSize);
+            ImVec2 cell_max(cell_min.x + cellSize - 2, cell_min.y + cellSize - 2);
+            
+            int count = counts ? counts[dayOfYear] : 0;
+            if (count > 0) {
+                int level = (count * heatLevels - 1) / maxCount;
+                draw_list->AddRectFilled(cell_min, cell_max, heatColors[level]);
+            } else {
+                draw_list->AddRectFilled(cell_min, cell_max, emptyColor);
+            }
+            
+            if (day == state_.selectedDay && month == state_.currentMonth) {
+                draw_list->AddRect(cell_min, cell_max, selectedColor, 0.0f, 0, 2.0f);
+            }
+            if (showDayNumbers) {
+                draw_list->AddText(ImVec2(cell_min.x + 2, cell_min.y + 1),
+                                   count > 0 ? cellTextColor : dimTextColor, dayLabels[day]);
+            }
+            
+            if (mouse_pos.x >= cell_min.x && mouse_pos.x < cell_max.x &&
+                mouse_pos.y >= cell_min.y && mouse_pos.y < cell_max.y) {
+                hoveredDay = day;
+                hoveredMonth = month;
+                hoveredCount = count;
+            }
+        }
+    }
+    
+    // Reserve the grid area so the window layout matches what was drawn
+    ImGui::InvisibleButton("year_grid", ImVec2(avail.x > 1 ? avail.x : 1, avail.y > 1 ? avail.y : 1));
+    
+    if (hoveredMonth >= 0 && ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s %d: %d EVENTS", CalendarLogic::getMonthName(hoveredMonth), hoveredDay, hoveredCount);
+        
+        // Clicking a day jumps to it in DAY view
+        if (ImGui::IsItemClicked(0)) {
+            state_.selectedDay = hoveredDay;
+            state_.currentMonth = hoveredMonth;
+            state_.showAddEvent = false;
+            state_.viewMode = VIEW_DAY;
+        }
+    }
+}
+
+void CalendarUI::renderAgendaView() {
+    PROFILE_SCOPE("ui.agendaView");
+    // The chronological order with the tag filter applied
+    size_t count = eventManager_.getFilteredCount();
+    if (count == 0) {
+        ImGui::TextDisabled(eventManager_.getTagFilter() ? "NO EVENTS WITH THESE TAGS" : "NO EVENTS");
+        return;
+    }
+    ImU32 untagged = ImGui::GetColorU32(ImGuiCol_Text);
+    
+    float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    float dateColumn = ImGui::CalcTextSize("WED 30 September 2000").x + 24.0f;
+    float timeColumn = ImGui::CalcTextSize("00:00 - 00:00").x + 24.0f;
+    
+    ImGui::BeginChild("agenda", ImVec2(0, 0), ImGuiChildFlags_Borders);
+    
+    // Follow the selected date (TODAY, PREV/NEXT, other views) with a binary
+    // search into the chronological index rather than a scan
+    int anchorDay = state_.selectedDay;
+    int daysInMonth = CalendarLogic::getDaysInMonth(state_.currentMonth, state_.currentYear);
+    if (anchorDay < 1) anchorDay = 1;
+    if (anchorDay > daysInMonth) anchorDay = daysInMonth;
+    int anchor = CalendarLogic::toDayNumber(anchorDay, state_.currentMonth, state_.currentYear);
+    if (anchor != agendaAnchorDay_) {
+        size_t row = eventManager_.findFirstFilteredOnOrAfter(anchorDay, state_.currentMonth, state_.currentYear);
+        ImGui::SetScrollY(row * rowHeight);
+        agendaAnchorDay_ = anchor;
+    }
+    
+    // Only the visible rows are touched, so cost is independent of history size
+    ImGuiListClipper clipper;
+    clipper.Begin((int)count, rowHeight);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            Event* evt = eventManager_.getFiltered(row);
+            Event* prev = row > 0 ? eventManager_.getFiltered(row - 1) : nullptr;
+            bool firstOfDay = !prev || prev->day != evt->day || prev->month != evt->month || prev->year != evt->year;
+            bool isSelected = evt->day == state_.selectedDay && evt->month == state_.currentMonth &&
+                              evt->year == state_.currentYear;
+            
+            ImGui::PushID(row);
+            if (ImGui::Selectable("##row", isSelected, ImGuiSelectableFlags_AllowDoubleClick)) {
+                state_.selectedDay = evt->day;
+                state_.currentMonth = evt->month;
+                state_.currentYear = evt->year;
+                state_.showAddEvent = false;
+                agendaAnchorDay_ = CalendarLogic::toDayNumber(evt->day, evt->month, evt->year);
+                if (ImGui::IsMouseDoubleClicked(0)) {
+                    state_.viewMode = VIEW_DAY;
+                }
+            }
+            
+            if (firstOfDay) {
+                ImGui::SameLine(8.0f);
+                ImGui::Text("%s %02d %s %d",
+                           CalendarLogic::getDayName(CalendarLogic::getDayOfWeek(evt->day, evt->month, evt->year)),
+                           evt->day, CalendarLogic::getMonthName(evt->month), evt->year);
+            }
+            char timeStr[32];
+            EventManager::formatEventTime(evt, timeStr, sizeof(timeStr));
+            ImGui::SameLine(dateColumn);
+            ImGui::TextUnformatted(timeStr);
+            ImGui::SameLine(dateColumn + timeColumn);
+            ImGui::PushStyleColor(ImGuiCol_Text, eventColor(*evt, 1.0f, untagged));
+            ImGui::TextUnformatted(evt->text.c_str());
+            ImGui::PopStyleColor();
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+    
+    ImGui::EndChild();
+}
+
 } // namespace calendar
 
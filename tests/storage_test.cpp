@@ -0,0 +1,228 @@
+// Loads every stored layout the app has ever written and checks what comes
+// out, through the native storage backend on a scratch directory.
+//
+//   storage_test FIXTURE_DIR SCRATCH_DIR
+//
+// v0..v4 payloads must load field for field and be rewritten once as the
+// current schema, with the uids and stamps the load handed out so the next
+// load sees the same ones; payloads that cannot be read (a newer schema, truncated,
+// corrupt or not JSON at all) must be left byte for byte as they were,
+// and so must they stay after a save. Exits non-zero on any failure.
+
+#include "core/event.h"
+#include "core/storage.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace calendar;
+
+namespace {
+
+int g_failures = 0;
+std::string g_fixtureDir;
+std::string g_storedPath;
+const char* g_current = "";     // fixture under test
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: %s: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                    g_current, #cond);                                           \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+bool readFile(const std::string& path, std::string& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    out.clear();
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+bool writeFile(const std::string& path, const std::string& data) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// Puts a fixture where StorageBackend looks for the events key and
+// returns its bytes
+std::string stage(const char* fixture) {
+    g_current = fixture;
+    std::string json;
+    if (!readFile(g_fixtureDir + "/" + fixture, json)) {
+        fprintf(stderr, "cannot read fixture %s\n", fixture);
+        exit(1);
+    }
+    if (!writeFile(g_storedPath, json)) {
+        fprintf(stderr, "cannot write %s\n", g_storedPath.c_str());
+        exit(1);
+    }
+    return json;
+}
+
+struct Expected {
+    const char* text;
+    int day, month, year;
+    int hourStart, minuteStart, hourEnd, minuteEnd;
+    bool isAllDay;
+    const char* recurrence;
+    int reminderMinutes;
+    uint64_t tags;
+    uint64_t uid;       // 0: none stored, one must be handed out
+    uint64_t stamp;     // likewise
+};
+
+void checkEvents(const std::vector<Event>& events, const std::vector<Expected>& expected) {
+    CHECK(events.size() == expected.size());
+    for (size_t i = 0; i < events.size() && i < expected.size(); i++) {
+        const Event& evt = events[i];
+        const Expected& want = expected[i];
+        CHECK(evt.text == want.text);
+        CHECK(evt.day == want.day);
+        CHECK(evt.month == want.month);
+        CHECK(evt.year == want.year);
+        CHECK(evt.hourStart == want.hourStart);
+        CHECK(evt.minuteStart == want.minuteStart);
+        CHECK(evt.hourEnd == want.hourEnd);
+        CHECK(evt.minuteEnd == want.minuteEnd);
+        CHECK(evt.isAllDay == want.isAllDay);
+        CHECK(evt.recurrence == want.recurrence);
+        CHECK(evt.reminderMinutes == want.reminderMinutes);
+        CHECK(evt.tags == want.tags);
+        CHECK(want.uid != 0 ? evt.uid == want.uid : evt.uid != 0);
+        CHECK(want.stamp != 0 ? evt.stamp == want.stamp : evt.stamp != 0);
+    }
+}
+
+// A readable payload loads as expected; anything older than the current
+// schema, or stored without uids or stamps, is rewritten in it with the
+// same events and the identities they were given
+void checkMigrates(const char* fixture, int version, const std::vector<Expected>& expected) {
+    std::string original = stage(fixture);
+    std::vector<Event> parsed;
+    int detected = StorageManager::parseFromJSON(original, parsed);
+    CHECK(detected == version);
+
+    EventManager events;
+    StorageManager::loadEventsFromStorage(events);
+    const std::vector<Event>& loaded = events.getAllEvents();
+    checkEvents(loaded, expected);
+    CHECK(!StorageManager::storedPayloadKept());
+
+    std::string stored;
+    CHECK(readFile(g_storedPath, stored));
+    if (version == StorageManager::kSchemaVersion && !StorageManager::lacksIdentity(parsed)) {
+        CHECK(stored == original);
+    } else {
+        CHECK(stored == StorageManager::serializeToJSON(loaded));
+    }
+    std::vector<Event> reloaded;
+    int reloadedVersion = StorageManager::parseFromJSON(stored, reloaded);
+    CHECK(reloadedVersion == StorageManager::kSchemaVersion);
+    checkEvents(reloaded, expected);
+
+    // Loading again, as another tab would, finds the same identities and
+    // leaves the payload alone
+    EventManager again;
+    StorageManager::loadEventsFromStorage(again);
+    const std::vector<Event>& second = again.getAllEvents();
+    CHECK(second.size() == loaded.size());
+    for (size_t i = 0; i < second.size() && i < loaded.size(); i++) {
+        CHECK(second[i].uid == loaded[i].uid);
+        CHECK(second[i].stamp == loaded[i].stamp);
+    }
+    std::string restored;
+    CHECK(readFile(g_storedPath, restored));
+    CHECK(restored == stored);
+}
+
+// An unreadable payload is never migrated or saved over
+void checkKept(const char* fixture) {
+    std::string original = stage(fixture);
+    std::vector<Event> parsed;
+    int detected = StorageManager::parseFromJSON(original, parsed);
+    CHECK(detected == -1);
+
+    EventManager loaded;
+    StorageManager::loadEventsFromStorage(loaded);
+    CHECK(StorageManager::storedPayloadKept());
+    std::string stored;
+    CHECK(readFile(g_storedPath, stored));
+    CHECK(stored == original);
+
+    std::vector<Event> events = loaded.getAllEvents();
+    Event added;
+    added.text = "Edited after the load";
+    added.day = 1;
+    added.year = 2025;
+    events.push_back(added);
+    StorageManager::saveEventsToStorage(events);
+    StorageManager::writeStoredJSON(StorageManager::serializeToJSON(events));
+    CHECK(readFile(g_storedPath, stored));
+    CHECK(stored == original);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: storage_test FIXTURE_DIR SCRATCH_DIR\n");
+        return 1;
+    }
+    g_fixtureDir = argv[1];
+    std::string scratch = argv[2];
+    mkdir(scratch.c_str(), 0755);
+    setenv("CALENDAR_STORAGE_DIR", scratch.c_str(), 1);
+    g_storedPath = scratch + "/calendar_events.json";
+
+    // v0 text is written unescaped and runs to the closing "}; v0 has no
+    // end time or all-day flag
+    checkMigrates("v0.json", 0, {
+        {"Standup, room \"B\"", 3, 0, 2024, 9, 30, -1, 0, false, "", -1, 0, 0, 0},
+        {"Valentine's", 14, 1, 2024, -1, 0, -1, 0, false, "", -1, 0, 0, 0},
+    });
+    checkMigrates("v1.json", 1, {
+        {"Dentist", 5, 2, 2024, 10, 0, 11, 15, false, "", -1, 0, 0, 0},
+        {"Birthday", 1, 3, 2024, -1, 0, -1, 0, true, "FREQ=YEARLY", -1, 0, 0, 0},
+    });
+    checkMigrates("v2.json", 2, {
+        {"Choir \"alto\"\nbring music", 7, 4, 2024, 18, 30, 20, 0, false, "FREQ=WEEKLY;BYDAY=TU", -1, 0, 0, 0},
+    });
+    checkMigrates("v3.json", 3, {
+        {"Run", 9, 5, 2024, 8, 0, 9, 0, false, "", -1, 0, 0x1a2b3c4d5e6f7081ull, 0x18e0a1b2c3dull},
+    });
+    checkMigrates("v4.json", 4, {
+        {"New Year's Eve", 31, 11, 2024, 23, 0, 23, 59, false, "", 15, 0, 0xffffffffffffffffull, 1},
+    });
+    checkMigrates("v5.json", 5, {
+        {"Lunch", 2, 6, 2025, 12, 0, 13, 0, false, "", -1, 5, 2, 3},
+    });
+    // Current layout, but saved before the load handed out identities
+    checkMigrates("v5-unset.json", 5, {
+        {"Lunch", 2, 6, 2025, 12, 0, 13, 0, false, "", -1, 5, 0, 0},
+    });
+
+    // Last: keeping a payload turns saves off for the rest of the process
+    checkKept("newer.json");
+    checkKept("truncated.json");
+    checkKept("corrupt.json");
+    checkKept("garbage.json");
+
+    if (g_failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("storage_test: all payloads ok\n");
+    return 0;
+}
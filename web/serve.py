@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Static file server for the built app that sends the COOP/COEP headers
+browsers require before exposing SharedArrayBuffer, so the threaded build
+(index-mt.js) can be tested locally. Under require-corp the web font in
+shell.html is blocked and the monospace fallback is used.
+
+It also answers POST /sync as a reference sync endpoint, kept in memory
+(open the app with ?sync=/sync to use it); see SyncLog.
+
+    python3 web/serve.py [directory] [port]
+"""
+
+import functools
+import http.server
+import sys
+import threading
+import zlib
+
+UPSERT = 1
+REMOVE = 2
+BATCH_HEADER = b"\xcd\x03"   # encodeDeltas magic and format
+SYNC_HEADER = b"\xce\x01"    # encodeSyncMessage magic and version
+SYNC_MORE = 0x01
+COMPRESS_MIN_BYTES = 1024
+
+
+def read_varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def write_varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def split_batch(data, pos):
+    """(uid, stamp, encoded delta) for each delta of an encodeDeltas batch.
+    Only the uid and stamp are decoded; the rest is passed through."""
+    if data[pos:pos + 2] != BATCH_HEADER:
+        raise ValueError("not a delta batch")
+    count, pos = read_varint(data, pos + 2)
+    deltas = []
+    for _ in range(count):
+        start = pos
+        kind = data[pos]
+        uid = int.from_bytes(data[pos + 1:pos + 9], "little")
+        stamp, pos = read_varint(data, pos + 9)
+        if kind == UPSERT:
+            for _ in range(7):  # day, month, year, start and end times
+                _, pos = read_varint(data, pos)
+            pos += 1            # isAllDay
+            _, pos = read_varint(data, pos)  # reminder
+            _, pos = read_varint(data, pos)  # tags
+            for _ in range(2):  # rrule, text
+                length, pos = read_varint(data, pos)
+                pos += length
+        elif kind != REMOVE:
+            raise ValueError("unknown delta kind")
+        if pos > len(data):
+            raise ValueError("truncated delta")
+        deltas.append((uid, stamp, data[start:pos]))
+    return deltas
+
+
+class SyncLog:
+    """Same as src/core/sync_server.cpp: the newest change per event uid,
+    numbered by a sequence that clients use as their cursor. A change takes
+    a new number and gives up its old one, so a client catching up gets
+    each changed event once."""
+
+    MAX_DELTAS_PER_ANSWER = 1000
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.records = {}   # uid -> (sequence, stamp, encoded delta)
+        self.log = {}       # sequence -> uid, in sequence order
+        self.next_sequence = 1
+
+    def handle(self, request):
+        if request[:2] != SYNC_HEADER or len(request) < 3:
+            raise ValueError("not a sync message")
+        cursor, pos = read_varint(request, 3)
+        pushed = split_batch(request, pos)
+
+        with self.lock:
+            head = self.next_sequence - 1
+            if cursor > head:  # from before a restart: start the client over
+                cursor = 0
+            answer = []
+            more = False
+            for sequence, uid in self.log.items():
+                if sequence <= cursor:
+                    continue
+                if len(answer) == self.MAX_DELTAS_PER_ANSWER:
+                    more = True
+                    break
+                answer.append(self.records[uid][2])
+                cursor = sequence
+
+            for uid, stamp, delta in pushed:
+                record = self.records.get(uid)
+                if record:
+                    if record[1] >= stamp:
+                        continue
+                    del self.log[record[0]]
+                self.records[uid] = (self.next_sequence, stamp, delta)
+                self.log[self.next_sequence] = uid
+                self.next_sequence += 1
+
+            if not more:
+                cursor = self.next_sequence - 1
+
+        return (SYNC_HEADER + bytes([SYNC_MORE if more else 0]) + write_varint(cursor) +
+                BATCH_HEADER + write_varint(len(answer)) + b"".join(answer))
+
+
+class IsolatedHandler(http.server.SimpleHTTPRequestHandler):
+    sync_log = SyncLog()
+
+    def end_headers(self):
+        self.send_header("Cross-Origin-Opener-Policy", "same-origin")
+        self.send_header("Cross-Origin-Embedder-Policy", "require-corp")
+        super().end_headers()
+
+    def do_POST(self):
+        if self.path.split("?")[0] != "/sync":
+            self.send_error(404)
+            return
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        try:
+            if self.headers.get("Content-Encoding") == "deflate":
+                body = zlib.decompress(body)
+            answer = self.sync_log.handle(body)
+        except (ValueError, IndexError, zlib.error):
+            self.send_error(400)
+            return
+
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Cache-Control", "no-store")
+        if len(answer) >= COMPRESS_MIN_BYTES and "deflate" in self.headers.get("Accept-Encoding", ""):
+            answer = zlib.compress(answer)
+            self.send_header("Content-Encoding", "deflate")
+        self.send_header("Content-Length", str(len(answer)))
+        self.end_headers()
+        self.wfile.write(answer)
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else "docs"
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else 8000
+    handler = functools.partial(IsolatedHandler, directory=directory)
+    with http.server.ThreadingHTTPServer(("", port), handler) as server:
+        print("Serving %s at http://localhost:%d (cross-origin isolated, sync at /sync)" % (directory, port))
+        server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()